@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Minimal benchmark registry for xgcs_bench. Each bench/*.cpp defines cases
+// with BENCH(name) { ... }; bench_main.cpp runs them. Figures are wall time
+// on the machine at hand: compare two runs of the same build, not machines.
+namespace xgcs_bench {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Case>& cases();
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { cases().push_back({name, run}); }
+};
+
+// Nanoseconds per fn() call over `iterations` calls, after a warm-up of a
+// tenth as many
+template <typename Fn>
+double ns_per_call(std::size_t iterations, Fn&& fn) {
+    for (std::size_t i = 0; i < iterations / 10; ++i) fn();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) fn();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+// Keeps the optimizer from discarding a result
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// One result line: what was measured, its cost and the rate that implies
+inline void report(const char* label, double ns_per_op) {
+    std::printf("  %-56s %10.1f ns/op %14.0f op/s\n", label, ns_per_op, ns_per_op > 0 ? 1e9 / ns_per_op : 0.0);
+}
+
+} // namespace xgcs_bench
+
+#define BENCH(name)                                                     \
+    static void name();                                                 \
+    static const xgcs_bench::Registrar name##_registrar(#name, name);   \
+    static void name()
@@ -0,0 +1,23 @@
+#include "bench.hpp"
+#include <cstring>
+
+namespace xgcs_bench {
+
+std::vector<Case>& cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+} // namespace xgcs_bench
+
+// xgcs_bench [filter]: runs every benchmark whose name contains `filter`
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    for (const auto& bench : xgcs_bench::cases()) {
+        if (!std::strstr(bench.name, filter)) continue;
+        std::printf("%s\n", bench.name);
+        bench.run();
+        std::fflush(stdout);
+    }
+    return 0;
+}
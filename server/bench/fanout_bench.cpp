@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include "stream_client_queue.hpp"
+#include <nlohmann/json.hpp>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Cost per message of delivering one vehicle's stream to 1, 10 and 100
+// clients. "per-client dump()" is the old broadcast loop: the message DOM
+// serialized again for every connection. "serialize once" dumps it once into
+// a shared buffer and queues that same buffer on each client's
+// StreamClientQueue. Writers drain every client after each 64 messages in
+// both cases, so queues stay under their watermarks.
+
+namespace {
+
+using json = nlohmann::json;
+
+constexpr std::size_t kDrainEvery = 64;
+
+json sample_message(uint64_t seq) {
+    return {
+        {"component_id", 1},
+        {"fields", {{"pitch", -0.0456}, {"pitchspeed", -0.002}, {"roll", 0.0123}, {"rollspeed", 0.001},
+                    {"time_boot_ms", 123456 + seq}, {"yaw", 1.789}, {"yawspeed", 0.0003}}},
+        {"msgId", 30},
+        {"msgName", "ATTITUDE"},
+        {"payload_length", 28},
+        {"sequence", seq & 0xFF},
+        {"serverSeq", seq},
+        {"system_id", 1},
+        {"timestamp", 1760000000123 + seq},
+    };
+}
+
+void run(std::size_t clients) {
+    // The same DOM each time; building it is upstream of both paths
+    const json message = sample_message(1);
+
+    std::vector<std::deque<std::string>> outboxes(clients);
+    std::size_t pending = 0;
+    const double per_client_ns = xgcs_bench::ns_per_call(20000, [&] {
+        for (auto& outbox : outboxes) outbox.push_back(message.dump());
+        if (++pending == kDrainEvery) {
+            for (auto& outbox : outboxes) outbox.clear();
+            pending = 0;
+        }
+    });
+
+    std::vector<std::unique_ptr<StreamClientQueue>> queues;
+    for (std::size_t i = 0; i < clients; ++i) {
+        queues.push_back(std::make_unique<StreamClientQueue>(1 << 20, 1 << 19, StreamOverflowPolicy::DropOldest));
+    }
+    std::vector<StreamClientQueue::Item> taken;
+    pending = 0;
+    const double shared_ns = xgcs_bench::ns_per_call(20000, [&] {
+        StreamClientQueue::Item item;
+        item.payload = std::make_shared<const std::string>(message.dump());
+        item.msgid = 30;
+        for (auto& queue : queues) queue->push(item);
+        if (++pending == kDrainEvery) {
+            for (auto& queue : queues) queue->take_all(taken);
+            pending = 0;
+        }
+    });
+
+    std::string label = std::to_string(clients) + " client(s), per-client dump()";
+    xgcs_bench::report(label.c_str(), per_client_ns);
+    label = std::to_string(clients) + " client(s), serialize once";
+    xgcs_bench::report(label.c_str(), shared_ns);
+}
+
+} // namespace
+
+BENCH(stream_fanout_clients) {
+    for (std::size_t clients : {1, 10, 100}) run(clients);
+}
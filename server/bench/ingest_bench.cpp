@@ -0,0 +1,184 @@
+#include "bench.hpp"
+#include "mavlink_ingest.hpp"
+#include "msgid_table.hpp"
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-message dispatch cost with the fleet at 50 vehicles x 200 msg/s.
+//
+// "per-id callbacks" is the layout the ingest pipeline replaced: a TLog
+// std::function on every id 1-400 and a handle_mavlink_message one on the
+// tracked ids, each holding its own copy of the vehicle id, which the
+// handler looked up again under the global mutex. "pipeline" is one
+// trampoline per id into MavlinkIngest::ingest(), as attach() sets up, with
+// the state stage handed its vehicle directly. Both sit behind the same
+// per-id callback lookup standing in for MAVSDK's, and the per-message work
+// itself is a counter, so the difference is dispatch and lookup.
+
+namespace {
+
+constexpr int kVehicles = 50;
+constexpr int kRateHz = 200;
+
+constexpr uint32_t kStateIds[] = {
+    MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_RADIO_STATUS, MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+    MAVLINK_MSG_ID_VFR_HUD, MAVLINK_MSG_ID_SYS_STATUS, MAVLINK_MSG_ID_COMMAND_ACK,
+    MAVLINK_MSG_ID_MAG_CAL_REPORT, MAVLINK_MSG_ID_STATUSTEXT,
+};
+
+// Rough ArduPilot stream mix, most frequent first
+constexpr uint32_t kTraffic[] = {
+    MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_ATTITUDE,
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAVLINK_MSG_ID_VFR_HUD,
+    MAVLINK_MSG_ID_VFR_HUD, MAVLINK_MSG_ID_RAW_IMU, MAVLINK_MSG_ID_SCALED_PRESSURE, MAVLINK_MSG_ID_RC_CHANNELS,
+    MAVLINK_MSG_ID_GPS_RAW_INT, MAVLINK_MSG_ID_SYS_STATUS, MAVLINK_MSG_ID_BATTERY_STATUS,
+    MAVLINK_MSG_ID_RADIO_STATUS, MAVLINK_MSG_ID_HEARTBEAT,
+};
+
+using Callback = std::function<void(const mavlink_message_t&)>;
+
+// Stands in for MAVSDK's per-id subscription lists
+struct Subscriptions {
+    MsgIdTable<std::vector<Callback>> by_id;
+
+    void deliver(const mavlink_message_t& message) const {
+        const auto* callbacks = by_id.find(message.msgid);
+        if (!callbacks) return;
+        for (const auto& callback : *callbacks) callback(message);
+    }
+};
+
+struct VehicleState {
+    uint64_t handled = 0;
+};
+
+// TLog recording keys by vehicle id in both layouts
+struct Recorder {
+    uint64_t recorded = 0;
+
+    __attribute__((noinline)) void record(const std::string& vehicle_id, const mavlink_message_t& message) {
+        recorded += vehicle_id.size() + message.len;
+    }
+};
+
+__attribute__((noinline)) void handle(VehicleState& state, const mavlink_message_t& message) {
+    state.handled += message.msgid;
+}
+
+// The old ConnectionManager side: per-vehicle state in maps keyed by id
+struct Fleet {
+    std::mutex mutex;
+    std::unordered_map<std::string, VehicleState> states;
+
+    void handle_mavlink_message(const std::string& vehicle_id, const mavlink_message_t& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = states.find(vehicle_id);
+        if (it != states.end()) handle(it->second, message);
+    }
+};
+
+// One second of fleet traffic, vehicles interleaved
+std::vector<std::pair<int, mavlink_message_t>> traffic() {
+    std::vector<std::pair<int, mavlink_message_t>> out;
+    out.reserve(kVehicles * kRateHz);
+    for (int i = 0; i < kRateHz; ++i) {
+        for (int v = 0; v < kVehicles; ++v) {
+            mavlink_message_t message;
+            std::memset(&message, 0, sizeof(message));
+            message.msgid = kTraffic[(i + v) % std::size(kTraffic)];
+            message.len = 28;
+            out.emplace_back(v, message);
+        }
+    }
+    return out;
+}
+
+void report_load(const char* label, double ns_per_message) {
+    xgcs_bench::report(label, ns_per_message);
+    std::printf("  %-56s %9.3f %% of one core\n", "  at 50 x 200 msg/s", ns_per_message * kVehicles * kRateHz / 1e7);
+}
+
+} // namespace
+
+BENCH(ingest_dispatch_50_vehicles) {
+    const auto messages = traffic();
+    Recorder recorder;
+
+    Fleet fleet;
+    std::vector<Subscriptions> legacy(kVehicles);
+    for (int v = 0; v < kVehicles; ++v) {
+        const std::string vehicle_id = std::to_string(v + 1);
+        fleet.states[vehicle_id];
+        for (uint32_t id = 1; id <= 400; ++id) {
+            legacy[v].by_id[id].push_back([&recorder, vehicle_id](const mavlink_message_t& message) {
+                recorder.record(vehicle_id, message);
+            });
+        }
+        for (uint32_t id : kStateIds) {
+            legacy[v].by_id[id].push_back([&fleet, vehicle_id](const mavlink_message_t& message) {
+                fleet.handle_mavlink_message(vehicle_id, message);
+            });
+        }
+    }
+
+    // Each pipeline's owner, as the VehicleContext is in the server
+    std::vector<std::shared_ptr<VehicleState>> states;
+    std::vector<std::unique_ptr<MavlinkIngest>> pipelines;
+    std::vector<Subscriptions> trampolines(kVehicles);
+    for (int v = 0; v < kVehicles; ++v) {
+        auto state = std::make_shared<VehicleState>();
+        auto ingest = std::make_unique<MavlinkIngest>(std::to_string(v + 1));
+        ingest->add_stage_all("tlog", [](void* context, const MavlinkIngest& source, const mavlink_message_t& message) {
+            static_cast<Recorder*>(context)->record(source.vehicle_id(), message);
+        }, &recorder);
+        ingest->add_stage("state", [](void* context, const MavlinkIngest&, const mavlink_message_t& message) {
+            handle(*static_cast<VehicleState*>(context), message);
+        }, state.get(), kStateIds, std::size(kStateIds));
+        const int stream = ingest->add_stage("stream", [](void*, const MavlinkIngest&, const mavlink_message_t&) {}, nullptr,
+                                             {MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_GLOBAL_POSITION_INT});
+        ingest->set_stage_enabled(stream, false);
+
+        // What attach() subscribes: one trampoline per id
+        const MavlinkIngest* pipeline = ingest.get();
+        std::weak_ptr<void> owner = state;
+        for (uint32_t id = MavlinkIngest::kAllMsgIdFirst; id <= MavlinkIngest::kAllMsgIdLast; ++id) {
+            trampolines[v].by_id[id].push_back([pipeline, owner](const mavlink_message_t& message) {
+                auto alive = owner.lock();
+                if (!alive) return;
+                pipeline->ingest(message);
+            });
+        }
+        states.push_back(std::move(state));
+        pipelines.push_back(std::move(ingest));
+    }
+
+    const std::size_t passes = 200;
+    std::size_t next = 0;
+    const double legacy_ns = xgcs_bench::ns_per_call(passes * messages.size(), [&] {
+        const auto& [vehicle, message] = messages[next];
+        legacy[vehicle].deliver(message);
+        if (++next == messages.size()) next = 0;
+    });
+    next = 0;
+    const double pipeline_ns = xgcs_bench::ns_per_call(passes * messages.size(), [&] {
+        const auto& [vehicle, message] = messages[next];
+        trampolines[vehicle].deliver(message);
+        if (++next == messages.size()) next = 0;
+    });
+    next = 0;
+    const double dispatch_ns = xgcs_bench::ns_per_call(passes * messages.size(), [&] {
+        const auto& [vehicle, message] = messages[next];
+        pipelines[vehicle]->ingest(message);
+        if (++next == messages.size()) next = 0;
+    });
+    xgcs_bench::keep(recorder);
+
+    report_load("per-id std::function callbacks", legacy_ns);
+    report_load("ingest pipeline (trampoline + owner lock + ingest)", pipeline_ns);
+    report_load("  of which ingest() dispatch", dispatch_ns);
+}
@@ -0,0 +1,134 @@
+#include "bench.hpp"
+#include "json_writer.hpp"
+#include "mavlink_decoder.hpp"
+#include <cstring>
+#include <string>
+
+// Inspector frame serialization, messages per second: the DOM path
+// (decode() into nlohmann::json, envelope around it, dump()) against
+// JsonWriter into a reused buffer, as write_stream_frame() does. Both produce
+// the same bytes.
+
+namespace {
+
+mavlink_message_t attitude_message() {
+    mavlink_attitude_t attitude{};
+    attitude.time_boot_ms = 123456;
+    attitude.roll = 0.0123f;
+    attitude.pitch = -0.0456f;
+    attitude.yaw = 1.789f;
+    attitude.rollspeed = 0.001f;
+    attitude.pitchspeed = -0.002f;
+    attitude.yawspeed = 0.0003f;
+    mavlink_message_t message;
+    mavlink_msg_attitude_encode(1, 1, &message, &attitude);
+    return message;
+}
+
+mavlink_message_t global_position_message() {
+    mavlink_global_position_int_t position{};
+    position.time_boot_ms = 123456;
+    position.lat = 473977418;
+    position.lon = 85455938;
+    position.alt = 488150;
+    position.relative_alt = 12030;
+    position.vx = 153;
+    position.vy = -42;
+    position.vz = 7;
+    position.hdg = 27015;
+    mavlink_message_t message;
+    mavlink_msg_global_position_int_encode(1, 1, &message, &position);
+    return message;
+}
+
+mavlink_message_t battery_status_message() {
+    mavlink_battery_status_t battery{};
+    battery.current_consumed = 1234;
+    battery.energy_consumed = -1;
+    battery.temperature = 3120;
+    for (auto& voltage : battery.voltages) voltage = UINT16_MAX;
+    battery.voltages[0] = 4012;
+    battery.voltages[1] = 4008;
+    battery.voltages[2] = 4010;
+    battery.current_battery = 1520;
+    battery.id = 0;
+    battery.battery_remaining = 76;
+    mavlink_message_t message;
+    mavlink_msg_battery_status_encode(1, 1, &message, &battery);
+    return message;
+}
+
+std::string dom_frame(const mavlink_message_t& message, uint64_t server_seq, int64_t timestamp_ms) {
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    json frame = {
+        {"component_id", message.compid},
+        {"fields", decoder.decode(message)},
+        {"msgId", static_cast<uint32_t>(message.msgid)},
+        {"msgName", std::string(decoder.name(message.msgid))},
+        {"payload_length", message.len},
+        {"sequence", message.seq},
+        {"serverSeq", server_seq},
+        {"system_id", message.sysid},
+        {"timestamp", timestamp_ms},
+    };
+    return frame.dump();
+}
+
+void write_frame(const mavlink_message_t& message, uint64_t server_seq, int64_t timestamp_ms, std::string& out) {
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    JsonWriter writer(out);
+    writer.begin_object();
+    writer.key("component_id");
+    writer.value(message.compid);
+    writer.key("fields");
+    decoder.write_fields(message, writer);
+    writer.key("msgId");
+    writer.value(static_cast<uint32_t>(message.msgid));
+    writer.key("msgName");
+    writer.value(decoder.name(message.msgid));
+    writer.key("payload_length");
+    writer.value(message.len);
+    writer.key("sequence");
+    writer.value(message.seq);
+    writer.key("serverSeq");
+    writer.value(server_seq);
+    writer.key("system_id");
+    writer.value(message.sysid);
+    writer.key("timestamp");
+    writer.value(timestamp_ms);
+    writer.end_object();
+}
+
+void compare(const char* name, const mavlink_message_t& message) {
+    constexpr int64_t kTimestampMs = 1760000000123;
+    std::string buffer;
+    write_frame(message, 1, kTimestampMs, buffer);
+    if (buffer != dom_frame(message, 1, kTimestampMs)) {
+        std::printf("  %s: writer output differs from the DOM path\n", name);
+        return;
+    }
+
+    uint64_t seq = 0;
+    const double dom_ns = xgcs_bench::ns_per_call(200000, [&] {
+        std::string text = dom_frame(message, ++seq, kTimestampMs);
+        xgcs_bench::keep(text);
+    });
+    const double writer_ns = xgcs_bench::ns_per_call(200000, [&] {
+        buffer.clear();
+        write_frame(message, ++seq, kTimestampMs, buffer);
+        xgcs_bench::keep(buffer);
+    });
+
+    std::string label = std::string(name) + " DOM + dump()";
+    xgcs_bench::report(label.c_str(), dom_ns);
+    label = std::string(name) + " JsonWriter";
+    xgcs_bench::report(label.c_str(), writer_ns);
+}
+
+} // namespace
+
+BENCH(json_writer_vs_dom) {
+    compare("ATTITUDE", attitude_message());
+    compare("GLOBAL_POSITION_INT", global_position_message());
+    compare("BATTERY_STATUS", battery_status_message());
+}
@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include "radio_link_batch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// One radio simulation tick over 1,000 links. "per-link" is the old
+// calculation moved out of get_telemetry_data_json: one link at a time
+// from an array of structs, converting degrees and taking the frequency
+// term on every call. "batch" is what the simulation thread does now:
+// refill a reused RadioLinkBatch and compute() it. The share of one core
+// is at XGCS_RADIO_SIM_HZ.
+
+namespace {
+
+constexpr std::size_t kLinks = 1000;
+
+struct Link {
+    double lat, lon, home_lat, home_lon, frequency_mhz, gain_db;
+};
+
+struct LinkResult {
+    double distance_m, rssi_dbm;
+};
+
+LinkResult per_link(const Link& link) {
+    constexpr double kDegToRad = M_PI / 180.0;
+    const double phi1 = link.lat * kDegToRad;
+    const double phi2 = link.home_lat * kDegToRad;
+    const double dphi = (link.home_lat - link.lat) * kDegToRad;
+    const double dlam = (link.home_lon - link.lon) * kDegToRad;
+    const double a = std::sin(dphi / 2) * std::sin(dphi / 2) +
+                     std::cos(phi1) * std::cos(phi2) * std::sin(dlam / 2) * std::sin(dlam / 2);
+    const double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    const double distance_m = 6371e3 * c;
+
+    const double dist_km = std::max(distance_m / 1000.0, 0.001);
+    const double fspl = 20 * std::log10(dist_km) + 20 * std::log10(link.frequency_mhz) + 32.44;
+    const double rssi = std::clamp(link.gain_db - fspl, -120.0, 0.0);
+    return {distance_m, rssi};
+}
+
+void report_tick(const char* label, double ns_per_tick) {
+    xgcs_bench::report(label, ns_per_tick);
+    char rate[64];
+    std::snprintf(rate, sizeof(rate), "  at %d Hz", XGCS_RADIO_SIM_HZ);
+    std::printf("  %-56s %9.3f %% of one core\n", rate, ns_per_tick * XGCS_RADIO_SIM_HZ / 1e7);
+}
+
+} // namespace
+
+BENCH(radio_simulation_1000_links) {
+    std::mt19937 rng(22);
+    std::uniform_real_distribution<double> home_lat(-60.0, 60.0);
+    std::uniform_real_distribution<double> home_lon(-180.0, 180.0);
+    std::uniform_real_distribution<double> offset(-0.2, 0.2); // Up to ~20 km out
+    std::vector<Link> links;
+    for (std::size_t i = 0; i < kLinks; ++i) {
+        const double lat = home_lat(rng);
+        const double lon = home_lon(rng);
+        links.push_back({lat + offset(rng), lon + offset(rng), lat, lon, i % 2 ? 915.0 : 433.0, 30.0});
+    }
+
+    std::vector<LinkResult> results(kLinks);
+    const double per_link_ns = xgcs_bench::ns_per_call(2000, [&] {
+        for (std::size_t i = 0; i < kLinks; ++i) results[i] = per_link(links[i]);
+        xgcs_bench::keep(results);
+    });
+
+    RadioLinkBatch batch;
+    batch.reserve(kLinks);
+    const double batch_ns = xgcs_bench::ns_per_call(2000, [&] {
+        batch.clear();
+        for (const Link& link : links)
+            batch.add(link.lat, link.lon, link.home_lat, link.home_lon, link.frequency_mhz, link.gain_db);
+        batch.compute();
+        xgcs_bench::keep(batch.rssi_dbm());
+    });
+    const double compute_ns = xgcs_bench::ns_per_call(2000, [&] {
+        batch.compute();
+        xgcs_bench::keep(batch.rssi_dbm());
+    });
+
+    // Both paths have to agree before their timings mean anything
+    double worst_db = 0;
+    for (std::size_t i = 0; i < kLinks; ++i)
+        worst_db = std::max(worst_db, std::fabs(batch.rssi_dbm()[i] - results[i].rssi_dbm));
+    std::printf("  %-56s %10.2e dB\n", "largest RSSI difference", worst_db);
+
+    report_tick("per-link, 1000 links per tick", per_link_ns);
+    report_tick("batch refill + compute(), 1000 links per tick", batch_ns);
+    report_tick("batch compute() only, 1000 links per tick", compute_ns);
+}
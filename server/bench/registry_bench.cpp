@@ -0,0 +1,197 @@
+#include "bench.hpp"
+#include "vehicle_registry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Lock wait under a synthetic 100-vehicle load, before and after the
+// per-vehicle split.
+//
+// "global mutex" is the old ConnectionManager: every vehicle's state in
+// maps keyed by id behind one mutex. "registry" is VehicleRegistry plus each
+// VehicleContext's own mutex. Same load on both for one second:
+// - 4 ingest threads updating 25 vehicles each (the server's stages already
+//   hold their context; the old callbacks looked the id up)
+// - 2 request threads reading random vehicles by id
+// - 1 fleet thread walking every vehicle, as /telemetry/all does
+// - 1 mission upload holding vehicle 0's lock for 10 ms out of every 50
+// Wait is the time to acquire a lock, over every thread but the upload.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kVehicles = 100;
+constexpr int kIngestThreads = 4;
+constexpr int kRequestThreads = 2;
+
+struct WaitStats {
+    uint64_t acquisitions = 0;
+    double wait_ns = 0;
+    double max_wait_ns = 0;
+
+    void merge(const WaitStats& other) {
+        acquisitions += other.acquisitions;
+        wait_ns += other.wait_ns;
+        max_wait_ns = std::max(max_wait_ns, other.max_wait_ns);
+    }
+};
+
+std::unique_lock<std::mutex> acquire(std::mutex& mutex, WaitStats& stats) {
+    const auto start = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    const double waited = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    ++stats.acquisitions;
+    stats.wait_ns += waited;
+    stats.max_wait_ns = std::max(stats.max_wait_ns, waited);
+    return lock;
+}
+
+std::string vehicle_id(int index) {
+    return std::to_string(index + 1);
+}
+
+struct GlobalMutexFleet {
+    struct State {
+        uint64_t messages = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, State> states;
+
+    GlobalMutexFleet() {
+        for (int v = 0; v < kVehicles; ++v) states[vehicle_id(v)];
+    }
+
+    void ingest(int v, const std::string& id, WaitStats& stats) {
+        auto lock = acquire(mutex, stats);
+        ++states[id].messages;
+        (void)v;
+    }
+    void request(const std::string& id, WaitStats& stats) {
+        auto lock = acquire(mutex, stats);
+        auto it = states.find(id);
+        if (it != states.end()) xgcs_bench::keep(it->second.messages);
+    }
+    void fleet(WaitStats& stats) {
+        auto lock = acquire(mutex, stats);
+        uint64_t total = 0;
+        for (const auto& [id, state] : states) total += state.messages;
+        xgcs_bench::keep(total);
+    }
+    void upload(WaitStats& stats) {
+        auto lock = acquire(mutex, stats);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+};
+
+struct RegistryFleet {
+    VehicleRegistry registry;
+    std::vector<std::shared_ptr<VehicleContext>> contexts; // What each ingest stage holds
+
+    RegistryFleet() {
+        for (int v = 0; v < kVehicles; ++v) {
+            auto context = std::make_shared<VehicleContext>(vehicle_id(v), nullptr, 16);
+            registry.insert(context);
+            contexts.push_back(std::move(context));
+        }
+    }
+
+    // last_ack_command stands in for any mutex-guarded field
+    void ingest(int v, const std::string&, WaitStats& stats) {
+        VehicleContext& vehicle = *contexts[v];
+        auto lock = acquire(vehicle.mutex, stats);
+        ++vehicle.last_ack_command;
+    }
+    void request(const std::string& id, WaitStats& stats) {
+        auto vehicle = registry.find(id);
+        if (!vehicle) return;
+        auto lock = acquire(vehicle->mutex, stats);
+        xgcs_bench::keep(vehicle->last_ack_command);
+    }
+    void fleet(WaitStats& stats) {
+        uint64_t total = 0;
+        registry.for_each([&](const std::shared_ptr<VehicleContext>& vehicle) {
+            auto lock = acquire(vehicle->mutex, stats);
+            total += vehicle->last_ack_command;
+        });
+        xgcs_bench::keep(total);
+    }
+    void upload(WaitStats& stats) {
+        auto vehicle = registry.find(vehicle_id(0));
+        auto lock = acquire(vehicle->mutex, stats);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+};
+
+template <typename Fleet>
+void run_load(const char* label, Fleet& fleet) {
+    std::atomic<bool> stop{false};
+    std::vector<WaitStats> stats(kIngestThreads + kRequestThreads + 1);
+    std::vector<std::thread> threads;
+
+    std::vector<std::string> ids;
+    for (int v = 0; v < kVehicles; ++v) ids.push_back(vehicle_id(v));
+
+    for (int t = 0; t < kIngestThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const int per_thread = kVehicles / kIngestThreads;
+            for (int i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % per_thread) {
+                const int v = t * per_thread + i;
+                fleet.ingest(v, ids[v], stats[t]);
+            }
+        });
+    }
+    for (int t = 0; t < kRequestThreads; ++t) {
+        threads.emplace_back([&, t] {
+            uint32_t seed = 12345u + t;
+            while (!stop.load(std::memory_order_relaxed)) {
+                seed = seed * 1664525u + 1013904223u;
+                fleet.request(ids[(seed >> 8) % kVehicles], stats[kIngestThreads + t]);
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            fleet.fleet(stats[kIngestThreads + kRequestThreads]);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    threads.emplace_back([&] {
+        WaitStats upload_stats; // The cause, not a victim
+        while (!stop.load(std::memory_order_relaxed)) {
+            fleet.upload(upload_stats);
+            std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    stop = true;
+    for (auto& thread : threads) thread.join();
+
+    WaitStats total;
+    for (const auto& s : stats) total.merge(s);
+    std::printf("  %-22s %12llu locks/s %10.1f ns mean wait %12.1f us max wait\n", label,
+                static_cast<unsigned long long>(total.acquisitions),
+                total.acquisitions ? total.wait_ns / static_cast<double>(total.acquisitions) : 0.0,
+                total.max_wait_ns * 1e-3);
+}
+
+} // namespace
+
+BENCH(registry_lock_wait_100_vehicles) {
+    {
+        GlobalMutexFleet fleet;
+        run_load("global mutex", fleet);
+    }
+    {
+        RegistryFleet fleet;
+        run_load("registry + per-vehicle", fleet);
+    }
+}
@@ -0,0 +1,228 @@
+#include "bench.hpp"
+#include "connection_manager.hpp"
+#include "../tests/heartbeat_sender.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Requests per second on /telemetry and /api/vehicle/<id>/status, before
+// and after the telemetry snapshot, with 1 and 4 request threads.
+//
+// "after" calls the real builders, get_telemetry_data_json() and
+// get_vehicle_status(), on a vehicle added through add_vehicle() against a
+// loopback autopilot whose HEARTBEATs (200/s) run the ingest pipeline
+// meanwhile. "before" models the old handlers: ConnectionManager's one
+// mutex held for the whole request, every MAVSDK getter taking the plugin's
+// lock to copy its cached value (as TelemetryImpl does), the per-vehicle
+// maps looked up by id, and a json DOM dumped to text; a thread stands in
+// for the HEARTBEAT handler, which took the same mutex 200 times a second.
+
+std::string flight_mode_to_string(mavsdk::Telemetry::FlightMode mode);
+std::string ardupilot_custom_mode_to_string(uint8_t mav_type, uint32_t custom_mode);
+
+namespace {
+
+using json = nlohmann::json;
+
+constexpr uint16_t kPort = 24553;
+constexpr const char* kVehicle = "bench-1";
+
+// A MAVSDK getter: its own lock around a cached copy
+template <typename T>
+class Getter {
+public:
+    T operator()() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _value;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    T _value{};
+};
+
+struct LegacyTelemetry {
+    Getter<mavsdk::Telemetry::Position> position;
+    Getter<mavsdk::Telemetry::EulerAngle> attitude_euler;
+    Getter<mavsdk::Telemetry::Battery> battery;
+    Getter<mavsdk::Telemetry::FlightMode> flight_mode;
+    Getter<bool> armed;
+    Getter<bool> in_air;
+    Getter<mavsdk::Telemetry::VelocityNed> velocity_ned;
+    Getter<mavsdk::Telemetry::GpsInfo> gps_info;
+    Getter<mavsdk::Telemetry::Health> health;
+};
+
+struct LegacyRadio {
+    int rssi = 0, remrssi = 0, noise = 0, remnoise = 0, txbuf = 0, rxerrors = 0, fixed = 0;
+};
+
+class LegacyManager {
+public:
+    LegacyManager() {
+        _telemetry[kVehicle] = std::make_shared<LegacyTelemetry>();
+        _connected[kVehicle] = true;
+        _mav_type[kVehicle] = MAV_TYPE_QUADROTOR;
+        _custom_mode[kVehicle] = 0;
+        _radio[kVehicle] = LegacyRadio{};
+        _radio_sim_enabled[kVehicle] = false;
+    }
+
+    void heartbeat(uint32_t custom_mode) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _custom_mode[kVehicle] = custom_mode;
+    }
+
+    std::string telemetry_json(const std::string& id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_connected.count(id)) return json{{"success", false}, {"error", "Vehicle not found"}}.dump();
+        auto telemetry = _telemetry.at(id);
+        auto position = telemetry->position();
+        auto attitude = telemetry->attitude_euler();
+        auto battery = telemetry->battery();
+        auto flight_mode = telemetry->flight_mode();
+        auto armed = telemetry->armed();
+        auto velocity = telemetry->velocity_ned();
+        auto gps_info = telemetry->gps_info();
+        LegacyRadio radio = _radio[id];
+        if (_radio_sim_enabled[id]) radio = _radio[id];
+        const double speed = std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s);
+        return json{
+            {"success", true},
+            {"position", {{"lat", position.latitude_deg}, {"lng", position.longitude_deg}, {"alt", position.relative_altitude_m}}},
+            {"attitude", {{"roll", attitude.roll_deg}, {"pitch", attitude.pitch_deg}, {"yaw", attitude.yaw_deg}}},
+            {"battery", {{"voltage", battery.voltage_v}, {"remaining", battery.remaining_percent}}},
+            {"flight_mode", mode_string(id, flight_mode)},
+            {"armed", armed},
+            {"in_air", armed && position.relative_altitude_m > 1.0},
+            {"velocity", {{"airspeed", speed}, {"groundspeed", speed},
+                          {"heading", std::atan2(velocity.east_m_s, velocity.north_m_s) * 180.0 / M_PI}}},
+            {"gps", {{"satellites", gps_info.num_satellites}, {"fix_type", static_cast<int>(gps_info.fix_type)}}},
+            {"radio", {{"rssi", radio.rssi}, {"remrssi", radio.remrssi}, {"noise", radio.noise}, {"remnoise", radio.remnoise},
+                       {"txbuf", radio.txbuf}, {"rxerrors", radio.rxerrors}, {"fixed", radio.fixed}}},
+            {"connectionStatus", _connected.at(id) ? "connected" : "disconnected"}
+        }.dump();
+    }
+
+    std::string status_json(const std::string& id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_connected.count(id)) return json{{"success", false}, {"error", "Vehicle not found"}}.dump();
+        auto telemetry = _telemetry.at(id);
+        auto position = telemetry->position();
+        auto attitude = telemetry->attitude_euler();
+        auto battery = telemetry->battery();
+        auto flight_mode = telemetry->flight_mode();
+        auto armed = telemetry->armed();
+        auto in_air = telemetry->in_air();
+        auto velocity = telemetry->velocity_ned();
+        auto gps_info = telemetry->gps_info();
+        auto health = telemetry->health();
+        return json{
+            {"success", true},
+            {"vehicle_id", id},
+            {"connected", _connected.at(id)},
+            {"armed", armed},
+            {"in_air", in_air},
+            {"flight_mode", mode_string(id, flight_mode)},
+            {"position", {{"lat", position.latitude_deg}, {"lng", position.longitude_deg},
+                          {"alt_rel", position.relative_altitude_m}, {"alt_abs", position.absolute_altitude_m}}},
+            {"attitude", {{"roll", attitude.roll_deg}, {"pitch", attitude.pitch_deg}, {"yaw", attitude.yaw_deg}}},
+            {"velocity", {{"north", velocity.north_m_s}, {"east", velocity.east_m_s}, {"down", velocity.down_m_s},
+                          {"groundspeed", std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s)}}},
+            {"battery", {{"voltage", battery.voltage_v}, {"remaining", battery.remaining_percent}, {"current", battery.current_battery_a}}},
+            {"gps", {{"satellites", gps_info.num_satellites}, {"fix_type", static_cast<int>(gps_info.fix_type)}}},
+            {"health", {{"is_gyrometer_calibration_ok", health.is_gyrometer_calibration_ok},
+                        {"is_accelerometer_calibration_ok", health.is_accelerometer_calibration_ok},
+                        {"is_magnetometer_calibration_ok", health.is_magnetometer_calibration_ok},
+                        {"is_local_position_ok", health.is_local_position_ok},
+                        {"is_global_position_ok", health.is_global_position_ok},
+                        {"is_home_position_ok", health.is_home_position_ok}}}
+        }.dump();
+    }
+
+private:
+    // Caller holds _mutex
+    std::string mode_string(const std::string& id, mavsdk::Telemetry::FlightMode flight_mode) {
+        std::string mode = flight_mode_to_string(flight_mode);
+        auto type = _mav_type.find(id);
+        auto custom = _custom_mode.find(id);
+        if (type != _mav_type.end() && custom != _custom_mode.end()) mode = ardupilot_custom_mode_to_string(type->second, custom->second);
+        return mode;
+    }
+
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<LegacyTelemetry>> _telemetry;
+    std::unordered_map<std::string, bool> _connected;
+    std::unordered_map<std::string, uint8_t> _mav_type;
+    std::unordered_map<std::string, uint32_t> _custom_mode;
+    std::unordered_map<std::string, LegacyRadio> _radio;
+    std::unordered_map<std::string, bool> _radio_sim_enabled;
+};
+
+// Requests per second from `threads` threads calling request() for 300 ms
+template <typename Request>
+double requests_per_second(int threads, Request&& request) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> requests{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            uint64_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const std::string body = request();
+                xgcs_bench::keep(body);
+                ++local;
+            }
+            requests.fetch_add(local);
+        });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    stop = true;
+    for (auto& worker : workers) worker.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(requests.load()) / elapsed.count();
+}
+
+void report_rate(const std::string& label, double per_second) {
+    xgcs_bench::report(label.c_str(), per_second > 0 ? 1e9 / per_second : 0.0);
+}
+
+} // namespace
+
+BENCH(telemetry_request_throughput) {
+    auto& cm = ConnectionManager::instance();
+    xgcs_test::HeartbeatSender sender(kPort);
+    if (!cm.add_vehicle(kVehicle, "udp://:" + std::to_string(kPort))) {
+        std::printf("  no loopback vehicle on port %u, skipped\n", kPort);
+        return;
+    }
+
+    LegacyManager legacy;
+    std::atomic<bool> stop_heartbeats{false};
+    std::thread heartbeats([&] {
+        for (uint32_t i = 0; !stop_heartbeats.load(std::memory_order_relaxed); ++i) {
+            legacy.heartbeat(i & 7);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    for (int threads : {1, 4}) {
+        const std::string suffix = ", " + std::to_string(threads) + " thread(s)";
+        report_rate("/telemetry before" + suffix, requests_per_second(threads, [&] { return legacy.telemetry_json(kVehicle); }));
+        report_rate("/telemetry after" + suffix, requests_per_second(threads, [&] { return cm.get_telemetry_data_json(kVehicle); }));
+        report_rate("/status before" + suffix, requests_per_second(threads, [&] { return legacy.status_json(kVehicle); }));
+        report_rate("/status after" + suffix, requests_per_second(threads, [&] { return cm.get_vehicle_status(kVehicle); }));
+    }
+
+    stop_heartbeats = true;
+    heartbeats.join();
+    cm.remove_vehicle(kVehicle);
+}
@@ -6,10 +6,15 @@
 #include <mavsdk/plugins/mavlink_passthrough/mavlink_passthrough.h>
 #include <mavsdk/plugins/geofence/geofence.h> // Added Geofence support
 #include <nlohmann/json.hpp>
+#include "field_projection.hpp"
+#include "radio_link_batch.hpp"
+#include "vehicle_registry.hpp"
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <queue>
@@ -31,20 +36,99 @@ public:
     void remove_vehicle(const std::string& vehicle_id);
     bool is_vehicle_connected(const std::string& vehicle_id) const;
     std::vector<std::string> get_connected_vehicles() const;
-    std::string get_telemetry_data_json(const std::string& vehicle_id);
+    // Documents that accept a field selection (?fields=battery,position.alt)
+    enum class TelemetryDocument { Telemetry, Status, Fleet };
+    // Compiled once per distinct selection and cached; nullptr and `error`
+    // on an unknown field. Empty selects everything.
+    static std::shared_ptr<const FieldProjection> compile_fields(TelemetryDocument document, std::string_view fields,
+                                                                 std::string& error);
+    static const FieldProjection& all_fields(TelemetryDocument document);
+
+    // Read from the vehicle's telemetry snapshot without locks or MAVSDK
+    // calls; "timestamp" is when the snapshot was last updated (epoch ms).
+    // `fields` (from compile_fields(Telemetry, ...)) limits what is read and
+    // written; nullptr writes everything.
+    std::string get_telemetry_data_json(const std::string& vehicle_id, const FieldProjection* fields = nullptr);
+    // Same snapshot as a JSON object, for callers that add to it or diff it.
+    // Leaves the timestamp out (so unchanged telemetry diffs empty) and
+    // reports it through `updated_ms` instead.
+    json get_telemetry_data(const std::string& vehicle_id, int64_t* updated_ms = nullptr);
 
     // MAVLink Message Streaming
-    void start_mavlink_streaming(const std::string& vehicle_id);
+    // Reference-counted per vehicle: frames are drained and fanned out while
+    // at least one subscriber is attached. The inspector ring records either
+    // way, so a client that drops and resumes gets what it missed. Each
+    // successful start (true) must be paired with exactly one stop; a stop
+    // with no subscribers left is a no-op.
+    bool start_mavlink_streaming(const std::string& vehicle_id);
     void stop_mavlink_streaming(const std::string& vehicle_id);
-    std::vector<json> get_mavlink_messages(const std::string& vehicle_id);
+    // Per vehicle: stream subscribers, passthrough callbacks registered and
+    // frames the stream reader lost to ring overwrites
+    json get_mavlink_stream_subscriptions() const;
+    // Frames drained from one vehicle's inspector ring. Encodings are
+    // produced on demand and cached per (frame, format), so each is
+    // serialized once however many clients receive it.
+    class StreamBatch {
+    public:
+        using Message = StreamMessage;
+
+        bool empty() const { return _messages.empty(); }
+        const std::vector<Message>& messages() const { return _messages; }
+        std::shared_ptr<const std::string> encode(const Message& message, StreamFormat format) const;
+
+        // Stream position this batch was drained from (its first sequence,
+        // unless the reader had fallen behind); false when not streaming
+        bool valid() const { return _vehicle != nullptr; }
+        uint64_t start_sequence() const { return _start; }
+        // First sequence still held in the ring when the batch was taken
+        uint64_t oldest_sequence() const { return _oldest; }
+
+    private:
+        friend class ConnectionManager;
+        std::shared_ptr<VehicleContext> _vehicle;
+        std::vector<Message> _messages;
+        uint64_t _start = 0;
+        uint64_t _oldest = 0;
+    };
+    StreamBatch get_mavlink_messages(const std::string& vehicle_id);
+    // Frames [from, to) that the vehicle's ring still holds, for clients
+    // resuming after a reconnect. Evicted frames are simply absent: the
+    // result starts at max(from, oldest_sequence()).
+    StreamBatch replay_mavlink_messages(const std::string& vehicle_id, uint64_t from, uint64_t to);
+
+    // Event-driven draining: returns once any vehicle has streamed a frame
+    // since `epoch` (start from mavlink_message_epoch()), after `timeout`, or
+    // after shutdown_mavlink_streams(). Returns the epoch for the next call.
+    uint64_t wait_for_mavlink_messages(uint64_t epoch, std::chrono::milliseconds timeout);
+    uint64_t mavlink_message_epoch() const;
+    void shutdown_mavlink_streams();
+    static bool parse_stream_format(const std::string& name, StreamFormat& format);
 
     // Mission Management
     bool upload_mission(const std::string& vehicle_id, const json& mission_json);
     std::string download_mission(const std::string& vehicle_id);  // NEW: Download mission from vehicle
     void start_mission(const std::string& vehicle_id);
     void clear_mission(const std::string& vehicle_id);
-    std::string get_vehicle_status(const std::string& vehicle_id);  // NEW: Get comprehensive vehicle status
-    std::string get_all_vehicle_statuses(); // NEW: Bulk vehicle status retrieval
+    std::string get_vehicle_status(const std::string& vehicle_id, const FieldProjection* fields = nullptr);  // NEW: Get comprehensive vehicle status
+    // Bulk vehicle status retrieval. `validator`, when given, receives the
+    // vehicle list again with every timestamp zeroed: it changes only when
+    // the content does, for deriving a cache ETag.
+    std::string get_all_vehicle_statuses(const FieldProjection* fields = nullptr, std::string* validator = nullptr);
+    // Compact fleet frame for the fleet stream: parallel arrays, one entry
+    // per vehicle, {"type": "fleet", "time": ms, "ids", "lat", "lng", "alt",
+    // "heading", "battery", "mode"}. Missing telemetry reads as null / "".
+    std::string get_fleet_columns_json();
+    // Recorded telemetry for charts: each channel's samples in [from_ms, to_ms]
+    // (epoch ms), downsampled to at most max_points per channel:
+    // {"success", "vehicleId", "from", "to", "intervalMs", "fields": {name:
+    //  {"time": [...], "values": [...], "samples": n before downsampling}}}
+    json get_telemetry_history(const std::string& vehicle_id, const std::vector<HistoryChannel>& channels,
+                               int64_t from_ms, int64_t to_ms, std::size_t max_points, HistoryDownsample mode);
+    // Per-message link statistics from the ingest path: {"success",
+    // "vehicleId", "rateHz", "bytesPerSec", "messages": {name: {"msgid",
+    // "count", "bytes", "rateHz", "bytesPerSec", "jitterMs", "lastSeen" (epoch
+    // ms), "requestedHz" (0 when no interval was requested)}}}
+    json get_link_stats(const std::string& vehicle_id);
     
     
     // --- Jeremy: Add command methods for flight control ---
@@ -109,76 +193,36 @@ private:
     ~ConnectionManager() = default;
 
     mavsdk::Mavsdk _mavsdk;
-    mutable std::mutex _mutex;
 
-    std::unordered_map<std::string, std::shared_ptr<mavsdk::System>> _systems;
-    std::unordered_map<std::string, std::shared_ptr<mavsdk::Telemetry>> _telemetry_plugins;
-    std::unordered_map<std::string, std::shared_ptr<mavsdk::MissionRaw>> _mission_raw_plugins; // NEW: Raw mission control
-    std::unordered_map<std::string, std::shared_ptr<mavsdk::Geofence>> _geofence_plugins;
-    std::unordered_map<std::string, std::shared_ptr<mavsdk::MavlinkPassthrough>> _mavlink_passthrough_plugins;
-    
-    // MAVLink message storage
-    std::unordered_map<std::string, std::queue<json>> _mavlink_messages;
-    std::unordered_map<std::string, bool> _streaming_active;
+    // Declared before _registry so it outlives every vehicle pointing at it
+    StreamNotifier _stream_notifier;
+
+    // Per-vehicle state lives in VehicleContext, each behind its own lock.
+    // The registry itself is read lock-free.
+    VehicleRegistry _registry;
     
-    // MAVLink message handlers
-    void handle_mavlink_message(const std::string& vehicle_id, const mavlink_message_t& message);
-    void setup_mavlink_subscriptions(const std::string& vehicle_id);
-    std::string get_mavlink_message_name(uint16_t msgid);
-    json decode_mavlink_message(const mavlink_message_t& message);
-
-    // --- Mode/state tracking for QGC-like behavior ---
-    // Stores last-known mode bits and MAV type to enable correct mode mapping and base_mode preservation
-    std::unordered_map<std::string, uint8_t>  _last_base_mode;     // from HEARTBEAT.base_mode
-    std::unordered_map<std::string, uint32_t> _last_custom_mode;   // from HEARTBEAT.custom_mode
-    std::unordered_map<std::string, uint8_t>  _last_mav_type;      // from HEARTBEAT.type (MAV_TYPE_*)
-    std::unordered_map<std::string, uint8_t>  _last_autopilot;     // from HEARTBEAT.autopilot (MAV_AUTOPILOT_*)
-
-    struct CalibrationStatus {
-        bool active = false;
-        float progress = 0.0f;
-        std::string status_text;
-        bool success = false;
-        std::vector<float> compass_progress = {0, 0, 0};
-        std::vector<bool> compass_complete = {false, false, false};
-    };
-    std::unordered_map<std::string, CalibrationStatus> _calibration_status;
-
-
-    // Radio Status Storage
-    struct RadioStatus {
-        int rssi = 0;
-        int remrssi = 0;
-        int noise = 0;
-        int remnoise = 0;
-        int txbuf = 0;
-        int rxerrors = 0;
-        int fixed = 0;
-    };
-    std::unordered_map<std::string, RadioStatus> _radio_status;
-
-    // COMMAND_ACK synchronization
-    std::condition_variable _ack_cv;
-    // Last ack seen per vehicle
-    std::unordered_map<std::string, uint16_t> _last_ack_command;   // MAV_CMD_*
-    std::unordered_map<std::string, uint8_t>  _last_ack_result;    // MAV_RESULT_*
-
-    // Simulation Parameters
-    struct RadioSimulationParams {
-        bool enabled = false;
-        double frequency_mhz = 915.0;
-        double tx_power_dbm = 30.0;
-        double tx_gain_dbi = 3.0;
-        double rx_gain_dbi = 3.0;
-        double noise_floor_dbm = -100.0;
-    };
-    std::unordered_map<std::string, RadioSimulationParams> _radio_sim_params;
+    // MAVLink ingest stages
+    void setup_ingest_pipeline(const std::shared_ptr<VehicleContext>& context);
+    static void ingest_vehicle_state(VehicleContext& vehicle, const mavlink_message_t& message);   // Always on, no allocation
+    static void stream_mavlink_message(VehicleContext& vehicle, const mavlink_message_t& message); // Only while a client streams
+    // Inspector stream encoders, one per StreamFormat; consumer side, via VehicleContext::stream_cache
+    static void write_stream_frame(const StreamMessage& stream_message, std::string& out);
+    static void write_stream_frame_mavlink(const StreamMessage& stream_message, std::string& out);
+    static void write_stream_frame_cbor(const StreamMessage& stream_message, std::string& out);
+    static json decode_mavlink_message(const mavlink_message_t& message);
 
     // Simulation Methods
 public:
     void set_radio_simulation(const std::string& vehicle_id, bool enabled, double freq, double tx_pwr, double tx_gain, double rx_gain);
+    // One simulation tick: recomputes synthetic RSSI for every vehicle with
+    // radio simulation enabled, as one batch, and publishes it into each
+    // vehicle's snapshot. Driven by a timer thread at XGCS_RADIO_SIM_HZ;
+    // call from one thread only.
+    void update_radio_simulation();
 
 private:
-    // Helper to calculate synthetic RSSI
-    void update_radio_simulation(const std::string& vehicle_id);
+    // Scratch for update_radio_simulation(), reused every tick
+    RadioLinkBatch _radio_batch;
+    std::vector<std::shared_ptr<VehicleContext>> _radio_vehicles;
+    std::vector<double> _radio_noise_dbm;
 }; 
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "json_writer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// A field selection such as "battery,position.alt", compiled against one
+// FieldSchema into a flat list of writer operations. Serializing through it
+// visits only the selected leaves; nothing else is read or written.
+class FieldProjection {
+public:
+    struct Op {
+        enum class Kind : uint8_t { Open, Close, Leaf };
+        Kind kind;
+        std::string_view key; // Object key (Open, Leaf)
+        uint16_t field = 0;   // Schema leaf index (Leaf)
+    };
+
+    const std::vector<Op>& ops() const { return _ops; }
+
+private:
+    friend class FieldSchemaBase;
+    std::vector<Op> _ops;
+    const void* _schema = nullptr; // Owner, for sanity checks
+};
+
+// Paths of a document's leaves and the compiler for selections over them.
+// Leaves are listed in the order the document is written: nlohmann's sorted
+// key order, so output matches the DOM it replaces byte for byte.
+class FieldSchemaBase {
+public:
+    struct Leaf {
+        std::string_view path; // Dotted, e.g. "position.alt"
+        bool always;           // Included in every projection (e.g. "success")
+    };
+
+    explicit FieldSchemaBase(std::vector<Leaf> leaves);
+
+    FieldSchemaBase(const FieldSchemaBase&) = delete;
+    FieldSchemaBase& operator=(const FieldSchemaBase&) = delete;
+
+    // Comma-separated dotted paths; each selects a leaf or a whole object.
+    // Compiled once per distinct string and cached (up to a bound; beyond
+    // it, new selections are compiled per call). An empty string selects
+    // everything. Returns nullptr and sets `error` on an unknown path.
+    std::shared_ptr<const FieldProjection> compile(std::string_view selection, std::string& error) const;
+
+    // Selection of every leaf
+    const FieldProjection& all() const { return *_all; }
+
+    std::size_t cached_projections() const;
+
+protected:
+    void check_owner(const FieldProjection& projection) const;
+
+private:
+    std::shared_ptr<FieldProjection> build(const std::vector<bool>& selected) const;
+
+    static constexpr std::size_t kMaxCachedProjections = 256;
+
+    const std::vector<Leaf> _leaves;
+    std::shared_ptr<const FieldProjection> _all;
+    mutable std::mutex _mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<const FieldProjection>> _cache; // Guarded by _mutex
+};
+
+// A document over `View` (whatever the leaves read from): one writer per
+// leaf, in FieldSchemaBase order. Leaves are written as generic lambdas
+// (`[](const View& v, auto& w) { ... }`) so the same list serves JsonWriter
+// for responses and JsonDomWriter where a DOM is needed.
+template <typename View>
+class FieldSchema : public FieldSchemaBase {
+public:
+    template <typename Writer>
+    using Write = void (*)(const View& view, Writer& writer);
+
+    struct Field {
+        template <typename Leaf>
+        Field(std::string_view path, Leaf leaf, bool always = false)
+            : path(path), text(leaf), dom(leaf), always(always) {}
+
+        std::string_view path;
+        Write<JsonWriter> text;
+        Write<JsonDomWriter> dom;
+        bool always;
+    };
+
+    explicit FieldSchema(std::vector<Field> fields) : FieldSchemaBase(leaves_of(fields)) {
+        _text_writers.reserve(fields.size());
+        _dom_writers.reserve(fields.size());
+        for (const Field& field : fields) {
+            _text_writers.push_back(field.text);
+            _dom_writers.push_back(field.dom);
+        }
+    }
+
+    // Writes the projected document as one JSON object
+    template <typename Writer>
+    void write(const View& view, const FieldProjection& projection, Writer& writer) const {
+        const std::vector<Write<Writer>>& writers = writers_for<Writer>();
+        check_owner(projection);
+        writer.begin_object();
+        for (const auto& op : projection.ops()) {
+            switch (op.kind) {
+                case FieldProjection::Op::Kind::Open:
+                    writer.key(op.key);
+                    writer.begin_object();
+                    break;
+                case FieldProjection::Op::Kind::Close:
+                    writer.end_object();
+                    break;
+                case FieldProjection::Op::Kind::Leaf:
+                    writer.key(op.key);
+                    writers[op.field](view, writer);
+                    break;
+            }
+        }
+        writer.end_object();
+    }
+
+private:
+    template <typename Writer>
+    const std::vector<Write<Writer>>& writers_for() const {
+        if constexpr (std::is_same_v<Writer, JsonDomWriter>) {
+            return _dom_writers;
+        } else {
+            return _text_writers;
+        }
+    }
+
+    static std::vector<Leaf> leaves_of(const std::vector<Field>& fields) {
+        std::vector<Leaf> leaves;
+        leaves.reserve(fields.size());
+        for (const Field& field : fields) leaves.push_back({field.path, field.always});
+        return leaves;
+    }
+
+    std::vector<Write<JsonWriter>> _text_writers;
+    std::vector<Write<JsonDomWriter>> _dom_writers;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Bounded single-producer / multi-consumer ring of fixed-size records.
+//
+// The producer (a vehicle's MAVSDK receive thread) never waits for anyone:
+// once the ring is full it overwrites the oldest slot. Each consumer owns a Reader with its own cursor, so consumers do
+// not contend with each other or with the producer. A reader that falls more
+// than capacity() records behind skips ahead to the oldest record still in
+// the ring and adds what it missed to its own drop counter.
+//
+// Slots are versioned (seqlock style): the producer marks a slot odd while
+// writing it and publishes the record's sequence number when done, and a
+// reader rechecks the version after copying, so a torn copy is detected and
+// counted as a drop rather than returned.
+template <typename T>
+class FrameRing {
+    static_assert(std::is_trivially_copyable_v<T>, "FrameRing stores records by value");
+
+public:
+    // Capacity is rounded up to a power of two (minimum 2).
+    explicit FrameRing(std::size_t capacity)
+        : _capacity(round_up(capacity)), _mask(_capacity - 1), _slots(new Slot[_capacity]) {
+        for (std::size_t i = 0; i < _capacity; ++i) {
+            _slots[i].version.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    std::size_t capacity() const { return _capacity; }
+
+    // Total records ever pushed; also the sequence number of the next one.
+    uint64_t written() const { return _head.load(std::memory_order_acquire); }
+
+    // Sequence number of the oldest record still held.
+    uint64_t oldest() const {
+        const uint64_t head = written();
+        return head > _capacity ? head - _capacity : 0;
+    }
+
+    // Producer side. Single producer only.
+    void push(const T& record) {
+        const uint64_t seq = _head.load(std::memory_order_relaxed);
+        Slot& slot = _slots[seq & _mask];
+        slot.version.store(seq * 2 + 1, std::memory_order_relaxed); // Writing
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.record, &record, sizeof(T));
+        slot.version.store(seq * 2 + 2, std::memory_order_release);  // Holds record `seq`
+        _head.store(seq + 1, std::memory_order_release);
+    }
+
+    // One consumer's position in the ring. Not thread-safe on its own; each
+    // consumer thread uses its own Reader.
+    class Reader {
+    public:
+        // Starts at the producer's current position (only new records).
+        explicit Reader(const FrameRing& ring) : _ring(&ring), _cursor(ring.written()) {}
+        // Starts at `position`, for replaying records still in the ring. A
+        // position already overwritten reads from the oldest one left.
+        Reader(const FrameRing& ring, uint64_t position) : _ring(&ring), _cursor(std::min(position, ring.written())) {}
+
+        // Copies the next record into `out`. Returns false when caught up.
+        bool next(T& out) {
+            for (;;) {
+                const uint64_t head = _ring->written();
+                if (_cursor == head) return false;
+                if (head - _cursor > _ring->_capacity) {
+                    skip_to(head - _ring->_capacity);
+                }
+
+                const Slot& slot = _ring->_slots[_cursor & _ring->_mask];
+                const uint64_t expected = _cursor * 2 + 2;
+                if (slot.version.load(std::memory_order_acquire) != expected) {
+                    // Producer lapped us between the head load and here
+                    skip_to(_cursor + 1);
+                    continue;
+                }
+                std::memcpy(&out, &slot.record, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) != expected) {
+                    skip_to(_cursor + 1); // Torn copy
+                    continue;
+                }
+                ++_cursor;
+                return true;
+            }
+        }
+
+        // Records available right now (may include ones that will be dropped).
+        uint64_t pending() const { return _ring->written() - _cursor; }
+
+        // Records this reader missed because the producer overwrote them.
+        uint64_t dropped() const { return _dropped; }
+
+        uint64_t position() const { return _cursor; }
+
+    private:
+        void skip_to(uint64_t position) {
+            _dropped += position - _cursor;
+            _cursor = position;
+        }
+
+        const FrameRing* _ring;
+        uint64_t _cursor;
+        uint64_t _dropped = 0;
+    };
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> version; // 2*seq+1 while writing, 2*seq+2 once record `seq` is in place
+        T record;
+    };
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    const std::size_t _capacity;
+    const std::size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+    alignas(64) std::atomic<uint64_t> _head{0};
+};
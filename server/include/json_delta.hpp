@@ -0,0 +1,29 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// What changed from `from` to `to`, as an RFC 7396 JSON merge patch: applying
+// it to `from` (json::merge_patch, or a deep Object.assign in the browser)
+// gives back `to`. Nested objects are diffed key by key; anything else that
+// differs is replaced whole, and keys missing from `to` come out as null.
+// An empty object means nothing changed. Both arguments must be objects.
+inline json json_merge_diff(const json& from, const json& to) {
+    json patch = json::object();
+    for (auto it = to.begin(); it != to.end(); ++it) {
+        auto previous = from.find(it.key());
+        if (previous == from.end()) {
+            patch[it.key()] = it.value();
+        } else if (previous->is_object() && it->is_object()) {
+            json nested = json_merge_diff(*previous, *it);
+            if (!nested.empty()) patch[it.key()] = std::move(nested);
+        } else if (*previous != *it) {
+            patch[it.key()] = it.value();
+        }
+    }
+    for (auto it = from.begin(); it != from.end(); ++it) {
+        if (!to.contains(it.key())) patch[it.key()] = nullptr;
+    }
+    return patch;
+}
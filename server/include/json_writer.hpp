@@ -0,0 +1,229 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// append_double() relies on nlohmann::detail::to_chars, which is not public
+// API; the build pins the library (see CMakeLists.txt), this catches a
+// header picked up from elsewhere
+static_assert(NLOHMANN_JSON_VERSION_MAJOR == 3 && NLOHMANN_JSON_VERSION_MINOR >= 10,
+              "JsonWriter is verified against nlohmann_json 3.10+ (3.x) only");
+
+// Append-only JSON emitter that writes straight into a caller-owned buffer.
+//
+// Output matches nlohmann::json::dump() byte for byte for the same values
+// written in the same (sorted) key order:
+// - integers go through std::to_chars; floats through the library's own
+//   dtoa, so "0.0", "1e+20", "2.5e-05" come out exactly as dump() writes them
+// - non-finite numbers become null
+// - strings get the same escapes. dump() throws on invalid UTF-8; here
+//   each bad byte becomes U+FFFD instead
+//
+// Keys are not sorted here; callers emit them in order. Reuse one buffer
+// (clear() keeps its capacity) and steady-state writes allocate nothing.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : _out(out) {}
+
+    void begin_object() { separator(); _out += '{'; _need_comma = false; }
+    void end_object() { _out += '}'; _need_comma = true; }
+    void begin_array() { separator(); _out += '['; _need_comma = false; }
+    void end_array() { _out += ']'; _need_comma = true; }
+
+    // Key must not need escaping (MAVLink field names never do)
+    void key(std::string_view name) {
+        separator();
+        _out += '"';
+        _out.append(name.data(), name.size());
+        _out += "\":";
+        _need_comma = false;
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    void value(T number) {
+        separator();
+        char buf[24];
+        // 8-bit types are numbers, never characters
+        auto result = std::to_chars(buf, buf + sizeof(buf),
+                                    static_cast<std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>(number));
+        _out.append(buf, static_cast<std::size_t>(result.ptr - buf));
+        _need_comma = true;
+    }
+
+    void value(double number) {
+        separator();
+        append_double(_out, number);
+        _need_comma = true;
+    }
+    void value(float number) { value(static_cast<double>(number)); }
+
+    void value(bool flag) {
+        separator();
+        _out += flag ? "true" : "false";
+        _need_comma = true;
+    }
+
+    void value(std::string_view text) {
+        separator();
+        append_string(_out, text);
+        _need_comma = true;
+    }
+    void value(const char* text) { value(std::string_view(text)); }
+
+    void null() {
+        separator();
+        _out += "null";
+        _need_comma = true;
+    }
+
+    // Already-serialized JSON value
+    void raw(std::string_view json_text) {
+        separator();
+        _out.append(json_text.data(), json_text.size());
+        _need_comma = true;
+    }
+
+    static void append_double(std::string& out, double number) {
+        if (!std::isfinite(number)) {
+            out += "null";
+            return;
+        }
+        // nlohmann's own dtoa kernel (Grisu2 + its fixed/exponent layout).
+        // std::to_chars is shortest-round-trip too but picks a different
+        // last digit for ~1.5% of values (most of them widened floats, i.e.
+        // most MAVLink fields), which would break byte equality.
+        char buf[64];
+        char* end = nlohmann::detail::to_chars(buf, buf + sizeof(buf), number);
+        out.append(buf, static_cast<std::size_t>(end - buf));
+    }
+
+    static void append_string(std::string& out, std::string_view text) {
+        out += '"';
+        const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+        const auto* end = p + text.size();
+        while (p < end) {
+            const unsigned char c = *p;
+            if (c < 0x80) {
+                switch (c) {
+                    case '"':  out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\b': out += "\\b"; break;
+                    case '\f': out += "\\f"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (c < 0x20) {
+                            static const char kHex[] = "0123456789abcdef";
+                            out += "\\u00";
+                            out += kHex[c >> 4];
+                            out += kHex[c & 0xF];
+                        } else {
+                            out += static_cast<char>(c);
+                        }
+                }
+                ++p;
+                continue;
+            }
+            const std::size_t length = utf8_sequence_length(p, end);
+            if (length == 0) {
+                out += "\xEF\xBF\xBD"; // U+FFFD
+                ++p;
+            } else {
+                out.append(reinterpret_cast<const char*>(p), length);
+                p += length;
+            }
+        }
+        out += '"';
+    }
+
+private:
+    void separator() {
+        if (_need_comma) _out += ',';
+    }
+
+    // Length of the well-formed UTF-8 sequence at p, or 0 if malformed
+    static std::size_t utf8_sequence_length(const unsigned char* p, const unsigned char* end) {
+        const unsigned char c = p[0];
+        std::size_t length;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0) lo = 0xA0;
+            if (c == 0xED) hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0) lo = 0x90;
+            if (c == 0xF4) hi = 0x8F;
+        } else {
+            return 0;
+        }
+        if (static_cast<std::size_t>(end - p) < length) return 0;
+        if (p[1] < lo || p[1] > hi) return 0;
+        for (std::size_t i = 2; i < length; ++i) {
+            if (p[i] < 0x80 || p[i] > 0xBF) return 0;
+        }
+        return length;
+    }
+
+    std::string& _out;
+    bool _need_comma = false;
+};
+
+// The same calls as JsonWriter, building a DOM instead of text, for callers
+// that go on to diff or edit the document. Non-finite numbers become null,
+// as they would in the serialized form; strings are stored as given.
+class JsonDomWriter {
+public:
+    explicit JsonDomWriter(nlohmann::json& out) : _out(out) {}
+
+    void begin_object() { _open.push_back(&emplace(nlohmann::json::object())); }
+    void end_object() { _open.pop_back(); }
+    void begin_array() { _open.push_back(&emplace(nlohmann::json::array())); }
+    void end_array() { _open.pop_back(); }
+
+    void key(std::string_view name) { _key = name; }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    void value(T number) {
+        emplace(static_cast<std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>(number));
+    }
+    void value(double number) {
+        if (std::isfinite(number)) {
+            emplace(number);
+        } else {
+            emplace(nullptr);
+        }
+    }
+    void value(float number) { value(static_cast<double>(number)); }
+    void value(bool flag) { emplace(flag); }
+    void value(std::string_view text) { emplace(std::string(text)); }
+    void value(const char* text) { value(std::string_view(text)); }
+    void null() { emplace(nullptr); }
+
+private:
+    // Into the innermost open container, under the last key if an object.
+    // Only the innermost one grows, so the pointers to those outside stay valid.
+    nlohmann::json& emplace(nlohmann::json value) {
+        if (_open.empty()) return _out = std::move(value);
+        nlohmann::json& parent = *_open.back();
+        if (parent.is_array()) {
+            parent.push_back(std::move(value));
+            return parent.back();
+        }
+        return parent[std::string(_key)] = std::move(value);
+    }
+
+    nlohmann::json& _out;
+    std::vector<nlohmann::json*> _open;
+    std::string_view _key;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <mavsdk/mavlink/common/mavlink.h>
+#include "msgid_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// How often, how large and how regularly each message id arrives from one
+// vehicle, kept by the ingest path so stream rates can be checked against
+// what was requested without a packet capture.
+//
+// Slots are created up front with track() / set_requested_interval() before
+// messages flow; after that the table never grows, record() is called by
+// the single ingest thread and readers load the counters without locking.
+// A summary may mix counters from adjacent packets, which is fine for stats.
+class LinkStats {
+public:
+    struct Summary {
+        uint32_t msgid = 0;
+        uint64_t count = 0;
+        uint64_t bytes = 0;         // On the wire, header and signature included
+        double rate_hz = 0;         // EWMA; decays once the message stops arriving
+        double bytes_per_sec = 0;
+        double jitter_ms = 0;       // EWMA of |interval - mean interval|
+        int64_t last_seen_us = 0;   // Epoch microseconds, 0 if never seen
+        double requested_hz = 0;    // SET_MESSAGE_INTERVAL rate asked for, 0 if none
+    };
+
+    LinkStats() = default;
+    LinkStats(const LinkStats&) = delete;
+    LinkStats& operator=(const LinkStats&) = delete;
+
+    // Setup only, before the owning vehicle is shared
+    void track(uint32_t msgid);
+    void set_requested_interval(uint32_t msgid, int64_t interval_us);
+
+    // Ingest thread only. Ids without a slot are ignored.
+    void record(const mavlink_message_t& message, int64_t now_us);
+
+    // Every id seen or requested, in msgid order
+    std::vector<Summary> summarize(int64_t now_us) const;
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<int64_t> last_us{0};
+        std::atomic<float> interval_us{0}; // EWMA, once two have arrived
+        std::atomic<float> jitter_us{0};
+        std::atomic<float> size{0};        // EWMA bytes per message
+        int64_t requested_interval_us = 0; // Set during setup
+    };
+
+    MsgIdTable<Entry> _entries;
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous structured logger.
+//
+// Call sites format into a fixed-size record on the stack (no heap, no
+// stream flush) and push it onto a lock-free bounded ring; a background
+// thread drains the ring and writes batches to stdout/stderr. When the ring
+// is full records are dropped and counted rather than blocking the caller,
+// which is usually a MAVSDK receive thread.
+//
+//   LOG_INFO("TLog") << "Started recording: " << path;
+//   LOG_DEBUG("MAVLink").vehicle(id).msgid(msg.msgid) << "received";
+//   LOG_WARN_EVERY_MS(1000, "Radio").vehicle(id) << "Low RSSI: " << rssi;
+//
+// Levels below XGCS_LOG_LEVEL are compiled out entirely.
+
+#define XGCS_LOG_LEVEL_TRACE 0
+#define XGCS_LOG_LEVEL_DEBUG 1
+#define XGCS_LOG_LEVEL_INFO  2
+#define XGCS_LOG_LEVEL_WARN  3
+#define XGCS_LOG_LEVEL_ERROR 4
+#define XGCS_LOG_LEVEL_FATAL 5
+
+#ifndef XGCS_LOG_LEVEL
+#define XGCS_LOG_LEVEL XGCS_LOG_LEVEL_INFO
+#endif
+
+enum class LogLevel : uint8_t {
+    Trace = XGCS_LOG_LEVEL_TRACE,
+    Debug = XGCS_LOG_LEVEL_DEBUG,
+    Info = XGCS_LOG_LEVEL_INFO,
+    Warn = XGCS_LOG_LEVEL_WARN,
+    Error = XGCS_LOG_LEVEL_ERROR,
+    Fatal = XGCS_LOG_LEVEL_FATAL
+};
+
+struct LogRecord {
+    static constexpr std::size_t kTagSize = 16;
+    static constexpr std::size_t kVehicleSize = 32;
+    static constexpr std::size_t kTextSize = 320;
+
+    int64_t timestamp_us = 0;  // system_clock, microseconds since epoch
+    int64_t msgid = -1;        // -1 when not set
+    uint32_t suppressed = 0;   // Records dropped by the call site's rate limit since the last one
+    LogLevel level = LogLevel::Info;
+    uint16_t text_len = 0;
+    char tag[kTagSize] = {};
+    char vehicle[kVehicleSize] = {};
+    char text[kTextSize];
+};
+
+class Logger {
+public:
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Never blocks. Returns false (and counts a drop) if the ring is full.
+    bool push(const LogRecord& record);
+
+    // Drains everything queued so far and stops the writer thread.
+    void shutdown();
+
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t kCapacity = 4096; // Power of two
+
+    Logger();
+    ~Logger();
+
+    void run();
+    bool pop(LogRecord& out);
+    void write(const LogRecord& record, std::string& out) const;
+
+    // Bounded MPMC ring (Vyukov); only the writer thread consumes.
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+    std::unique_ptr<Slot[]> _slots;
+    alignas(64) std::atomic<std::size_t> _enqueue_pos{0};
+    alignas(64) std::atomic<std::size_t> _dequeue_pos{0};
+    alignas(64) std::atomic<uint64_t> _dropped{0};
+
+    std::mutex _wake_mutex;
+    std::condition_variable _wake_cv;
+    std::atomic<bool> _running{true};
+    std::thread _writer;
+};
+
+// Per-call-site rate limiter; one static instance per LOG_*_EVERY_MS site.
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(int64_t interval_ms) : _interval_us(interval_ms * 1000) {}
+
+    // True if this call may log; otherwise counts it as suppressed.
+    bool allow(uint32_t& suppressed) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = _last_us.load(std::memory_order_relaxed);
+        if (last != 0 && now - last < _interval_us) {
+            _suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!_last_us.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            _suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    const int64_t _interval_us;
+    std::atomic<int64_t> _last_us{0};
+    std::atomic<uint32_t> _suppressed{0};
+};
+
+// One log statement. Formats into its own record and hands it to the
+// Logger when the full expression ends. Text beyond kTextSize is truncated.
+class LogLine {
+public:
+    LogLine(LogLevel level, const char* tag, uint32_t suppressed = 0) {
+        _record.level = level;
+        _record.suppressed = suppressed;
+        _record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        copy_field(_record.tag, sizeof(_record.tag), tag);
+    }
+
+    ~LogLine() { Logger::instance().push(_record); }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    // Structured fields
+    LogLine& vehicle(std::string_view id) {
+        copy_field(_record.vehicle, sizeof(_record.vehicle), id);
+        return *this;
+    }
+    LogLine& msgid(int64_t id) {
+        _record.msgid = id;
+        return *this;
+    }
+
+    LogLine& operator<<(std::string_view text) {
+        append(text.data(), text.size());
+        return *this;
+    }
+    LogLine& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    LogLine& operator<<(const char* text) { return *this << std::string_view(text ? text : "(null)"); }
+    LogLine& operator<<(char c) {
+        append(&c, 1);
+        return *this;
+    }
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    LogLine& operator<<(T value) {
+        char buf[32];
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point_v<T>) {
+            result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+        } else if constexpr (sizeof(T) == 1) {
+            result = std::to_chars(buf, buf + sizeof(buf), static_cast<int>(value));
+        } else {
+            result = std::to_chars(buf, buf + sizeof(buf), value);
+        }
+        if (result.ec == std::errc()) append(buf, static_cast<std::size_t>(result.ptr - buf));
+        return *this;
+    }
+
+    template <typename E, std::enable_if_t<std::is_enum_v<E>, int> = 0>
+    LogLine& operator<<(E value) {
+        return *this << static_cast<std::underlying_type_t<E>>(value);
+    }
+
+private:
+    void append(const char* data, std::size_t size) {
+        const std::size_t room = LogRecord::kTextSize - _record.text_len;
+        if (size > room) size = room;
+        std::memcpy(_record.text + _record.text_len, data, size);
+        _record.text_len = static_cast<uint16_t>(_record.text_len + size);
+    }
+
+    static void copy_field(char* dst, std::size_t capacity, std::string_view src) {
+        const std::size_t n = src.size() < capacity - 1 ? src.size() : capacity - 1;
+        std::memcpy(dst, src.data(), n);
+        dst[n] = '\0';
+    }
+
+    LogRecord _record;
+};
+
+// `if/else` form so that the streamed arguments are not evaluated when the
+// level is compiled out or the rate limit suppresses the line.
+#define XGCS_LOG_AT(lvl, tag) \
+    if ((lvl) < XGCS_LOG_LEVEL) {} else LogLine(static_cast<LogLevel>(lvl), tag)
+
+#define XGCS_LOG_EVERY_MS(lvl, interval_ms, tag) \
+    if (uint32_t xgcs_suppressed_ = 0; (lvl) < XGCS_LOG_LEVEL || \
+        ![]() -> LogRateLimiter& { static LogRateLimiter limiter(interval_ms); return limiter; }().allow(xgcs_suppressed_)) {} \
+    else LogLine(static_cast<LogLevel>(lvl), tag, xgcs_suppressed_)
+
+#define LOG_TRACE(tag) XGCS_LOG_AT(XGCS_LOG_LEVEL_TRACE, tag)
+#define LOG_DEBUG(tag) XGCS_LOG_AT(XGCS_LOG_LEVEL_DEBUG, tag)
+#define LOG_INFO(tag)  XGCS_LOG_AT(XGCS_LOG_LEVEL_INFO, tag)
+#define LOG_WARN(tag)  XGCS_LOG_AT(XGCS_LOG_LEVEL_WARN, tag)
+#define LOG_ERROR(tag) XGCS_LOG_AT(XGCS_LOG_LEVEL_ERROR, tag)
+#define LOG_FATAL(tag) XGCS_LOG_AT(XGCS_LOG_LEVEL_FATAL, tag)
+
+#define LOG_DEBUG_EVERY_MS(interval_ms, tag) XGCS_LOG_EVERY_MS(XGCS_LOG_LEVEL_DEBUG, interval_ms, tag)
+#define LOG_INFO_EVERY_MS(interval_ms, tag)  XGCS_LOG_EVERY_MS(XGCS_LOG_LEVEL_INFO, interval_ms, tag)
+#define LOG_WARN_EVERY_MS(interval_ms, tag)  XGCS_LOG_EVERY_MS(XGCS_LOG_LEVEL_WARN, interval_ms, tag)
+#define LOG_ERROR_EVERY_MS(interval_ms, tag) XGCS_LOG_EVERY_MS(XGCS_LOG_LEVEL_ERROR, interval_ms, tag)
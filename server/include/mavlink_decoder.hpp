@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mavsdk/mavlink/common/mavlink.h>
+#include <nlohmann/json.hpp>
+#include "json_writer.hpp"
+#include "msgid_table.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+// Decodes any MAVLink message of the compiled dialect using the generated
+// field metadata (MAVLINK_MESSAGE_INFO) instead of per-message switch cases.
+//
+// Lookups by msgid are constant time through a MsgIdTable, and message
+// names are static string_views into the metadata, so nothing is allocated
+// to resolve a name. Shared by the live inspector stream and TLog session
+// parsing.
+class MavlinkDecoder {
+public:
+    static const MavlinkDecoder& instance();
+
+    MavlinkDecoder(const MavlinkDecoder&) = delete;
+    MavlinkDecoder& operator=(const MavlinkDecoder&) = delete;
+
+    // nullptr / empty when the dialect does not define msgid
+    const mavlink_message_info_t* info(uint32_t msgid) const;
+    std::string_view name(uint32_t msgid) const;
+    bool known(uint32_t msgid) const { return info(msgid) != nullptr; }
+    // Reverse lookup by MAVLink name ("GLOBAL_POSITION_INT")
+    bool find_msgid(std::string_view name, uint32_t& msgid) const;
+
+    std::size_t message_count() const { return _count; }
+
+    // Every field keyed by its MAVLink name:
+    // - scalars become JSON numbers
+    // - char[] fields become strings, cut at the first NUL
+    // - other arrays become JSON arrays
+    // Bytes past message.len decode as zero. This covers MAVLink 2
+    // trailing-zero truncation and extension fields the sender omitted.
+    // Returns an empty object for unknown messages.
+    json decode(const mavlink_message_t& message) const;
+
+    // Same object as decode(message).dump(), written straight into `out` with
+    // no intermediate DOM. Fields go out in sorted name order, the same order
+    // nlohmann::json uses for object keys. Writes {} for unknown messages.
+    void write_fields(const mavlink_message_t& message, JsonWriter& out) const;
+
+    // Single field value, including the zero-fill rule above
+    static json decode_field(const mavlink_message_t& message, const mavlink_field_info_t& field);
+
+    // Wire size of one element of a field
+    static std::size_t type_size(mavlink_message_type_t type);
+
+private:
+    MavlinkDecoder();
+
+    struct Entry {
+        const mavlink_message_info_t* info = nullptr;
+        std::string_view name;
+        std::array<uint8_t, MAVLINK_MAX_FIELDS> sorted_fields{}; // Field indices by name
+    };
+
+    MsgIdTable<Entry> _by_id;
+    std::unordered_map<std::string_view, uint32_t> _by_name;
+    std::size_t _count = 0;
+};
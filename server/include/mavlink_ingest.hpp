@@ -0,0 +1,102 @@
+#pragma once
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/mavlink_passthrough/mavlink_passthrough.h>
+#include "msgid_table.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Per-vehicle MAVLink ingest pipeline.
+//
+// Every message received for a vehicle enters through ingest() and is
+// dispatched to registered stages (TLog recording, state tracking, streaming)
+// via a flat msgid -> stage bitmask table. Stages are plain function pointers
+// plus a context pointer, so a packet costs one MAVSDK callback and one table
+// lookup regardless of how many stages want it.
+//
+// MAVSDK in this version only offers per-id subscriptions, so attach() still
+// subscribes once per distinct msgid, but each subscription is a trampoline
+// into ingest() rather than a full handler.
+class MavlinkIngest {
+public:
+    using Handler = void (*)(void* context, const MavlinkIngest& source, const mavlink_message_t& message);
+    static constexpr std::size_t kMaxStages = 32;
+
+    // Ids captured for stages registered with add_stage_all(). Matches the
+    // range the TLog hook has always covered.
+    static constexpr uint16_t kAllMsgIdFirst = 0;
+    static constexpr uint16_t kAllMsgIdLast = 400;
+
+    explicit MavlinkIngest(std::string vehicle_id);
+    ~MavlinkIngest();
+
+    MavlinkIngest(const MavlinkIngest&) = delete;
+    MavlinkIngest& operator=(const MavlinkIngest&) = delete;
+
+    // Stages must be registered before attach(); the table is read without
+    // locking once messages are flowing. Returns the stage index or -1.
+    int add_stage(const char* name, Handler handler, void* context, std::initializer_list<uint32_t> msgids);
+    int add_stage(const char* name, Handler handler, void* context, const uint32_t* msgids, std::size_t count);
+    int add_stage_all(const char* name, Handler handler, void* context);
+
+    // Subscribes the ingest entry point on the vehicle's passthrough plugin.
+    // Calling it again on an attached pipeline is a no-op.
+    //
+    // `owner` is whatever owns this pipeline and the stage contexts. MAVSDK
+    // queues callbacks onto its own thread, so one can still run after
+    // detach(); each callback holds the owner while it dispatches and drops
+    // the message once the owner is gone.
+    void attach(const std::shared_ptr<mavsdk::MavlinkPassthrough>& passthrough, std::weak_ptr<void> owner);
+    void detach();
+    bool attached() const;
+
+    // Optional consumers (e.g. the WebSocket stream) are registered up front
+    // and toggled at runtime; a disabled stage costs one AND per packet.
+    void set_stage_enabled(int index, bool enabled);
+    bool stage_enabled(int index) const;
+    int find_stage(const char* name) const;
+
+    // Single entry point for every received message.
+    void ingest(const mavlink_message_t& message) const {
+        const uint32_t* keyed = _dispatch.find(message.msgid);
+        uint32_t mask = (_all_mask | (keyed ? *keyed : 0u)) & _enabled_mask.load(std::memory_order_relaxed);
+        while (mask) {
+            const int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            const Stage& stage = _stages[i];
+            stage.handler(stage.context, *this, message);
+        }
+    }
+
+    const std::string& vehicle_id() const { return _vehicle_id; }
+    std::size_t subscription_count() const;
+
+private:
+    struct Stage {
+        const char* name = nullptr;
+        Handler handler = nullptr;
+        void* context = nullptr;
+    };
+
+    int register_stage(const char* name, Handler handler, void* context);
+
+    std::string _vehicle_id;
+    std::array<Stage, kMaxStages> _stages{};
+    std::size_t _stage_count = 0;
+    uint32_t _all_mask = 0;
+    std::atomic<uint32_t> _enabled_mask{~0u};
+    MsgIdTable<uint32_t> _dispatch;
+
+    // attach()/detach() may run on different threads (connect, disconnect,
+    // destructor) while stats readers ask for the count
+    mutable std::mutex _handles_mutex;
+    std::weak_ptr<mavsdk::MavlinkPassthrough> _passthrough; // Guarded by _handles_mutex
+    std::vector<std::pair<uint16_t, mavsdk::MavlinkPassthrough::MessageHandle>> _handles; // Guarded by _handles_mutex
+};
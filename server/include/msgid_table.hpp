@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Sparse lookup table over the 24-bit MAVLink2 message id space.
+// Three 8-bit radix levels, allocated lazily on first write, so the common
+// dialects (ids 0-511, 11000+, 42000+) only pay for the pages they touch while
+// lookups stay at three dependent loads with no hashing or branching on size.
+template <typename T>
+class MsgIdTable {
+public:
+    static constexpr uint32_t kMaxMsgId = 0xFFFFFF;
+
+    // Returns nullptr when no page exists for msgid; otherwise the slot
+    // (which may still hold a default-constructed T).
+    const T* find(uint32_t msgid) const {
+        const Mid* mid = _top[(msgid >> 16) & 0xFF].get();
+        if (!mid) return nullptr;
+        const Leaf* leaf = (*mid)[(msgid >> 8) & 0xFF].get();
+        if (!leaf) return nullptr;
+        return &(*leaf)[msgid & 0xFF];
+    }
+
+    T* find(uint32_t msgid) {
+        return const_cast<T*>(static_cast<const MsgIdTable&>(*this).find(msgid));
+    }
+
+    // Returns the slot for msgid, allocating its page if needed.
+    T& operator[](uint32_t msgid) {
+        auto& mid = _top[(msgid >> 16) & 0xFF];
+        if (!mid) mid = std::make_unique<Mid>();
+        auto& leaf = (*mid)[(msgid >> 8) & 0xFF];
+        if (!leaf) leaf = std::make_unique<Leaf>();
+        return (*leaf)[msgid & 0xFF];
+    }
+
+    // Visits every slot of every allocated page as fn(msgid, const T&).
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (uint32_t hi = 0; hi < 256; ++hi) {
+            const Mid* mid = _top[hi].get();
+            if (!mid) continue;
+            for (uint32_t md = 0; md < 256; ++md) {
+                const Leaf* leaf = (*mid)[md].get();
+                if (!leaf) continue;
+                for (uint32_t lo = 0; lo < 256; ++lo) {
+                    fn((hi << 16) | (md << 8) | lo, (*leaf)[lo]);
+                }
+            }
+        }
+    }
+
+private:
+    using Leaf = std::array<T, 256>;
+    using Mid = std::array<std::unique_ptr<Leaf>, 256>;
+    std::array<std::unique_ptr<Mid>, 256> _top;
+};
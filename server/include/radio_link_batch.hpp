@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Default radio simulation update rate; override at configure time
+#ifndef XGCS_RADIO_SIM_HZ
+#define XGCS_RADIO_SIM_HZ 10
+#endif
+
+// Simulated radio links for a whole fleet, one array per field (structure of
+// arrays). compute() is a single branch-free pass over the arrays: great-
+// circle distance from home (haversine), free-space path loss, and the
+// resulting RSSI, so the compiler can vectorize it and a tick over
+// thousands of links stays in the microseconds.
+//
+// Not thread-safe; the radio simulation thread owns its batch and reuses it
+// every tick.
+class RadioLinkBatch {
+public:
+    void clear();
+    void reserve(std::size_t links);
+    std::size_t size() const { return _lat_rad.size(); }
+
+    // One link. gain_db is transmit power plus both antenna gains (dBm).
+    void add(double lat_deg, double lon_deg, double home_lat_deg, double home_lon_deg,
+             double frequency_mhz, double gain_db);
+
+    // Fills distance_m() and rssi_dbm() for every link
+    void compute();
+
+    const std::vector<double>& distance_m() const { return _distance_m; }
+    // Clamped to [-120, 0] dBm
+    const std::vector<double>& rssi_dbm() const { return _rssi_dbm; }
+
+private:
+    // Inputs
+    std::vector<double> _lat_rad;
+    std::vector<double> _lon_rad;
+    std::vector<double> _home_lat_rad;
+    std::vector<double> _home_lon_rad;
+    std::vector<double> _budget_db; // gain_db - 20*log10(frequency_mhz) - 32.44, constant per link
+
+    // Outputs
+    std::vector<double> _distance_m;
+    std::vector<double> _rssi_dbm;
+};
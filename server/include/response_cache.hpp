@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Default fleet response cache tick; override at configure time
+#ifndef XGCS_FLEET_CACHE_TICK_MS
+#define XGCS_FLEET_CACHE_TICK_MS 50
+#endif
+
+// One pre-serialized HTTP response body, rebuilt at most once per tick.
+//
+// Every request within a tick gets the same immutable body and ETag, so N
+// pollers cost one build. The ETag is a strong validator derived from the
+// body bytes: a rebuild that produces identical output keeps its ETag, and
+// clients revalidating with If-None-Match get 304 until something changes.
+// A body that carries a value changing on every build (a timestamp) can
+// name what its ETag is derived from instead; see Built.
+class TickedResponseCache {
+public:
+    struct Response {
+        std::shared_ptr<const std::string> body;
+        std::string etag; // Quoted, ready for the ETag header
+    };
+
+    // What build() returns when the body alone would change the ETag every
+    // tick: `validator` holds the content that matters (e.g. the body with
+    // its timestamps left out). The ETag is then weak, derived from the
+    // validator, and kept while the validator is unchanged.
+    struct Built {
+        std::string body;
+        std::string validator;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;         // Served from the current tick's body
+        uint64_t misses = 0;       // Rebuilt
+        uint64_t not_modified = 0; // Of all requests, answered 304
+    };
+
+    explicit TickedResponseCache(std::chrono::milliseconds tick) : _tick(tick) {}
+
+    TickedResponseCache(const TickedResponseCache&) = delete;
+    TickedResponseCache& operator=(const TickedResponseCache&) = delete;
+
+    // Returns this tick's response, calling `build()` (-> std::string or
+    // Built) when the tick has expired. Concurrent callers on an expired tick wait for
+    // the one rebuild. Exceptions from build() propagate and nothing is cached.
+    template <typename Build>
+    Response get(Build&& build) {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_current.body && now < _expires) {
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            return _current;
+        }
+        std::shared_ptr<const std::string> body;
+        if constexpr (std::is_same_v<std::decay_t<decltype(build())>, Built>) {
+            Built built = build();
+            body = std::make_shared<const std::string>(std::move(built.body));
+            if (!_current.body || _validator != built.validator) {
+                _current.etag = "W/" + make_etag(built.validator);
+                _validator = std::move(built.validator);
+            }
+        } else {
+            body = std::make_shared<const std::string>(build());
+            if (!_current.body || *_current.body != *body) {
+                _current.etag = make_etag(*body);
+            }
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        _current.body = std::move(body);
+        _expires = now + _tick;
+        return _current;
+    }
+
+    // Whether an If-None-Match header value matches `etag` (counts a 304)
+    bool not_modified(std::string_view if_none_match, const std::string& etag) {
+        if (!etag_matches(if_none_match, etag)) return false;
+        _not_modified.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.hits = _hits.load(std::memory_order_relaxed);
+        stats.misses = _misses.load(std::memory_order_relaxed);
+        stats.not_modified = _not_modified.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::chrono::milliseconds tick() const { return _tick; }
+
+    // If-None-Match is "*" or a comma-separated list of entity tags; it
+    // uses weak comparison, so a W/ prefix is ignored on either side
+    static bool etag_matches(std::string_view header, std::string_view etag) {
+        if (etag.substr(0, 2) == "W/") etag.remove_prefix(2);
+        while (!header.empty()) {
+            const std::size_t comma = header.find(',');
+            std::string_view tag = header.substr(0, comma);
+            header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+            while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+            while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+            if (tag == "*") return true;
+            if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+            if (tag == etag) return true;
+        }
+        return false;
+    }
+
+private:
+    // 64-bit FNV-1a of the body plus its length, as a quoted hex tag
+    static std::string make_etag(const std::string& body) {
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : body) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        char tag[40];
+        std::snprintf(tag, sizeof(tag), "\"%016llx-%zx\"", static_cast<unsigned long long>(hash), body.size());
+        return tag;
+    }
+
+    const std::chrono::milliseconds _tick;
+    std::mutex _mutex;
+    Response _current; // Guarded by _mutex
+    std::string _validator; // Of _current, for Built bodies; guarded by _mutex
+    std::chrono::steady_clock::time_point _expires; // Guarded by _mutex
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _not_modified{0};
+};
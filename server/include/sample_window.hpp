@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+// The most recent N samples of a metric, for percentile reporting.
+// Adding is O(1) and allocation-free; percentiles() copies and sorts the
+// window, so it belongs on stats endpoints, not hot paths. Not thread-safe.
+template <typename T, std::size_t N>
+class SampleWindow {
+public:
+    void add(T sample) {
+        _samples[_next] = sample;
+        _next = (_next + 1) % N;
+        if (_size < N) ++_size;
+        ++_total;
+    }
+
+    std::size_t size() const { return _size; }
+    uint64_t total() const { return _total; }
+
+    // Nearest-rank percentiles, one per entry of `ranks` (0-100), plus the
+    // window maximum as the last element. All zero when empty.
+    std::vector<T> percentiles(std::initializer_list<double> ranks) const {
+        std::vector<T> result(ranks.size() + 1, T{});
+        if (_size == 0) return result;
+        std::vector<T> sorted(_samples.begin(), _samples.begin() + _size);
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t i = 0;
+        for (double rank : ranks) {
+            const auto index = static_cast<std::size_t>(rank / 100.0 * static_cast<double>(_size - 1) + 0.5);
+            result[i++] = sorted[std::min(index, _size - 1)];
+        }
+        result[i] = sorted.back();
+        return result;
+    }
+
+private:
+    std::array<T, N> _samples{};
+    std::size_t _next = 0;
+    std::size_t _size = 0;
+    uint64_t _total = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+// A value published by writers and read without locks.
+//
+// Readers copy the value and retry if a write overlapped the copy (version
+// odd, or changed between the two loads), so they never block a writer and
+// always see one complete publication. Writers are serialized by a private
+// mutex that readers never touch; each update edits a writer-side copy and
+// publishes the whole value, so concurrent updates of different fields do
+// not lose each other.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock copies its value bytewise");
+
+public:
+    Seqlock() = default;
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Consistent copy of the latest publication
+    T load() const {
+        T out;
+        for (;;) {
+            const uint64_t before = _version.load(std::memory_order_acquire);
+            if (before & 1u) continue; // Write in progress
+            std::memcpy(&out, &_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_version.load(std::memory_order_relaxed) == before) return out;
+        }
+    }
+
+    // Applies `fn(T&)` to the current value and publishes the result
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(_write_mutex);
+        fn(_staging);
+        const uint64_t version = _version.load(std::memory_order_relaxed);
+        _version.store(version + 1, std::memory_order_relaxed); // Writing
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&_value, &_staging, sizeof(T));
+        _version.store(version + 2, std::memory_order_release);
+    }
+
+    // Publications so far
+    uint64_t version() const { return _version.load(std::memory_order_acquire) / 2; }
+
+private:
+    alignas(64) std::atomic<uint64_t> _version{0};
+    T _value{};
+    std::mutex _write_mutex;
+    T _staging{}; // Guarded by _write_mutex
+};
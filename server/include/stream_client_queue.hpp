@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// What a stream client's outgoing queue does once it passes its high watermark
+enum class StreamOverflowPolicy : uint8_t {
+    DropOldest,     // Discard the oldest frames down to the low watermark
+    CoalesceLatest, // Keep only the newest frame per msgid, then drop oldest if still over
+    Disconnect      // Give up on the client
+};
+
+// Bounded outgoing queue for one stream WebSocket client.
+//
+// The fan-out stage pushes shared, already-encoded frames; the writer takes
+// everything queued in one swap and sends it outside the lock. Both sides
+// only ever hold this queue's own mutex, and only briefly, so a client whose
+// writes fall behind costs its own memory (bounded by the watermarks) rather
+// than anyone else's latency.
+//
+// Watermarks are in payload bytes. Past `high_bytes` the policy runs until
+// the queue is back under `low_bytes`, so a client hovering at the limit is
+// not trimmed on every push.
+class StreamClientQueue {
+public:
+    struct Item {
+        std::shared_ptr<const std::string> payload;
+        uint32_t msgid = 0;
+        bool binary = false;
+        int64_t queued_us = 0; // steady_clock, for latency reporting
+    };
+
+    struct Stats {
+        std::size_t depth = 0;       // Frames waiting
+        std::size_t bytes = 0;       // Payload bytes waiting
+        std::size_t peak_bytes = 0;  // High-water mark seen so far
+        uint64_t sent = 0;           // Frames handed to the writer
+        uint64_t dropped = 0;        // Frames discarded by the policy
+        uint64_t coalesced = 0;      // Of those, replaced by a newer frame of the same msgid
+        bool overflowed = false;     // Disconnect policy tripped
+        int64_t oldest_queued_us = 0; // Front frame's queued_us, 0 when empty
+    };
+
+    // flush_bytes > 0 makes push() report when the backlog reaches that size
+    // (micro-batching clients flush early on it)
+    StreamClientQueue(std::size_t high_bytes, std::size_t low_bytes, StreamOverflowPolicy policy,
+                      std::size_t flush_bytes = 0)
+        : _high_bytes(high_bytes), _low_bytes(low_bytes < high_bytes ? low_bytes : high_bytes), _policy(policy),
+          _flush_bytes(flush_bytes) {}
+
+    enum class PushResult { Queued, QueuedFirst, QueuedFlush, Overflow };
+
+    // QueuedFirst: the queue was empty, so the writer needs a wakeup.
+    // QueuedFlush: the backlog just reached flush_bytes.
+    // Overflow: Disconnect policy tripped; the frame was not queued and the
+    // caller should close the connection. Later pushes keep returning it.
+    PushResult push(Item item) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stats.overflowed) return PushResult::Overflow;
+
+        const bool was_empty = _items.empty();
+        const std::size_t bytes_before = _bytes;
+        _bytes += size_of(item);
+        _items.push_back(std::move(item));
+        if (_bytes > _high_bytes) {
+            if (_policy == StreamOverflowPolicy::Disconnect) {
+                _stats.overflowed = true;
+                _stats.dropped += _items.size();
+                _items.clear();
+                _bytes = 0;
+                return PushResult::Overflow;
+            }
+            if (_policy == StreamOverflowPolicy::CoalesceLatest) coalesce();
+            while (_bytes > _low_bytes && _items.size() > 1) {
+                _bytes -= size_of(_items.front());
+                _items.pop_front();
+                ++_stats.dropped;
+            }
+        }
+        if (_bytes > _stats.peak_bytes) _stats.peak_bytes = _bytes;
+        if (was_empty) return PushResult::QueuedFirst;
+        if (_flush_bytes > 0 && bytes_before < _flush_bytes && _bytes >= _flush_bytes) return PushResult::QueuedFlush;
+        return PushResult::Queued;
+    }
+
+    // Moves everything queued into `out` (cleared first)
+    void take_all(std::vector<Item>& out) {
+        out.clear();
+        std::lock_guard<std::mutex> lock(_mutex);
+        out.reserve(_items.size());
+        for (auto& item : _items) out.push_back(std::move(item));
+        _stats.sent += _items.size();
+        _items.clear();
+        _bytes = 0;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats stats = _stats;
+        stats.depth = _items.size();
+        stats.bytes = _bytes;
+        stats.oldest_queued_us = _items.empty() ? 0 : _items.front().queued_us;
+        return stats;
+    }
+
+private:
+    static std::size_t size_of(const Item& item) { return item.payload ? item.payload->size() : 0; }
+
+    // Keeps the newest frame of each msgid, in queue order
+    void coalesce() {
+        _seen.clear();
+        std::deque<Item> kept;
+        for (auto it = _items.rbegin(); it != _items.rend(); ++it) {
+            if (_seen.insert(it->msgid).second) {
+                kept.push_front(std::move(*it));
+            } else {
+                _bytes -= size_of(*it);
+                ++_stats.dropped;
+                ++_stats.coalesced;
+            }
+        }
+        _items.swap(kept);
+    }
+
+    const std::size_t _high_bytes;
+    const std::size_t _low_bytes;
+    const StreamOverflowPolicy _policy;
+    const std::size_t _flush_bytes;
+
+    mutable std::mutex _mutex;
+    std::deque<Item> _items;
+    std::size_t _bytes = 0;
+    Stats _stats;
+    std::unordered_set<uint32_t> _seen; // Scratch for coalesce()
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Serialized inspector messages for one vehicle, keyed by the message's
+// sequence number in the vehicle's FrameRing and by wire format.
+//
+// Encoding happens on the consumer side, the first time any consumer asks
+// for a frame in a given format; every later consumer of the same frame and
+// format gets the same immutable bytes. The cache is direct-mapped with the
+// ring's capacity, so an entry is only evicted once the ring itself has
+// overwritten that frame.
+template <typename Frame, std::size_t Formats = 1>
+class StreamDecodeCache {
+public:
+    // Appends the frame's encoding to `out`
+    using Decoder = void (*)(const Frame& frame, std::string& out);
+
+    // Capacity must match the ring's (a power of two).
+    explicit StreamDecodeCache(std::size_t capacity) : _entries(capacity), _mask(capacity - 1) {}
+
+    StreamDecodeCache(const StreamDecodeCache&) = delete;
+    StreamDecodeCache& operator=(const StreamDecodeCache&) = delete;
+
+    // Returns the encoded frame, running `decode` only on a miss.
+    std::shared_ptr<const std::string> get(uint64_t sequence, const Frame& frame, std::size_t format, Decoder decode) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Entry& entry = _entries[sequence & _mask];
+        if (entry.sequence > sequence) {
+            // A late replay of a frame whose slot has moved on; don't evict the newer one
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            std::string encoded;
+            decode(frame, encoded);
+            return std::make_shared<const std::string>(std::move(encoded));
+        }
+        if (entry.sequence != sequence) {
+            // Slot now belongs to a newer frame
+            entry.sequence = sequence;
+            entry.values.fill(nullptr);
+        }
+        auto& value = entry.values[format];
+        if (value) {
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        // Encode into a reused buffer; the only allocation is the cached copy
+        _scratch.clear();
+        decode(frame, _scratch);
+        value = std::make_shared<const std::string>(_scratch);
+        return value;
+    }
+
+    uint64_t hits() const { return _hits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return _misses.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t sequence = 0;
+        std::array<std::shared_ptr<const std::string>, Formats> values;
+    };
+
+    std::mutex _mutex;
+    std::string _scratch; // Guarded by _mutex
+    std::vector<Entry> _entries;
+    const std::size_t _mask;
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+// Default stream compression settings; override at configure time
+#ifndef XGCS_STREAM_DEFLATE_LEVEL
+#define XGCS_STREAM_DEFLATE_LEVEL 6
+#endif
+#ifndef XGCS_STREAM_DEFLATE_THRESHOLD
+#define XGCS_STREAM_DEFLATE_THRESHOLD 256
+#endif
+
+// Per-client raw deflate for stream WebSocket frames.
+//
+// Every frame gets a one-byte header: 0 = stored as-is, 1 = raw deflate.
+// Frames below the size threshold are stored. With context takeover one
+// compressor runs for the whole connection, so later frames reuse the
+// dictionary of earlier ones (repeated keys compress to almost nothing);
+// each deflated frame ends in a sync flush and the client feeds them in
+// order into a single inflater. Without it every deflated frame is a
+// complete, independent deflate stream.
+//
+// Not thread-safe; one instance per connection, used by its writer.
+class StreamDeflater {
+public:
+    struct Result {
+        bool compressed = false;
+        uint64_t cpu_ns = 0; // Thread CPU time spent in zlib for this frame
+    };
+
+    StreamDeflater(int level, bool context_takeover, std::size_t threshold);
+    ~StreamDeflater();
+
+    StreamDeflater(const StreamDeflater&) = delete;
+    StreamDeflater& operator=(const StreamDeflater&) = delete;
+
+    // Appends the header byte and (possibly compressed) payload to `out`
+    Result encode(std::string_view payload, std::string& out);
+
+    int level() const { return _level; }
+    bool context_takeover() const { return _context_takeover; }
+    std::size_t threshold() const { return _threshold; }
+
+    static const char kStored = 0;
+    static const char kDeflated = 1;
+
+private:
+    z_stream _stream{};
+    bool _ready = false;
+    const int _level;
+    const bool _context_takeover;
+    const std::size_t _threshold;
+};
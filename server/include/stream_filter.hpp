@@ -0,0 +1,99 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include "msgid_table.hpp"
+#include "vehicle_context.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Per-client selection and rate limiting for the MAVLink inspector stream.
+//
+// Decisions are made per frame before anything is serialized, so messages a
+// client filtered out never get decoded for it. A client starts out receiving
+// everything:
+// - subscribe narrows the stream to the listed messages (adds to the list
+//   once narrowed); subscribe_all() goes back to everything
+// - unsubscribe removes messages in either mode
+// - a per-msgid rate cap holds back frames that come too fast and keeps only
+//   the latest one, which goes out once the interval has elapsed
+// - pause drops everything (including held frames) until resume
+//
+// Not thread-safe; the owner serializes access.
+class StreamFilter {
+public:
+    enum class Verdict { Drop, Send, Hold };
+
+    void subscribe_all();
+    // One subscribe request; narrowing keeps held frames of every listed id
+    void subscribe(const std::vector<uint32_t>& msgids);
+    void subscribe(uint32_t msgid) { subscribe(std::vector<uint32_t>{msgid}); }
+    void unsubscribe(uint32_t msgid);
+    // hz <= 0 removes the cap
+    void set_rate(uint32_t msgid, double hz);
+    void pause();
+    void resume() { _paused = false; }
+    bool paused() const { return _paused; }
+
+    // Applies one control message from the client:
+    //   {"op": "subscribe" | "unsubscribe", "messages": ["ATTITUDE", 33, ...] | "*"}
+    //   {"op": "rate", "messages": [...], "hz": 2}
+    //   {"op": "pause" | "resume"}
+    // Messages are MAVLink names or numeric ids. Returns false and leaves the
+    // filter unchanged on malformed input.
+    bool apply(const json& command, std::string& error);
+
+    // Decides what to do with the next frame of the stream. Hold means the
+    // filter kept a copy and take_due() will hand it back later.
+    Verdict offer(const StreamMessage& message, int64_t now_us);
+
+    // Held frames whose interval has elapsed, in stream order, as fn(message)
+    template <typename Fn>
+    void take_due(int64_t now_us, Fn&& fn) {
+        if (_held.empty()) return;
+        _due.clear();
+        for (std::size_t i = 0; i < _held.size();) {
+            Slot* slot = _slots.find(_held[i].frame.message.msgid);
+            if (now_us - slot->last_sent_us >= slot->interval_us) {
+                slot->last_sent_us = now_us;
+                _due.push_back(_held[i]);
+                release(i);
+            } else {
+                ++i;
+            }
+        }
+        std::sort(_due.begin(), _due.end(), [](const StreamMessage& a, const StreamMessage& b) {
+            return a.sequence < b.sequence;
+        });
+        for (const auto& message : _due) fn(message);
+    }
+
+    bool has_held() const { return !_held.empty(); }
+    // When the earliest held frame falls due; max() when nothing is held
+    int64_t next_due_us() const;
+
+private:
+    struct Slot {
+        bool configured = false;
+        bool included = false;     // Listed by subscribe (narrowed mode)
+        bool excluded = false;     // Listed by unsubscribe
+        int64_t interval_us = 0;   // 0: no rate cap
+        int64_t last_sent_us = std::numeric_limits<int64_t>::min() / 2;
+        int32_t held = -1;         // Index into _held
+    };
+
+    Slot& slot(uint32_t msgid);
+    void release(std::size_t held_index);
+    void drop_held(uint32_t msgid);
+
+    MsgIdTable<Slot> _slots;
+    std::vector<uint32_t> _configured; // Ids with a Slot, for mode resets
+    std::vector<StreamMessage> _held;  // Latest frame per rate-capped id
+    std::vector<StreamMessage> _due;   // Scratch for take_due()
+    bool _narrowed = false;
+    bool _paused = false;
+};
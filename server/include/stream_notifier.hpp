@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Wakes stream senders when new inspector frames arrive.
+//
+// notify() is called from MAVSDK receive threads for every streamed frame.
+// It bumps an epoch counter and only touches the mutex when a sender is
+// actually parked, so while senders are busy it is a single atomic add.
+// Waiters pass the epoch they last saw and return as soon as it moves, on
+// stop(), or after the timeout.
+class StreamNotifier {
+public:
+    void notify() {
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_seq_cst) > 0) {
+            // Pairs with the predicate check under _mutex in wait()
+            { std::lock_guard<std::mutex> lock(_mutex); }
+            _cv.notify_all();
+        }
+    }
+
+    // Returns the epoch to pass to the next call. `seen` starts at epoch().
+    uint64_t wait(uint64_t seen, std::chrono::milliseconds timeout) {
+        uint64_t current = _epoch.load(std::memory_order_seq_cst);
+        if (current != seen || _stopped.load(std::memory_order_acquire)) return current;
+
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait_for(lock, timeout, [&] {
+                return _epoch.load(std::memory_order_seq_cst) != seen || _stopped.load(std::memory_order_acquire);
+            });
+        }
+        _waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return _epoch.load(std::memory_order_seq_cst);
+    }
+
+    // Releases every waiter for good (shutdown)
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopped.store(true, std::memory_order_release);
+        }
+        _cv.notify_all();
+    }
+
+    bool stopped() const { return _stopped.load(std::memory_order_acquire); }
+    uint64_t epoch() const { return _epoch.load(std::memory_order_seq_cst); }
+
+private:
+    std::atomic<uint64_t> _epoch{0};
+    std::atomic<int> _waiters{0};
+    std::atomic<bool> _stopped{false};
+    std::mutex _mutex;
+    std::condition_variable _cv;
+};
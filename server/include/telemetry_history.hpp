@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Default per-vehicle history budget and row interval; override at configure time
+#ifndef XGCS_HISTORY_BUDGET_BYTES
+#define XGCS_HISTORY_BUDGET_BYTES 1048576
+#endif
+#ifndef XGCS_HISTORY_INTERVAL_MS
+#define XGCS_HISTORY_INTERVAL_MS 200
+#endif
+
+// Values kept in a vehicle's telemetry history. Lat and Lng come first: they
+// are stored as double (a float degree only resolves about a metre), the
+// rest as float.
+enum class HistoryChannel : uint8_t {
+    Lat = 0,     // deg
+    Lng,         // deg
+    Alt,         // m, relative to home
+    Heading,     // deg
+    Groundspeed, // m/s
+    Airspeed,    // m/s
+    Climb,       // m/s
+    Battery,     // % remaining
+    Voltage,     // V
+    Rssi,        // RADIO_STATUS units (or simulated dBm)
+    Count
+};
+constexpr std::size_t kHistoryChannelCount = static_cast<std::size_t>(HistoryChannel::Count);
+constexpr std::size_t kHistoryPreciseChannelCount = 2; // Lat, Lng
+
+// Recent telemetry of one vehicle as a columnar ring: one timestamp column
+// and one column per channel, sized once from a byte budget and overwritten
+// oldest first.
+//
+// The ingest stage records values as messages arrive; they are held as the
+// "current" row and appended at most once per interval, carrying forward
+// channels that did not change (never-seen channels read as NaN). Row times
+// never go backwards, so a range is found by binary search; a caller clock
+// that steps back is clamped to the last row's time. Readers copy a time
+// range under the lock and downsample outside it.
+class TelemetryHistory {
+public:
+    struct Value {
+        HistoryChannel channel;
+        double value;
+    };
+
+    // One channel over a time range, oldest first
+    struct Series {
+        std::vector<int64_t> time_ms;
+        std::vector<double> values;
+    };
+
+    static constexpr std::size_t kRowBytes = sizeof(int64_t) + kHistoryPreciseChannelCount * sizeof(double) +
+                                             (kHistoryChannelCount - kHistoryPreciseChannelCount) * sizeof(float);
+
+    TelemetryHistory(std::size_t budget_bytes = XGCS_HISTORY_BUDGET_BYTES,
+                     int64_t interval_ms = XGCS_HISTORY_INTERVAL_MS);
+
+    TelemetryHistory(const TelemetryHistory&) = delete;
+    TelemetryHistory& operator=(const TelemetryHistory&) = delete;
+
+    // Writer side. `now_ms` is epoch milliseconds, ideally from a monotonic
+    // source (see above).
+    void record(int64_t now_ms, std::initializer_list<Value> values);
+
+    // Samples of each channel with from_ms <= time <= to_ms; NaN (not yet
+    // seen) samples are left out. One Series per entry of `channels`.
+    std::vector<Series> range(const std::vector<HistoryChannel>& channels, int64_t from_ms, int64_t to_ms) const;
+
+    std::size_t capacity() const { return _capacity; }
+    std::size_t size() const;
+    int64_t interval_ms() const { return _interval_ms; }
+
+    static const char* channel_name(HistoryChannel channel);
+    static bool parse_channel(std::string_view name, HistoryChannel& channel);
+
+private:
+    void append(int64_t now_ms); // Under _mutex
+
+    const std::size_t _capacity; // Rows
+    const int64_t _interval_ms;
+
+    mutable std::mutex _mutex;
+    std::vector<int64_t> _time_ms;
+    std::array<std::vector<double>, kHistoryPreciseChannelCount> _precise; // Lat, Lng
+    std::array<std::vector<float>, kHistoryChannelCount> _columns;         // The rest (Lat/Lng unused)
+    std::size_t _next = 0; // Slot the next row goes to
+    std::size_t _size = 0;
+    std::array<double, kHistoryChannelCount> _current; // Latest value per channel
+    int64_t _last_append_ms = 0;
+};
+
+enum class HistoryDownsample : uint8_t { Lttb, MinMax };
+
+// Downsampling for chart queries; both return `in` unchanged when it already
+// has at most `max_points` samples.
+
+// Largest-Triangle-Three-Buckets: keeps the visually significant points
+// (max_points >= 3)
+TelemetryHistory::Series downsample_lttb(const TelemetryHistory::Series& in, std::size_t max_points);
+
+// Per bucket, the minimum and maximum sample in time order, so spikes
+// survive (max_points >= 2)
+TelemetryHistory::Series downsample_minmax(const TelemetryHistory::Series& in, std::size_t max_points);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mavsdk/plugins/telemetry/telemetry.h>
+#include "seqlock.hpp"
+#include <cstdint>
+#include <memory>
+
+// Radio link figures from RADIO_STATUS (or the radio simulation)
+struct RadioStatus {
+    int rssi = 0;
+    int remrssi = 0;
+    int noise = 0;
+    int remnoise = 0;
+    int txbuf = 0;
+    int rxerrors = 0;
+    int fixed = 0;
+};
+
+// Latest known state of one vehicle, as plain values. Kept current by
+// TelemetryFeed (MAVSDK telemetry) and the ingest state stage (radio), and
+// published through a Seqlock so HTTP handlers read a consistent copy
+// without locks or MAVSDK calls. Fields keep MAVSDK's defaults (NaN / 0)
+// until their first update.
+struct TelemetrySnapshot {
+    int64_t updated_us = 0; // system_clock, microseconds since epoch; 0 = never
+    mavsdk::Telemetry::Position position;
+    mavsdk::Telemetry::Position home;
+    mavsdk::Telemetry::EulerAngle attitude;
+    mavsdk::Telemetry::VelocityNed velocity;
+    mavsdk::Telemetry::Battery battery;
+    mavsdk::Telemetry::GpsInfo gps_info;
+    mavsdk::Telemetry::Health health;
+    mavsdk::Telemetry::FlightMode flight_mode = mavsdk::Telemetry::FlightMode::Unknown;
+    bool armed = false;
+    bool in_air = false;
+    RadioStatus radio;
+};
+
+using TelemetrySnapshotCell = Seqlock<TelemetrySnapshot>;
+
+// Subscribes to a vehicle's MAVSDK telemetry and publishes every update into
+// its snapshot. `owner` owns both the feed and the snapshot: as with
+// MavlinkIngest::attach(), MAVSDK can run an already queued callback after
+// detach(), so each callback holds the owner while it publishes and does
+// nothing once the owner is gone.
+class TelemetryFeed {
+public:
+    TelemetryFeed(std::shared_ptr<mavsdk::Telemetry> telemetry, TelemetrySnapshotCell& snapshot,
+                  std::weak_ptr<void> owner);
+    ~TelemetryFeed();
+
+    TelemetryFeed(const TelemetryFeed&) = delete;
+    TelemetryFeed& operator=(const TelemetryFeed&) = delete;
+
+    // Unsubscribes everything; safe to call more than once
+    void detach();
+
+private:
+    template <typename Fn>
+    void publish(Fn&& fn);
+
+    std::shared_ptr<mavsdk::Telemetry> _telemetry;
+    TelemetrySnapshotCell& _snapshot;
+    bool _attached = false;
+
+    mavsdk::Telemetry::PositionHandle _position;
+    mavsdk::Telemetry::HomeHandle _home;
+    mavsdk::Telemetry::AttitudeEulerHandle _attitude;
+    mavsdk::Telemetry::VelocityNedHandle _velocity;
+    mavsdk::Telemetry::BatteryHandle _battery;
+    mavsdk::Telemetry::GpsInfoHandle _gps_info;
+    mavsdk::Telemetry::HealthHandle _health;
+    mavsdk::Telemetry::FlightModeHandle _flight_mode;
+    mavsdk::Telemetry::ArmedHandle _armed;
+    mavsdk::Telemetry::InAirHandle _in_air;
+};
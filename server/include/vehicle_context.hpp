@@ -0,0 +1,156 @@
+#pragma once
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/mission_raw/mission_raw.h>
+#include <mavsdk/plugins/telemetry/telemetry.h>
+#include <mavsdk/plugins/mavlink_passthrough/mavlink_passthrough.h>
+#include <mavsdk/plugins/geofence/geofence.h>
+#include <nlohmann/json.hpp>
+#include "frame_ring.hpp"
+#include "link_stats.hpp"
+#include "mavlink_ingest.hpp"
+#include "stream_decode_cache.hpp"
+#include "stream_notifier.hpp"
+#include "telemetry_history.hpp"
+#include "telemetry_snapshot.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+struct RadioSimulationParams {
+    bool enabled = false;
+    double frequency_mhz = 915.0;
+    double tx_power_dbm = 30.0;
+    double tx_gain_dbi = 3.0;
+    double rx_gain_dbi = 3.0;
+    double noise_floor_dbm = -100.0;
+};
+
+struct CalibrationStatus {
+    bool active = false;
+    float progress = 0.0f;
+    std::string status_text;
+    bool success = false;
+    std::vector<float> compass_progress = {0, 0, 0};
+    std::vector<bool> compass_complete = {false, false, false};
+};
+
+// Default per-vehicle inspector ring size (records); override at configure
+// time with -DXGCS_STREAM_RING_CAPACITY=<n>.
+#ifndef XGCS_STREAM_RING_CAPACITY
+#define XGCS_STREAM_RING_CAPACITY 1024
+#endif
+
+// One received MAVLink frame as stored in the inspector ring
+struct StreamFrame {
+    int64_t receive_time_us = 0; // system_clock, microseconds since epoch
+    mavlink_message_t message;
+};
+
+// A StreamFrame with its position (sequence) in the vehicle's ring. The
+// sequence doubles as the stream's server sequence number: it increases by
+// one per streamed frame for the life of the vehicle connection.
+struct StreamMessage {
+    uint64_t sequence = 0;
+    StreamFrame frame;
+};
+
+// Wire encodings offered on the inspector stream
+enum class StreamFormat : uint8_t {
+    Json = 0,   // Text frame: JSON envelope (default)
+    MavlinkRaw, // Binary frame: uint64 little-endian receive time (us), then the MAVLink packet
+    Cbor,       // Binary frame: the JSON envelope encoded as CBOR
+    Count
+};
+constexpr std::size_t kStreamFormatCount = static_cast<std::size_t>(StreamFormat::Count);
+
+// Last HEARTBEAT fields, packed into one word so readers always see a
+// consistent type/mode pair without taking the vehicle lock.
+struct HeartbeatState {
+    bool seen = false;
+    uint8_t base_mode = 0;     // HEARTBEAT.base_mode
+    uint32_t custom_mode = 0;  // HEARTBEAT.custom_mode
+    uint8_t mav_type = 0;      // HEARTBEAT.type (MAV_TYPE_*)
+    uint8_t autopilot = 0;     // HEARTBEAT.autopilot (MAV_AUTOPILOT_*)
+
+    uint64_t pack() const {
+        return (seen ? (1ull << 63) : 0ull) |
+               (static_cast<uint64_t>(autopilot) << 48) |
+               (static_cast<uint64_t>(mav_type) << 40) |
+               (static_cast<uint64_t>(base_mode) << 32) |
+               custom_mode;
+    }
+
+    static HeartbeatState unpack(uint64_t word) {
+        HeartbeatState hb;
+        hb.seen = (word >> 63) & 1u;
+        hb.autopilot = static_cast<uint8_t>(word >> 48);
+        hb.mav_type = static_cast<uint8_t>(word >> 40);
+        hb.base_mode = static_cast<uint8_t>(word >> 32);
+        hb.custom_mode = static_cast<uint32_t>(word);
+        return hb;
+    }
+};
+
+// Everything ConnectionManager knows about one vehicle.
+//
+// Identity and plugin pointers are set before the context is published to
+// the registry and never change afterwards, so they are read without
+// locking. HEARTBEAT state is a single atomic word and telemetry a
+// seqlock-published snapshot. The rest is guarded by this vehicle's own
+// mutex; no operation on one vehicle blocks another.
+struct VehicleContext {
+    using Handle = uint32_t;
+    static constexpr Handle kInvalidHandle = UINT32_MAX;
+
+    VehicleContext(std::string vehicle_id, std::shared_ptr<mavsdk::System> sys,
+                   std::size_t stream_capacity = XGCS_STREAM_RING_CAPACITY)
+        : id(std::move(vehicle_id)), system(std::move(sys)),
+          stream_frames(stream_capacity), stream_cache(stream_frames.capacity()) {}
+
+    VehicleContext(const VehicleContext&) = delete;
+    VehicleContext& operator=(const VehicleContext&) = delete;
+
+    // Immutable once published
+    Handle handle = kInvalidHandle; // Dense index into the registry, assigned on insert
+    const std::string id;
+    const std::shared_ptr<mavsdk::System> system;
+    std::shared_ptr<mavsdk::Telemetry> telemetry;
+    std::shared_ptr<mavsdk::MissionRaw> mission_raw;
+    std::shared_ptr<mavsdk::Geofence> geofence;
+    std::shared_ptr<mavsdk::MavlinkPassthrough> passthrough;
+    std::unique_ptr<MavlinkIngest> ingest;
+    std::unique_ptr<TelemetryFeed> telemetry_feed; // Keeps `snapshot` current
+    StreamNotifier* stream_notifier = nullptr; // Owned by ConnectionManager; poked on every streamed frame
+
+    // Lock-free, or synchronized internally
+    std::atomic<uint64_t> heartbeat{0};
+    std::atomic<bool> radio_sim_enabled{false}; // Mirrors radio_sim.enabled for the ingest path
+    std::atomic<bool> streaming{false};         // stream_subscribers > 0; gates the sender wakeup
+    TelemetrySnapshotCell snapshot; // Latest telemetry and radio, read without locks
+    TelemetryHistory history;       // Recent telemetry for charts, filled by the ingest state stage
+    LinkStats link_stats;           // Per-msgid rate and bandwidth, filled by the ingest "link_stats" stage
+    FrameRing<StreamFrame> stream_frames; // Written only by the ingest "stream" stage
+    StreamDecodeCache<StreamMessage, kStreamFormatCount> stream_cache; // Encoded stream_frames, shared by all consumers
+
+    HeartbeatState last_heartbeat() const {
+        return HeartbeatState::unpack(heartbeat.load(std::memory_order_acquire));
+    }
+
+    // Guarded by mutex
+    mutable std::mutex mutex;
+    std::condition_variable ack_cv;
+    uint16_t last_ack_command = 0;     // MAV_CMD_*
+    uint8_t last_ack_result = 0;       // MAV_RESULT_*
+    RadioSimulationParams radio_sim;
+    std::optional<CalibrationStatus> calibration;
+    std::optional<FrameRing<StreamFrame>::Reader> stream_reader; // Inspector stream cursor, while streaming
+    int stream_subscribers = 0;        // Open start_mavlink_streaming() calls
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "vehicle_context.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Copy-on-write registry of connected vehicles.
+//
+// Readers grab an immutable snapshot with one atomic load and never block,
+// so per-request lookups and fleet-wide iteration do not serialize against
+// each other or against vehicles being added. Writers (connect/disconnect,
+// which are rare) copy the table under _write_mutex and publish the copy.
+//
+// Each vehicle gets a dense integer handle; freed handles are reused so
+// fleet-wide arrays indexed by handle stay compact.
+class VehicleRegistry {
+public:
+    using Handle = VehicleContext::Handle;
+
+    struct Table {
+        std::vector<std::shared_ptr<VehicleContext>> by_handle; // nullptr for free slots
+        std::unordered_map<std::string, Handle> by_id;
+    };
+
+    VehicleRegistry();
+
+    std::shared_ptr<const Table> snapshot() const {
+        return std::atomic_load_explicit(&_table, std::memory_order_acquire);
+    }
+
+    std::shared_ptr<VehicleContext> find(const std::string& vehicle_id) const;
+    std::shared_ptr<VehicleContext> get(Handle handle) const;
+
+    // Assigns the context's handle and publishes it. Replaces (and returns)
+    // any context already registered under the same id.
+    std::shared_ptr<VehicleContext> insert(const std::shared_ptr<VehicleContext>& context);
+    std::shared_ptr<VehicleContext> erase(const std::string& vehicle_id);
+
+    // Visits every live vehicle in handle order on a single snapshot.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        auto table = snapshot();
+        for (const auto& context : table->by_handle) {
+            if (context) fn(context);
+        }
+    }
+
+private:
+    void publish(std::shared_ptr<const Table> table) {
+        std::atomic_store_explicit(&_table, std::move(table), std::memory_order_release);
+    }
+
+    std::mutex _write_mutex;
+    std::shared_ptr<const Table> _table;
+};
@@ -1,5 +1,4 @@
 #include "connection_manager.hpp"
-#include <iostream>
 #include <future>
 #include <chrono>
 #include <atomic>
@@ -7,12 +6,28 @@
 #include "ardupilot_rally.hpp"
 #include <algorithm>
 #include "tlog_recorder.hpp"
+#include "mavlink_decoder.hpp"
+#include "logger.hpp"
 #include <thread>
+#include <iterator>
+#include <string_view>
+#include <cstring>
+#include <charconv>
 #include <cmath>
+#include <limits>
 
 std::string flight_mode_to_string(mavsdk::Telemetry::FlightMode mode);
 std::string ardupilot_custom_mode_to_string(uint8_t mav_type, uint32_t custom_mode);
 
+// Derive ArduPilot flight mode name from last HEARTBEAT custom_mode when possible (QGC style)
+static std::string vehicle_mode_string(const VehicleContext& vehicle, mavsdk::Telemetry::FlightMode flight_mode) {
+    HeartbeatState hb = vehicle.last_heartbeat();
+    if (hb.seen) {
+        return ardupilot_custom_mode_to_string(hb.mav_type, hb.custom_mode);
+    }
+    return flight_mode_to_string(flight_mode);
+}
+
 ConnectionManager::ConnectionManager() : _mavsdk(mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation}) {}
 
 ConnectionManager& ConnectionManager::instance() {
@@ -21,7 +36,7 @@ ConnectionManager& ConnectionManager::instance() {
 }
 
 bool ConnectionManager::add_vehicle(const std::string& vehicle_id, const std::string& connection_url) {
-    std::cout << "Adding vehicle: " << vehicle_id << " with URL: " << connection_url << std::endl;
+    LOG_INFO("Connection") << "Adding vehicle: " << vehicle_id << " with URL: " << connection_url;
     
     std::promise<std::shared_ptr<mavsdk::System>> prom;
     auto fut = prom.get_future();
@@ -38,28 +53,29 @@ bool ConnectionManager::add_vehicle(const std::string& vehicle_id, const std::st
 
     auto result = _mavsdk.add_any_connection(connection_url);
     if (result != mavsdk::ConnectionResult::Success) {
-        std::cerr << "Failed to add connection: " << connection_url << std::endl;
+        LOG_ERROR("Connection") << "Failed to add connection: " << connection_url;
         _mavsdk.unsubscribe_on_new_system(handle);
         return false;
     }
 
     if (fut.wait_for(std::chrono::seconds(10)) == std::future_status::timeout) {
-        std::cerr << "Timeout waiting for system discovery." << std::endl;
+        LOG_ERROR("Connection") << "Timeout waiting for system discovery.";
         return false;
     }
 
     auto system = fut.get();
-    std::lock_guard<std::mutex> lock(_mutex);
-    _systems[vehicle_id] = system;
-    _telemetry_plugins[vehicle_id] = std::make_shared<mavsdk::Telemetry>(system);
-    _mission_raw_plugins[vehicle_id] = std::make_shared<mavsdk::MissionRaw>(system); // INIT RAW PLUGIN
-    _geofence_plugins[vehicle_id] = std::make_shared<mavsdk::Geofence>(system);
-    _mavlink_passthrough_plugins[vehicle_id] = std::make_shared<mavsdk::MavlinkPassthrough>(system);
-    // _telemetry_plugins[vehicle_id]->set_rate_position(10.0); // Removed redundant setting?
+    auto vehicle = std::make_shared<VehicleContext>(vehicle_id, system);
+    vehicle->telemetry = std::make_shared<mavsdk::Telemetry>(system);
+    vehicle->telemetry_feed = std::make_unique<TelemetryFeed>(vehicle->telemetry, vehicle->snapshot, vehicle);
+    vehicle->mission_raw = std::make_shared<mavsdk::MissionRaw>(system); // INIT RAW PLUGIN
+    vehicle->geofence = std::make_shared<mavsdk::Geofence>(system);
+    vehicle->passthrough = std::make_shared<mavsdk::MavlinkPassthrough>(system);
+    vehicle->stream_notifier = &_stream_notifier;
+    // vehicle->telemetry->set_rate_position(10.0); // Removed redundant setting?
 
     // --- Jeremy: Request full telemetry streams like QGC ---
     // Send SET_MESSAGE_INTERVAL for all key telemetry messages at 5 Hz
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
+    auto passthrough = vehicle->passthrough;
     if (passthrough) {
         // ... (existing code for streaming) ...
         const int rate_hz = 5;
@@ -82,6 +98,7 @@ bool ConnectionManager::add_vehicle(const std::string& vehicle_id, const std::st
             cmd.param1 = static_cast<float>(msgid);
             cmd.param2 = static_cast<float>(interval_us);
             passthrough->send_command_long(cmd);
+            vehicle->link_stats.set_requested_interval(msgid, interval_us);
         }
         
         // ... (existing request_data_stream) ...
@@ -89,152 +106,235 @@ bool ConnectionManager::add_vehicle(const std::string& vehicle_id, const std::st
 
     TLogRecorder::instance().start_recording(vehicle_id);
 
-    std::cout << "Vehicle " << vehicle_id << " connected." << std::endl;
+    // Vehicle state (mode, ACKs, radio, calibration) is tracked from the
+    // moment the vehicle connects, whether or not a client is streaming.
+    setup_ingest_pipeline(vehicle);
+
+    // Publish; a reconnect under the same id replaces the old context
+    auto replaced = _registry.insert(vehicle);
+    if (replaced && replaced->ingest) {
+        replaced->ingest->detach();
+    }
+    if (replaced && replaced->telemetry_feed) {
+        replaced->telemetry_feed->detach();
+    }
+
+    LOG_INFO("Connection") << "Vehicle " << vehicle_id << " connected.";
     return true;
 }
 
 void ConnectionManager::remove_vehicle(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _systems.erase(vehicle_id);
-    _telemetry_plugins.erase(vehicle_id);
-    _mission_raw_plugins.erase(vehicle_id);
-    _geofence_plugins.erase(vehicle_id);
-    _mavlink_passthrough_plugins.erase(vehicle_id);
+    auto vehicle = _registry.erase(vehicle_id);
+    // Unsubscribe before the context (and the passthrough plugin it owns) goes away
+    if (vehicle && vehicle->ingest) {
+        vehicle->ingest->detach();
+    }
+    if (vehicle && vehicle->telemetry_feed) {
+        vehicle->telemetry_feed->detach();
+    }
     TLogRecorder::instance().stop_recording(vehicle_id);
-    std::cout << "Removed vehicle: " << vehicle_id << std::endl;
+    LOG_INFO("Connection") << "Removed vehicle: " << vehicle_id;
 }
 
 // ... unchanged functions ...
 bool ConnectionManager::is_vehicle_connected(const std::string& vehicle_id) const {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _systems.count(vehicle_id);
+    return _registry.find(vehicle_id) != nullptr;
 }
 
 std::vector<std::string> ConnectionManager::get_connected_vehicles() const {
-    std::lock_guard<std::mutex> lock(_mutex);
     std::vector<std::string> vehicles;
-    for (const auto& pair : _systems) {
-        vehicles.push_back(pair.first);
-    }
+    _registry.for_each([&vehicles](const std::shared_ptr<VehicleContext>& vehicle) {
+        vehicles.push_back(vehicle->id);
+    });
     return vehicles;
 }
 
-std::string ConnectionManager::get_telemetry_data_json(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_systems.count(vehicle_id)) {
+// Snapshot update time as reported to clients (epoch milliseconds)
+static int64_t snapshot_time_ms(const TelemetrySnapshot& snapshot) {
+    return snapshot.updated_us / 1000;
+}
+
+// What the telemetry documents below read from: one vehicle and one
+// consistent copy of its snapshot. Fields read the vehicle (mode string,
+// connection state) only when selected.
+struct TelemetryView {
+    const VehicleContext& vehicle;
+    const TelemetrySnapshot& snapshot;
+};
+
+static double ground_speed(const mavsdk::Telemetry::VelocityNed& velocity) {
+    return std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s);
+}
+
+using TelemetrySchema = FieldSchema<TelemetryView>;
+
+// /telemetry
+static const TelemetrySchema& telemetry_schema() {
+    static const TelemetrySchema schema({
+        {"armed", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.armed); }},
+        {"attitude.pitch", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.pitch_deg); }},
+        {"attitude.roll", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.roll_deg); }},
+        {"attitude.yaw", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.yaw_deg); }},
+        {"battery.remaining", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.remaining_percent); }},
+        {"battery.voltage", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.voltage_v); }},
+        {"connectionStatus", [](const TelemetryView& v, auto& w) { w.value(v.vehicle.system->is_connected() ? "connected" : "disconnected"); }},
+        {"flight_mode", [](const TelemetryView& v, auto& w) { w.value(vehicle_mode_string(v.vehicle, v.snapshot.flight_mode)); }},
+        {"gps.fix_type", [](const TelemetryView& v, auto& w) { w.value(static_cast<int>(v.snapshot.gps_info.fix_type)); }},
+        {"gps.satellites", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.gps_info.num_satellites); }},
+        // Simple air detection
+        {"in_air", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.armed && v.snapshot.position.relative_altitude_m > 1.0); }},
+        {"position.alt", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.relative_altitude_m); }},
+        {"position.lat", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.latitude_deg); }},
+        {"position.lng", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.longitude_deg); }},
+        // With radio simulation enabled, kept current by update_radio_simulation()
+        {"radio.fixed", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.fixed); }},
+        {"radio.noise", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.noise); }},
+        {"radio.remnoise", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.remnoise); }},
+        {"radio.remrssi", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.remrssi); }},
+        {"radio.rssi", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.rssi); }},
+        {"radio.rxerrors", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.rxerrors); }},
+        {"radio.txbuf", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.radio.txbuf); }},
+        {"success", [](const TelemetryView&, auto& w) { w.value(true); }, true},
+        {"timestamp", [](const TelemetryView& v, auto& w) { w.value(snapshot_time_ms(v.snapshot)); }, true},
+        {"velocity.airspeed", [](const TelemetryView& v, auto& w) { w.value(ground_speed(v.snapshot.velocity)); }},
+        {"velocity.groundspeed", [](const TelemetryView& v, auto& w) { w.value(ground_speed(v.snapshot.velocity)); }},
+        {"velocity.heading", [](const TelemetryView& v, auto& w) {
+            w.value(std::atan2(v.snapshot.velocity.east_m_s, v.snapshot.velocity.north_m_s) * 180.0 / M_PI);
+        }},
+    });
+    return schema;
+}
+
+// /api/vehicle/<id>/status
+static const TelemetrySchema& status_schema() {
+    static const TelemetrySchema schema({
+        {"armed", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.armed); }},
+        {"attitude.pitch", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.pitch_deg); }},
+        {"attitude.roll", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.roll_deg); }},
+        {"attitude.yaw", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.yaw_deg); }},
+        {"battery.current", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.current_battery_a); }},
+        {"battery.remaining", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.remaining_percent); }},
+        {"battery.voltage", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.voltage_v); }},
+        {"connected", [](const TelemetryView& v, auto& w) { w.value(v.vehicle.system->is_connected()); }},
+        {"flight_mode", [](const TelemetryView& v, auto& w) { w.value(vehicle_mode_string(v.vehicle, v.snapshot.flight_mode)); }},
+        {"gps.fix_type", [](const TelemetryView& v, auto& w) { w.value(static_cast<int>(v.snapshot.gps_info.fix_type)); }},
+        {"gps.satellites", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.gps_info.num_satellites); }},
+        {"health.is_accelerometer_calibration_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_accelerometer_calibration_ok); }},
+        {"health.is_global_position_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_global_position_ok); }},
+        {"health.is_gyrometer_calibration_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_gyrometer_calibration_ok); }},
+        {"health.is_home_position_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_home_position_ok); }},
+        {"health.is_local_position_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_local_position_ok); }},
+        {"health.is_magnetometer_calibration_ok", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.health.is_magnetometer_calibration_ok); }},
+        {"in_air", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.in_air); }},
+        {"position.alt_abs", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.absolute_altitude_m); }},
+        {"position.alt_rel", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.relative_altitude_m); }},
+        {"position.lat", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.latitude_deg); }},
+        {"position.lng", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.longitude_deg); }},
+        {"success", [](const TelemetryView&, auto& w) { w.value(true); }, true},
+        {"timestamp", [](const TelemetryView& v, auto& w) { w.value(snapshot_time_ms(v.snapshot)); }, true},
+        {"vehicle_id", [](const TelemetryView& v, auto& w) { w.value(v.vehicle.id); }, true},
+        {"velocity.down", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.velocity.down_m_s); }},
+        {"velocity.east", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.velocity.east_m_s); }},
+        {"velocity.groundspeed", [](const TelemetryView& v, auto& w) { w.value(ground_speed(v.snapshot.velocity)); }},
+        {"velocity.north", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.velocity.north_m_s); }},
+    });
+    return schema;
+}
+
+// One vehicle of /telemetry/all (only critical data for list view)
+static const TelemetrySchema& fleet_schema() {
+    static const TelemetrySchema schema({
+        {"alt", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.relative_altitude_m); }},
+        {"armed", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.armed); }},
+        {"battery_pct", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.battery.remaining_percent); }},
+        {"connected", [](const TelemetryView& v, auto& w) { w.value(v.vehicle.system->is_connected()); }},
+        {"flight_mode", [](const TelemetryView& v, auto& w) { w.value(vehicle_mode_string(v.vehicle, v.snapshot.flight_mode)); }},
+        {"gps_fix", [](const TelemetryView& v, auto& w) { w.value(static_cast<int>(v.snapshot.gps_info.fix_type)); }},
+        {"gps_sats", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.gps_info.num_satellites); }},
+        // minimal attitude for heading
+        {"heading", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.attitude.yaw_deg); }},
+        {"id", [](const TelemetryView& v, auto& w) { w.value(v.vehicle.id); }, true},
+        {"lat", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.latitude_deg); }},
+        {"lng", [](const TelemetryView& v, auto& w) { w.value(v.snapshot.position.longitude_deg); }},
+        {"timestamp", [](const TelemetryView& v, auto& w) { w.value(snapshot_time_ms(v.snapshot)); }, true},
+    });
+    return schema;
+}
+
+static const TelemetrySchema& telemetry_document_schema(ConnectionManager::TelemetryDocument document) {
+    switch (document) {
+        case ConnectionManager::TelemetryDocument::Status: return status_schema();
+        case ConnectionManager::TelemetryDocument::Fleet: return fleet_schema();
+        case ConnectionManager::TelemetryDocument::Telemetry: break;
+    }
+    return telemetry_schema();
+}
+
+std::shared_ptr<const FieldProjection> ConnectionManager::compile_fields(TelemetryDocument document, std::string_view fields,
+                                                                         std::string& error) {
+    return telemetry_document_schema(document).compile(fields, error);
+}
+
+const FieldProjection& ConnectionManager::all_fields(TelemetryDocument document) {
+    return telemetry_document_schema(document).all();
+}
+
+std::string ConnectionManager::get_telemetry_data_json(const std::string& vehicle_id, const FieldProjection* fields) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
         return json{
             {"success", false},
             {"error", "Vehicle not found"}
         }.dump();
     }
+    if (!vehicle->telemetry) {
+        return json{
+            {"success", false},
+            {"error", "Telemetry plugin not available"}
+        }.dump();
+    }
 
-    try {
-        auto telemetry = _telemetry_plugins.at(vehicle_id);
-        
-        // Check if telemetry data is available
-        if (!telemetry) {
-            return json{
-                {"success", false},
-                {"error", "Telemetry plugin not available"}
-            }.dump();
-        }
-
-        // Get position data
-        auto position = telemetry->position();
-        auto attitude = telemetry->attitude_euler();
-        auto battery = telemetry->battery();
-        auto flight_mode = telemetry->flight_mode();
-        auto armed = telemetry->armed();
-        auto velocity = telemetry->velocity_ned();
-        auto gps_info = telemetry->gps_info();
-        auto system = _systems.at(vehicle_id);
-        
-        // Get Radio Status
-        RadioStatus radio_stat;
-        {
-             auto it_radio = _radio_status.find(vehicle_id);
-             if (it_radio != _radio_status.end()) {
-                 radio_stat = it_radio->second;
-             }
-        }
-        
-        // --- Radio Simulation Hook ---
-        // If simulation enabled, override/inject synthetic values if real data is missing or stale?
-        // For simplicity, we update it here if enabled, overwriting any real data (as requested).
-        // Real implementation would be better served by a separate thread or timer, 
-        // but hooking into get_telemetry_data_json ensures we calculate it when requested.
-        // Actually, let's call update_radio_simulation() here to keep it fresh.
-        update_radio_simulation(vehicle_id);
-        
-        // Re-fetch after potential update
-        if (_radio_sim_params[vehicle_id].enabled) {
-             radio_stat = _radio_status[vehicle_id];
-        } 
-        // -----------------------------
-
-        bool connected = system->is_connected();
-
-        // Derive ArduPilot flight mode name from last HEARTBEAT custom_mode when possible (QGC style)
-        std::string mode_string = flight_mode_to_string(flight_mode);
-        auto it_type = _last_mav_type.find(vehicle_id);
-        auto it_cust = _last_custom_mode.find(vehicle_id);
-        if (it_type != _last_mav_type.end() && it_cust != _last_custom_mode.end()) {
-            uint8_t mav_type = it_type->second;
-            uint32_t cm = it_cust->second;
-            mode_string = ardupilot_custom_mode_to_string(mav_type, cm);
-        }
+    // One consistent copy; only the selected fields are read from it
+    const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+    const auto& schema = telemetry_schema();
+    std::string out;
+    out.reserve(fields ? 128 : 768);
+    JsonWriter writer(out);
+    schema.write({*vehicle, snapshot}, fields ? *fields : schema.all(), writer);
+    return out;
+}
 
-        json telemetry_json = {
-            {"success", true},
-            {"position", {
-                {"lat", position.latitude_deg},
-                {"lng", position.longitude_deg},
-                {"alt", position.relative_altitude_m}
-            }},
-            {"attitude", {
-                {"roll", attitude.roll_deg},
-                {"pitch", attitude.pitch_deg},
-                {"yaw", attitude.yaw_deg}
-            }},
-            {"battery", {
-                {"voltage", battery.voltage_v},
-                {"remaining", battery.remaining_percent}
-            }},
-            {"flight_mode", mode_string},
-            {"armed", armed},
-            {"in_air", armed && position.relative_altitude_m > 1.0}, // Simple air detection
-            {"velocity", {
-                {"airspeed", std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s)},
-                {"groundspeed", std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s)},
-                {"heading", std::atan2(velocity.east_m_s, velocity.north_m_s) * 180.0 / M_PI}
-            }},
-            {"gps", {
-                {"satellites", gps_info.num_satellites},
-                {"fix_type", static_cast<int>(gps_info.fix_type)}
-            }},
-            {"radio", {
-                {"rssi", radio_stat.rssi},
-                {"remrssi", radio_stat.remrssi},
-                {"noise", radio_stat.noise},
-                {"remnoise", radio_stat.remnoise},
-                {"txbuf", radio_stat.txbuf},
-                {"rxerrors", radio_stat.rxerrors},
-                {"fixed", radio_stat.fixed}
-            }},
-            {"connectionStatus", connected ? "connected" : "disconnected"}
+json ConnectionManager::get_telemetry_data(const std::string& vehicle_id, int64_t* updated_ms) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return json{
+            {"success", false},
+            {"error", "Vehicle not found"}
         };
-        return telemetry_json.dump();
-    } catch (const std::exception& e) {
+    }
+    if (!vehicle->telemetry) {
         return json{
             {"success", false},
-            {"error", std::string("Telemetry error: ") + e.what()}
-        }.dump();
+            {"error", "Telemetry plugin not available"}
+        };
     }
+
+    // Same document as get_telemetry_data_json(), built as a DOM for the
+    // stream's diffs rather than serialized and parsed back each tick
+    const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+    const auto& schema = telemetry_schema();
+    json data;
+    JsonDomWriter writer(data);
+    schema.write({*vehicle, snapshot}, schema.all(), writer);
+    data.erase("timestamp");
+    if (updated_ms) *updated_ms = snapshot_time_ms(snapshot);
+    return data;
 }
 
 bool ConnectionManager::upload_mission(const std::string& vehicle_id, const json& mission_json) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mission_raw_plugins.count(vehicle_id)) return false;
+    // No lock held across the upload: it can take up to 10 s
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->mission_raw) return false;
 
     std::vector<mavsdk::MissionRaw::MissionItem> mission_items;
     int seq = 0;
@@ -293,7 +393,7 @@ bool ConnectionManager::upload_mission(const std::string& vehicle_id, const json
 
     std::promise<mavsdk::MissionRaw::Result> prom;
     auto fut = prom.get_future();
-    _mission_raw_plugins.at(vehicle_id)->upload_mission_async(mission_items, [&prom](mavsdk::MissionRaw::Result result) {
+    vehicle->mission_raw->upload_mission_async(mission_items, [&prom](mavsdk::MissionRaw::Result result) {
         prom.set_value(result);
     });
 
@@ -304,27 +404,27 @@ bool ConnectionManager::upload_mission(const std::string& vehicle_id, const json
 }
 
 void ConnectionManager::start_mission(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_mission_raw_plugins.count(vehicle_id)) {
-        _mission_raw_plugins.at(vehicle_id)->start_mission_async(nullptr);
+    auto vehicle = _registry.find(vehicle_id);
+    if (vehicle && vehicle->mission_raw) {
+        vehicle->mission_raw->start_mission_async(nullptr);
     }
 }
 
 void ConnectionManager::clear_mission(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_mission_raw_plugins.count(vehicle_id)) {
-        _mission_raw_plugins.at(vehicle_id)->clear_mission_async(nullptr);
+    auto vehicle = _registry.find(vehicle_id);
+    if (vehicle && vehicle->mission_raw) {
+        vehicle->mission_raw->clear_mission_async(nullptr);
     }
 }
 
 std::string ConnectionManager::download_mission(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mission_raw_plugins.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->mission_raw) {
         return json{{"success", false}, {"error", "Vehicle not found"}}.dump();
     }
 
     try {
-        auto mission_plugin = _mission_raw_plugins.at(vehicle_id);
+        auto mission_plugin = vehicle->mission_raw;
         // Sync download for simplicity? Or future. MAVSDK v1 download_mission is sync? 
         // MissionRaw::download_mission is sync.
         auto result = mission_plugin->download_mission();
@@ -372,10 +472,9 @@ std::string ConnectionManager::download_mission(const std::string& vehicle_id) {
     }
 }
 
-std::string ConnectionManager::get_vehicle_status(const std::string& vehicle_id) {
-    // Reuse existing telemetry data but add more status fields
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_systems.count(vehicle_id)) {
+std::string ConnectionManager::get_vehicle_status(const std::string& vehicle_id, const FieldProjection* fields) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
         return json{
             {"success", false},
             {"error", "Vehicle not found"}
@@ -383,75 +482,14 @@ std::string ConnectionManager::get_vehicle_status(const std::string& vehicle_id)
     }
 
     try {
-        auto telemetry = _telemetry_plugins.at(vehicle_id);
-        auto system = _systems.at(vehicle_id);
-        
-        // Get all telemetry data
-        auto position = telemetry->position();
-        auto attitude = telemetry->attitude_euler();
-        auto battery = telemetry->battery();
-        auto flight_mode = telemetry->flight_mode();
-        auto armed = telemetry->armed();
-        auto in_air = telemetry->in_air();
-        auto velocity = telemetry->velocity_ned();
-        auto gps_info = telemetry->gps_info();
-        auto health = telemetry->health();
-        bool connected = system->is_connected();
-        
-        // Get ArduPilot mode string
-        std::string mode_string = flight_mode_to_string(flight_mode);
-        auto it_type = _last_mav_type.find(vehicle_id);
-        auto it_cust = _last_custom_mode.find(vehicle_id);
-        if (it_type != _last_mav_type.end() && it_cust != _last_custom_mode.end()) {
-            mode_string = ardupilot_custom_mode_to_string(it_type->second, it_cust->second);
-        }
-
-
-        
-        json status_json = {
-            {"success", true},
-            {"vehicle_id", vehicle_id},
-            {"connected", connected},
-            {"armed", armed},
-            {"in_air", in_air},
-            {"flight_mode", mode_string},
-            {"position", {
-                {"lat", position.latitude_deg},
-                {"lng", position.longitude_deg},
-                {"alt_rel", position.relative_altitude_m},
-                {"alt_abs", position.absolute_altitude_m}
-            }},
-            {"attitude", {
-                {"roll", attitude.roll_deg},
-                {"pitch", attitude.pitch_deg},
-                {"yaw", attitude.yaw_deg}
-            }},
-            {"velocity", {
-                {"north", velocity.north_m_s},
-                {"east", velocity.east_m_s},
-                {"down", velocity.down_m_s},
-                {"groundspeed", std::sqrt(velocity.north_m_s * velocity.north_m_s + velocity.east_m_s * velocity.east_m_s)}
-            }},
-            {"battery", {
-                {"voltage", battery.voltage_v},
-                {"remaining", battery.remaining_percent},
-                {"current", battery.current_battery_a}
-            }},
-            {"gps", {
-                {"satellites", gps_info.num_satellites},
-                {"fix_type", static_cast<int>(gps_info.fix_type)}
-            }},
-            {"health", {
-                {"is_gyrometer_calibration_ok", health.is_gyrometer_calibration_ok},
-                {"is_accelerometer_calibration_ok", health.is_accelerometer_calibration_ok},
-                {"is_magnetometer_calibration_ok", health.is_magnetometer_calibration_ok},
-                {"is_local_position_ok", health.is_local_position_ok},
-                {"is_global_position_ok", health.is_global_position_ok},
-                {"is_home_position_ok", health.is_home_position_ok}
-            }}
-        };
-        
-        return status_json.dump();
+        // Get all (or the selected) telemetry data, from one consistent snapshot
+        const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+        const auto& schema = status_schema();
+        std::string out;
+        out.reserve(fields ? 160 : 1024);
+        JsonWriter writer(out);
+        schema.write({*vehicle, snapshot}, fields ? *fields : schema.all(), writer);
+        return out;
         
     } catch (const std::exception& e) {
         return json{
@@ -461,824 +499,817 @@ std::string ConnectionManager::get_vehicle_status(const std::string& vehicle_id)
     }
 }
 
-std::string ConnectionManager::get_all_vehicle_statuses() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    json all_statuses = json::array();
-    
-    // Helper helper to avoid duplicating mode string logic
-    auto get_mode_string = [this](const std::string& vehicle_id, mavsdk::Telemetry::FlightMode fm) -> std::string {
-        std::string mode_string = flight_mode_to_string(fm);
-        auto it_type = _last_mav_type.find(vehicle_id);
-        auto it_cust = _last_custom_mode.find(vehicle_id);
-        if (it_type != _last_mav_type.end() && it_cust != _last_custom_mode.end()) {
-            mode_string = ardupilot_custom_mode_to_string(it_type->second, it_cust->second);
-        }
-        return mode_string;
-    };
-
-    for (const auto& pair : _systems) {
-        std::string vehicle_id = pair.first;
-        auto system = pair.second;
-        
+std::string ConnectionManager::get_all_vehicle_statuses(const FieldProjection* fields, std::string* validator) {
+    const auto& schema = fleet_schema();
+    const FieldProjection& projection = fields ? *fields : schema.all();
+    std::string vehicles;
+    std::string item; // One vehicle, so a failure part-way leaves the list intact
+    std::string stable_item;
+    JsonWriter list(vehicles);
+    std::size_t count = 0;
+    list.begin_array();
+    if (validator) {
+        validator->clear();
+        validator->push_back('[');
+    }
+
+    // One registry snapshot for the whole fleet; each vehicle's telemetry is
+    // its own lock-free snapshot.
+    _registry.for_each([&](const std::shared_ptr<VehicleContext>& vehicle) {
+        const std::string& vehicle_id = vehicle->id;
+        ++count;
+        item.clear();
+        stable_item.clear();
         try {
-            // Basic Status
-            bool connected = system->is_connected();
-            
-            // Try to get telemetry plugin
-            if (_telemetry_plugins.count(vehicle_id)) {
-                auto telemetry = _telemetry_plugins.at(vehicle_id);
-                
-                // Fetch only critical data for list view
-                auto position = telemetry->position();
-                auto battery = telemetry->battery();
-                auto flight_mode = telemetry->flight_mode();
-                auto armed = telemetry->armed();
-                auto gps_info = telemetry->gps_info();
-                auto attitude = telemetry->attitude_euler(); // minimal attitude for heading
-                
-                json vehicle_json = {
-                    {"id", vehicle_id},
-                    {"connected", connected},
-                    {"armed", armed},
-                    {"flight_mode", get_mode_string(vehicle_id, flight_mode)},
-                    {"battery_pct", battery.remaining_percent},
-                    {"gps_sats", gps_info.num_satellites},
-                    {"gps_fix", static_cast<int>(gps_info.fix_type)},
-                    {"lat", position.latitude_deg},
-                    {"lng", position.longitude_deg},
-                    {"alt", position.relative_altitude_m},
-                    {"heading", attitude.yaw_deg}
-                };
-                all_statuses.push_back(vehicle_json);
+            if (vehicle->telemetry) {
+                const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+                JsonWriter writer(item);
+                schema.write({*vehicle, snapshot}, projection, writer);
+                if (validator) {
+                    // Same fields, but "timestamp" moves on with every
+                    // telemetry callback even when nothing shown changed
+                    TelemetrySnapshot stable = snapshot;
+                    stable.updated_us = 0;
+                    JsonWriter stable_writer(stable_item);
+                    schema.write({*vehicle, stable}, projection, stable_writer);
+                }
             } else {
                 // System exists but no telemetry plugin somehow?
-                all_statuses.push_back({
+                item = json{
                     {"id", vehicle_id},
-                    {"connected", connected},
+                    {"connected", vehicle->system->is_connected()},
                     {"status", "no_telemetry"}
-                });
+                }.dump();
             }
         } catch (const std::exception& e) {
-             std::cerr << "Error getting status for " << vehicle_id << ": " << e.what() << std::endl;
+             LOG_ERROR("Connection") << "Error getting status for " << vehicle_id << ": " << e.what();
              // Include minimal info to not break the list
-             all_statuses.push_back({
+             item = json{
                  {"id", vehicle_id},
                  {"error", "status_fetch_failed"}
-             });
+             }.dump();
+             stable_item.clear();
+        }
+        list.raw(item);
+        if (validator) {
+            // Entries without telemetry carry no timestamp and stand as they are
+            *validator += stable_item.empty() ? item : stable_item;
+            validator->push_back(',');
         }
+    });
+    list.end_array();
+    if (validator) validator->push_back(']');
+
+    std::string out;
+    out.reserve(vehicles.size() + 48);
+    JsonWriter writer(out);
+    writer.begin_object();
+    writer.key("count");
+    writer.value(count);
+    writer.key("success");
+    writer.value(true);
+    writer.key("vehicles");
+    writer.raw(vehicles);
+    writer.end_object();
+    return out;
+}
+
+std::string ConnectionManager::get_fleet_columns_json() {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::string> ids, modes;
+    std::vector<double> lat, lng, alt, heading, battery;
+
+    _registry.for_each([&](const std::shared_ptr<VehicleContext>& vehicle) {
+        double v_lat = nan, v_lng = nan, v_alt = nan, v_heading = nan, v_battery = nan;
+        std::string mode;
+        if (vehicle->telemetry) {
+            const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+            v_lat = snapshot.position.latitude_deg;
+            v_lng = snapshot.position.longitude_deg;
+            v_alt = snapshot.position.relative_altitude_m;
+            v_heading = snapshot.attitude.yaw_deg;
+            v_battery = snapshot.battery.remaining_percent;
+            mode = vehicle_mode_string(*vehicle, snapshot.flight_mode);
+        }
+        ids.push_back(vehicle->id);
+        lat.push_back(v_lat);
+        lng.push_back(v_lng);
+        alt.push_back(v_alt);
+        heading.push_back(v_heading);
+        battery.push_back(v_battery);
+        modes.push_back(std::move(mode));
+    });
+
+    std::string out;
+    out.reserve(64 + ids.size() * 96);
+    JsonWriter writer(out);
+    auto column = [&writer](std::string_view name, const auto& values) {
+        writer.key(name);
+        writer.begin_array();
+        for (const auto& value : values) writer.value(value);
+        writer.end_array();
+    };
+    writer.begin_object();
+    writer.key("type");
+    writer.value("fleet");
+    writer.key("time");
+    writer.value(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    column("ids", ids);
+    column("lat", lat);
+    column("lng", lng);
+    column("alt", alt);
+    column("heading", heading);
+    column("battery", battery);
+    column("mode", modes);
+    writer.end_object();
+    return out;
+}
+
+json ConnectionManager::get_telemetry_history(const std::string& vehicle_id, const std::vector<HistoryChannel>& channels,
+                                              int64_t from_ms, int64_t to_ms, std::size_t max_points, HistoryDownsample mode) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return json{
+            {"success", false},
+            {"error", "Vehicle not found"}
+        };
+    }
+
+    // Copy out under the history lock, downsample without it
+    auto series = vehicle->history.range(channels, from_ms, to_ms);
+    json fields = json::object();
+    for (std::size_t i = 0; i < channels.size(); ++i) {
+        const std::size_t samples = series[i].values.size();
+        auto points = mode == HistoryDownsample::MinMax ? downsample_minmax(series[i], max_points)
+                                                        : downsample_lttb(series[i], max_points);
+        fields[TelemetryHistory::channel_name(channels[i])] = {
+            {"time", std::move(points.time_ms)},
+            {"values", std::move(points.values)},
+            {"samples", samples}
+        };
     }
-    
     return json{
         {"success", true},
-        {"vehicles", all_statuses},
-        {"count", all_statuses.size()}
-    }.dump();
+        {"vehicleId", vehicle_id},
+        {"from", from_ms},
+        {"to", to_ms},
+        {"intervalMs", vehicle->history.interval_ms()},
+        {"fields", std::move(fields)}
+    };
 }
 
+// Receive time for link stats (epoch microseconds)
+static int64_t receive_time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
-void ConnectionManager::start_mavlink_streaming(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_systems.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for MAVLink streaming" << std::endl;
-        return;
+json ConnectionManager::get_link_stats(const std::string& vehicle_id) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return json{
+            {"success", false},
+            {"error", "Vehicle not found"}
+        };
     }
-    
-    _streaming_active[vehicle_id] = true;
-    
-    // Setup comprehensive MAVLink message subscriptions using MavlinkPassthrough
-    setup_mavlink_subscriptions(vehicle_id);
-    
-    std::cout << "Started comprehensive MAVLink streaming for vehicle: " << vehicle_id << std::endl;
+
+    // Rounded so that pushes over the telemetry stream only carry real changes
+    auto round_to = [](double value, double step) { return std::round(value / step) * step; };
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    double total_rate_hz = 0, total_bytes_per_sec = 0;
+    json messages = json::object();
+    for (const auto& stats : vehicle->link_stats.summarize(receive_time_us())) {
+        total_rate_hz += stats.rate_hz;
+        total_bytes_per_sec += stats.bytes_per_sec;
+        const std::string_view name = decoder.name(stats.msgid);
+        messages[name.empty() ? std::to_string(stats.msgid) : std::string(name)] = {
+            {"msgid", stats.msgid},
+            {"count", stats.count},
+            {"bytes", stats.bytes},
+            {"rateHz", round_to(stats.rate_hz, 0.1)},
+            {"bytesPerSec", std::round(stats.bytes_per_sec)},
+            {"jitterMs", round_to(stats.jitter_ms, 0.1)},
+            {"lastSeen", stats.last_seen_us / 1000},
+            {"requestedHz", stats.requested_hz}
+        };
+    }
+    return json{
+        {"success", true},
+        {"vehicleId", vehicle_id},
+        {"rateHz", round_to(total_rate_hz, 0.1)},
+        {"bytesPerSec", std::round(total_bytes_per_sec)},
+        {"messages", std::move(messages)}
+    };
 }
 
-void ConnectionManager::setup_mavlink_subscriptions(const std::string& vehicle_id) {
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    if (!passthrough) {
-        std::cerr << "MavlinkPassthrough plugin not available for vehicle: " << vehicle_id << std::endl;
-        return;
+bool ConnectionManager::start_mavlink_streaming(const std::string& vehicle_id) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for MAVLink streaming";
+        return false;
     }
 
-    // Subscribe to all common MAVLink messages that QGroundControl handles
-    // This gives us the same comprehensive coverage as QGroundControl
-    
-    // HEARTBEAT - System status and mode
-    passthrough->subscribe_message(MAVLINK_MSG_ID_HEARTBEAT, 
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // GPS_RAW_INT - GPS position data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_GPS_RAW_INT,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // SYS_STATUS - System status including battery
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SYS_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // BATTERY_STATUS - Detailed battery information
-    passthrough->subscribe_message(MAVLINK_MSG_ID_BATTERY_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // ATTITUDE - Vehicle attitude
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ATTITUDE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
+    if (!vehicle->ingest) {
+        LOG_ERROR("Connection") << "No ingest pipeline for vehicle " << vehicle_id << ", cannot stream";
+        return false;
+    }
 
-    // ATTITUDE_TARGET - Desired attitude
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ATTITUDE_TARGET,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-        
-    // RADIO_STATUS - Telemetry link status (critical for link budget)
-    passthrough->subscribe_message(MAVLINK_MSG_ID_RADIO_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-        
-    // --- Hook TLog Recorder ---
-    // Fallback since intercept_incoming_messages_async is missing in this MAVSDK version.
-    // We subscribe to a broad range of message IDs to capture most telemetry.
-    for (uint16_t id = 1; id <= 400; ++id) {
-         passthrough->subscribe_message(id, [this, vehicle_id](const mavlink_message_t& message) {
-            TLogRecorder::instance().record_message(vehicle_id, message);
-            // Note: We might get duplicates if we have specific subscriptions that also trace?
-            // Actually, setup_mavlink_subscriptions uses specific handlers. 
-            // This loop registers a SEPARATE callback for each ID.
-            // MAVSDK should call both if multiple are registered.
-            // However, we should check if we are overwriting?
-            // "This means that all future messages being received will trigger the callback" 
-            // It suggests one callback per ID?
-            // Docs say: "To stop the subscription, call this method with nullptr".
-            // It implies ONE callback.
-            // OH NO. If I overwrite the callback, I break the specific handlers (ATTITUDE, BATTERY, etc).
-         });
+    // Subscriptions themselves are made once, in add_vehicle(), and the stream
+    // stage records into the ring from then on; streaming only gives the
+    // sender a cursor to drain, so opening clients never adds callbacks
+    std::lock_guard<std::mutex> lock(vehicle->mutex);
+    if (vehicle->stream_subscribers++ > 0) {
+        LOG_DEBUG("Connection").vehicle(vehicle_id) << "MAVLink stream subscriber added (" << vehicle->stream_subscribers
+            << " attached, " << vehicle->ingest->subscription_count() << " passthrough subscriptions)";
+        return true;
     }
-    
-    // CRITICAL: We cannot overwrite existing subscriptions.
-    // If MAVSDK only supports one callback per ID, this approach breaks the app.
-    // I need to check if subscribe_message returns a handle and allows multiple.
-    // The header said: "MessageHandle subscribe_message(...)". 
-    // Usually returning a handle implies multiple subscribers are allowed.
-    // "This means that all future messages being received will trigger the callback"
-    // Let's assume it supports multiple. MAVSDK v1 usually does (signal/slot style).
-
-
-    // ADSB_VEHICLE - Air traffic data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ADSB_VEHICLE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // ATTITUDE_QUATERNION - Quaternion attitude
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // LOCAL_POSITION_NED - Local position
-    passthrough->subscribe_message(MAVLINK_MSG_ID_LOCAL_POSITION_NED,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // GLOBAL_POSITION_INT - Global position
-    passthrough->subscribe_message(MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // VFR_HUD - Vehicle flight data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_VFR_HUD,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // RC_CHANNELS - RC input channels
-    passthrough->subscribe_message(MAVLINK_MSG_ID_RC_CHANNELS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // RADIO_STATUS - Radio link status
-    passthrough->subscribe_message(MAVLINK_MSG_ID_RADIO_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // GPS_STATUS - GPS status information
-    passthrough->subscribe_message(MAVLINK_MSG_ID_GPS_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // SCALED_PRESSURE - Pressure sensor data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SCALED_PRESSURE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // SCALED_PRESSURE2 - Additional pressure sensor data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SCALED_PRESSURE2,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // SCALED_PRESSURE3 - Third pressure sensor data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SCALED_PRESSURE3,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // STATUSTEXT - Status text messages
-    passthrough->subscribe_message(MAVLINK_MSG_ID_STATUSTEXT,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // COMMAND_ACK - Command acknowledgment
-    passthrough->subscribe_message(MAVLINK_MSG_ID_COMMAND_ACK,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
+    // First subscriber gets a fresh cursor: the stream starts at the live
+    // edge, not at whatever the ring still holds from a previous session
+    vehicle->stream_reader.emplace(vehicle->stream_frames);
+    vehicle->streaming.store(true, std::memory_order_relaxed);
 
-    // MAG_CAL_PROGRESS - Compass calibration progress
-    // passthrough->subscribe_message(MAVLINK_MSG_ID_MAG_CAL_PROGRESS, ...); // Missing header
+    LOG_INFO("Connection") << "Started comprehensive MAVLink streaming for vehicle: " << vehicle_id;
+    return true;
+}
 
-    // MAG_CAL_REPORT - Compass calibration report
-    passthrough->subscribe_message(MAVLINK_MSG_ID_MAG_CAL_REPORT,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // EXTENDED_SYS_STATE - Extended system state
-    passthrough->subscribe_message(MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // HOME_POSITION - Home position
-    passthrough->subscribe_message(MAVLINK_MSG_ID_HOME_POSITION,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // HIGH_LATENCY - High latency telemetry
-    passthrough->subscribe_message(MAVLINK_MSG_ID_HIGH_LATENCY,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // HIGH_LATENCY2 - High latency telemetry v2
-    passthrough->subscribe_message(MAVLINK_MSG_ID_HIGH_LATENCY2,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // MESSAGE_INTERVAL - Message interval settings
-    passthrough->subscribe_message(MAVLINK_MSG_ID_MESSAGE_INTERVAL,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // PING - Ping messages
-    passthrough->subscribe_message(MAVLINK_MSG_ID_PING,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // OBSTACLE_DISTANCE - Obstacle distance sensor data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_OBSTACLE_DISTANCE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // FENCE_STATUS - Geofence status
-    passthrough->subscribe_message(MAVLINK_MSG_ID_FENCE_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // ADSB_VEHICLE - ADS-B vehicle information
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ADSB_VEHICLE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // CAMERA_IMAGE_CAPTURED - Camera image capture events
-    passthrough->subscribe_message(MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // ORBIT_EXECUTION_STATUS - Orbit execution status
-    passthrough->subscribe_message(MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // EVENT - Event messages
-    passthrough->subscribe_message(MAVLINK_MSG_ID_EVENT,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // CURRENT_EVENT_SEQUENCE - Current event sequence
-    passthrough->subscribe_message(MAVLINK_MSG_ID_CURRENT_EVENT_SEQUENCE,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // RESPONSE_EVENT_ERROR - Response event error
-    passthrough->subscribe_message(MAVLINK_MSG_ID_RESPONSE_EVENT_ERROR,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // SERIAL_CONTROL - Serial control messages
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SERIAL_CONTROL,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // LOG_ENTRY - Log entry information
-    passthrough->subscribe_message(MAVLINK_MSG_ID_LOG_ENTRY,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // LOG_DATA - Log data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_LOG_DATA,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // LOGGING_DATA - Logging data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_LOGGING_DATA,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // LOGGING_DATA_ACKED - Acknowledged logging data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_LOGGING_DATA_ACKED,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // WIND_COV - Wind covariance
-    passthrough->subscribe_message(MAVLINK_MSG_ID_WIND_COV,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // IMU data messages
-    passthrough->subscribe_message(MAVLINK_MSG_ID_SCALED_IMU,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    passthrough->subscribe_message(MAVLINK_MSG_ID_RAW_IMU,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    // Distance sensor data
-    passthrough->subscribe_message(MAVLINK_MSG_ID_DISTANCE_SENSOR,
-        [this, vehicle_id](const mavlink_message_t& message) {
-            handle_mavlink_message(vehicle_id, message);
-        });
-    
-    std::cout << "Set up comprehensive MAVLink message subscriptions for vehicle: " << vehicle_id << std::endl;
+// Messages consumed by the always-on state stage. Handlers must not allocate
+// or build JSON; they run for every matching packet.
+static constexpr uint32_t kStateMessageIds[] = {
+    MAVLINK_MSG_ID_HEARTBEAT,               // Mode / vehicle type tracking
+    MAVLINK_MSG_ID_RADIO_STATUS,            // Link budget
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT,     // History: position, altitude, heading
+    MAVLINK_MSG_ID_VFR_HUD,                 // History: speeds
+    MAVLINK_MSG_ID_SYS_STATUS,              // History: battery
+    MAVLINK_MSG_ID_COMMAND_ACK,             // Wakes command waiters
+    MAVLINK_MSG_ID_MAG_CAL_REPORT,          // Compass calibration progress
+    MAVLINK_MSG_ID_STATUSTEXT               // Calibration feedback
+};
+
+// Messages recorded for the MAVLink inspector stream, and forwarded while a
+// client is attached.
+// Mirrors the set QGroundControl subscribes to.
+static constexpr uint32_t kInspectorMessageIds[] = {
+    MAVLINK_MSG_ID_HEARTBEAT,               // System status and mode
+    MAVLINK_MSG_ID_GPS_RAW_INT,             // GPS position data
+    MAVLINK_MSG_ID_SYS_STATUS,              // System status including battery
+    MAVLINK_MSG_ID_BATTERY_STATUS,          // Detailed battery information
+    MAVLINK_MSG_ID_ATTITUDE,                // Vehicle attitude
+    MAVLINK_MSG_ID_ATTITUDE_TARGET,         // Desired attitude
+    MAVLINK_MSG_ID_RADIO_STATUS,            // Telemetry link status (critical for link budget)
+    MAVLINK_MSG_ID_ADSB_VEHICLE,            // Air traffic data
+    MAVLINK_MSG_ID_ATTITUDE_QUATERNION,     // Quaternion attitude
+    MAVLINK_MSG_ID_LOCAL_POSITION_NED,      // Local position
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT,     // Global position
+    MAVLINK_MSG_ID_VFR_HUD,                 // Vehicle flight data
+    MAVLINK_MSG_ID_RC_CHANNELS,             // RC input channels
+    MAVLINK_MSG_ID_GPS_STATUS,              // GPS status information
+    MAVLINK_MSG_ID_SCALED_PRESSURE,         // Pressure sensor data
+    MAVLINK_MSG_ID_SCALED_PRESSURE2,
+    MAVLINK_MSG_ID_SCALED_PRESSURE3,
+    MAVLINK_MSG_ID_STATUSTEXT,              // Status text messages
+    MAVLINK_MSG_ID_COMMAND_ACK,             // Command acknowledgment
+    // MAVLINK_MSG_ID_MAG_CAL_PROGRESS,     // Missing header
+    MAVLINK_MSG_ID_MAG_CAL_REPORT,          // Compass calibration report
+    MAVLINK_MSG_ID_EXTENDED_SYS_STATE,      // Extended system state
+    MAVLINK_MSG_ID_HOME_POSITION,           // Home position
+    MAVLINK_MSG_ID_HIGH_LATENCY,            // High latency telemetry
+    MAVLINK_MSG_ID_HIGH_LATENCY2,
+    MAVLINK_MSG_ID_MESSAGE_INTERVAL,        // Message interval settings
+    MAVLINK_MSG_ID_PING,
+    MAVLINK_MSG_ID_OBSTACLE_DISTANCE,       // Obstacle distance sensor data
+    MAVLINK_MSG_ID_FENCE_STATUS,            // Geofence status
+    MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,   // Camera image capture events
+    MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS,
+    MAVLINK_MSG_ID_EVENT,                   // Event messages
+    MAVLINK_MSG_ID_CURRENT_EVENT_SEQUENCE,
+    MAVLINK_MSG_ID_RESPONSE_EVENT_ERROR,
+    MAVLINK_MSG_ID_SERIAL_CONTROL,
+    MAVLINK_MSG_ID_LOG_ENTRY,               // Log entry information
+    MAVLINK_MSG_ID_LOG_DATA,
+    MAVLINK_MSG_ID_LOGGING_DATA,
+    MAVLINK_MSG_ID_LOGGING_DATA_ACKED,
+    MAVLINK_MSG_ID_WIND_COV,                // Wind covariance
+    MAVLINK_MSG_ID_SCALED_IMU,              // IMU data messages
+    MAVLINK_MSG_ID_RAW_IMU,
+    MAVLINK_MSG_ID_DISTANCE_SENSOR          // Distance sensor data
+};
+
+void ConnectionManager::setup_ingest_pipeline(const std::shared_ptr<VehicleContext>& context) {
+    VehicleContext& vehicle = *context;
+    if (!vehicle.passthrough) {
+        LOG_ERROR("Connection") << "MavlinkPassthrough plugin not available for vehicle: " << vehicle.id;
+        return;
+    }
+
+    // One ingest entry point per vehicle; recording, link stats, state tracking
+    // and the inspector stream are stages on it instead of separate MAVSDK subscriptions.
+    // Stage context is the VehicleContext, which owns the pipeline; every
+    // passthrough callback holds a reference to it while dispatching, so a
+    // callback MAVSDK delivers after detach() never sees a freed context.
+    auto ingest = std::make_unique<MavlinkIngest>(vehicle.id);
+    ingest->add_stage_all("tlog",
+        [](void*, const MavlinkIngest& source, const mavlink_message_t& message) {
+            TLogRecorder::instance().record_message(source.vehicle_id(), message);
+        }, nullptr);
+    // Stats slots for every id the pipeline subscribes to; the stage only
+    // updates counters in place, so the table stays fixed once attached
+    for (uint32_t id = MavlinkIngest::kAllMsgIdFirst; id <= MavlinkIngest::kAllMsgIdLast; ++id) vehicle.link_stats.track(id);
+    for (uint32_t id : kStateMessageIds) vehicle.link_stats.track(id);
+    for (uint32_t id : kInspectorMessageIds) vehicle.link_stats.track(id);
+    ingest->add_stage_all("link_stats",
+        [](void* context, const MavlinkIngest&, const mavlink_message_t& message) {
+            static_cast<VehicleContext*>(context)->link_stats.record(message, receive_time_us());
+        }, &vehicle);
+    ingest->add_stage("state",
+        [](void* context, const MavlinkIngest&, const mavlink_message_t& message) {
+            ingest_vehicle_state(*static_cast<VehicleContext*>(context), message);
+        }, &vehicle, kStateMessageIds, std::size(kStateMessageIds));
+    // Always on, subscribers or not: serverSeq keeps counting and a client
+    // that drops off (laptop sleep, Wi-Fi handoff) resumes from the ring
+    // instead of losing the span it was away
+    ingest->add_stage("stream",
+        [](void* context, const MavlinkIngest&, const mavlink_message_t& message) {
+            stream_mavlink_message(*static_cast<VehicleContext*>(context), message);
+        }, &vehicle, kInspectorMessageIds, std::size(kInspectorMessageIds));
+
+    ingest->attach(vehicle.passthrough, context);
+    vehicle.ingest = std::move(ingest);
+
+    LOG_INFO("Connection") << "Set up MAVLink ingest pipeline for vehicle: " << vehicle.id;
 }
 
-void ConnectionManager::handle_mavlink_message(const std::string& vehicle_id, const mavlink_message_t& message) {
-    try {
-        // Debug logging: print every MAVLink message received
-        std::cout << "[MAVLINK] Vehicle: " << vehicle_id << ", Msg: " << get_mavlink_message_name(message.msgid) << " (" << message.msgid << ")" << std::endl;
-        // Optionally, print key fields for common messages
-        switch (message.msgid) {
-            case MAVLINK_MSG_ID_HEARTBEAT: {
-                // Track last-known base/custom mode and MAV type/autopilot for QGC-like behavior
-                mavlink_heartbeat_t hb;
-                mavlink_msg_heartbeat_decode(&message, &hb);
-                {
-                    std::lock_guard<std::mutex> lock(_mutex);
-                    _last_base_mode[vehicle_id] = hb.base_mode;
-                    _last_custom_mode[vehicle_id] = hb.custom_mode;
-                    _last_mav_type[vehicle_id] = hb.type;
-                    _last_autopilot[vehicle_id] = hb.autopilot;
+// Receive time for history rows (epoch milliseconds). Counted on
+// steady_clock from an epoch anchor taken once, so a wall clock step neither
+// stalls recording nor leaves a jump in the rows.
+static int64_t history_now_ms() {
+    auto steady_ms = [] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    static const int64_t epoch_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - steady_ms();
+    return epoch_offset_ms + steady_ms();
+}
+
+void ConnectionManager::ingest_vehicle_state(VehicleContext& vehicle, const mavlink_message_t& message) {
+    constexpr float kUnknown = std::numeric_limits<float>::quiet_NaN();
+    switch (message.msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT: {
+            // Track last-known base/custom mode and MAV type/autopilot for QGC-like behavior
+            mavlink_heartbeat_t hb;
+            mavlink_msg_heartbeat_decode(&message, &hb);
+            HeartbeatState state;
+            state.seen = true;
+            state.base_mode = hb.base_mode;
+            state.custom_mode = hb.custom_mode;
+            state.mav_type = hb.type;
+            state.autopilot = hb.autopilot;
+            vehicle.heartbeat.store(state.pack(), std::memory_order_release);
+            break;
+        }
+        case MAVLINK_MSG_ID_RADIO_STATUS: {
+            mavlink_radio_status_t rad;
+            mavlink_msg_radio_status_decode(&message, &rad);
+            // Optional: Log if very low
+            if (rad.rssi < 20) {
+                LOG_WARN_EVERY_MS(5000, "Radio").vehicle(vehicle.id) << "Low RSSI: " << (int)rad.rssi;
+            }
+            // A simulated link replaces the real one; update_radio_simulation() owns radio and RSSI history
+            if (vehicle.radio_sim_enabled.load(std::memory_order_relaxed)) break;
+            vehicle.snapshot.update([&rad](TelemetrySnapshot& snapshot) {
+                snapshot.radio = {
+                    (int)rad.rssi,
+                    (int)rad.remrssi,
+                    (int)rad.noise,
+                    (int)rad.remnoise,
+                    (int)rad.txbuf,
+                    (int)rad.rxerrors,
+                    (int)rad.fixed
+                };
+            });
+            vehicle.history.record(history_now_ms(), {{HistoryChannel::Rssi, static_cast<float>(rad.rssi)}});
+            break;
+        }
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
+            mavlink_global_position_int_t pos;
+            mavlink_msg_global_position_int_decode(&message, &pos);
+            vehicle.history.record(history_now_ms(), {
+                {HistoryChannel::Lat, pos.lat * 1e-7},
+                {HistoryChannel::Lng, pos.lon * 1e-7},
+                {HistoryChannel::Alt, pos.relative_alt * 1e-3f},
+                {HistoryChannel::Heading, pos.hdg == UINT16_MAX ? kUnknown : pos.hdg * 1e-2f}
+            });
+            break;
+        }
+        case MAVLINK_MSG_ID_VFR_HUD: {
+            mavlink_vfr_hud_t hud;
+            mavlink_msg_vfr_hud_decode(&message, &hud);
+            vehicle.history.record(history_now_ms(), {
+                {HistoryChannel::Groundspeed, hud.groundspeed},
+                {HistoryChannel::Airspeed, hud.airspeed},
+                {HistoryChannel::Climb, hud.climb}
+            });
+            break;
+        }
+        case MAVLINK_MSG_ID_SYS_STATUS: {
+            mavlink_sys_status_t sys;
+            mavlink_msg_sys_status_decode(&message, &sys);
+            vehicle.history.record(history_now_ms(), {
+                {HistoryChannel::Battery, sys.battery_remaining < 0 ? kUnknown : static_cast<float>(sys.battery_remaining)},
+                {HistoryChannel::Voltage, sys.voltage_battery == UINT16_MAX ? kUnknown : sys.voltage_battery * 1e-3f}
+            });
+            break;
+        }
+        case MAVLINK_MSG_ID_COMMAND_ACK: {
+            mavlink_command_ack_t ack;
+            mavlink_msg_command_ack_decode(&message, &ack);
+            {
+                std::lock_guard<std::mutex> lock(vehicle.mutex);
+                vehicle.last_ack_command = ack.command;
+                vehicle.last_ack_result = ack.result;
+            }
+            vehicle.ack_cv.notify_all();
+            break;
+        }
+        /*
+        case MAVLINK_MSG_ID_MAG_CAL_PROGRESS: {
+             // MSG Definition missing in current MAVSDK
+             break;
+        }
+        */
+        case MAVLINK_MSG_ID_MAG_CAL_REPORT: {
+            mavlink_mag_cal_report_t report;
+            mavlink_msg_mag_cal_report_decode(&message, &report);
+            
+            std::lock_guard<std::mutex> lock(vehicle.mutex);
+            if (!vehicle.calibration || !vehicle.calibration->active) {
+                break;
+            }
+            auto& status = *vehicle.calibration;
+            
+            if (report.compass_id < 3) {
+                status.compass_complete[report.compass_id] = true;
+                if (report.cal_status == MAG_CAL_SUCCESS) {
+                    status.compass_progress[report.compass_id] = 100;
                 }
+            }
+            
+            // Check if all requested compasses are done
+            bool all_done = true;
+            bool any_failed = false;
+            for (int i=0; i<3; i++) {
+                if (report.cal_mask & (1 << i)) {
+                    if (!status.compass_complete[i]) all_done = false;
+                    // Check report status for success/fail if complete?
+                    // For simplicty logic, we just wait for reports.
+                }
+            }
+            
+            if (report.cal_status == MAG_CAL_SUCCESS) {
+                 LOG_INFO("Calibration").vehicle(vehicle.id) << "Compass " << (int)report.compass_id << " calibration SUCCESS";
+            } else {
+                 LOG_WARN("Calibration").vehicle(vehicle.id) << "Compass " << (int)report.compass_id << " calibration FAILED";
+                 any_failed = true;
+            }
+            
+            if (all_done) {
+                status.active = false;
+                status.success = !any_failed;
+                status.progress = 100;
+                status.status_text = any_failed ? "Calibration Failed" : "Calibration Complete. Reboot Vehicle.";
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_STATUSTEXT: {
+            mavlink_statustext_t status_text;
+            mavlink_msg_statustext_decode(&message, &status_text);
+            
+            // Text is not null terminated when all 50 chars are used
+            std::string_view text(status_text.text, strnlen(status_text.text, sizeof(status_text.text)));
+
+            LOG_INFO("StatusText").vehicle(vehicle.id) << text;
+
+            std::lock_guard<std::mutex> lock(vehicle.mutex);
+            if (!vehicle.calibration || !vehicle.calibration->active) {
                 break;
             }
+            // Update status text for calibration feedback
+            vehicle.calibration->status_text.assign(text.data(), text.size());
+            
+            if (text.find("Calibration successful") != std::string_view::npos || text.find("success") != std::string_view::npos) {
+                if (text.find("Calibration") != std::string_view::npos) {
+                     vehicle.calibration->success = true;
+                }
+            } else if (text.find("Calibration failed") != std::string_view::npos || text.find("Failed") != std::string_view::npos) {
+                if (text.find("Calibration") != std::string_view::npos) {
+                    vehicle.calibration->success = false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void ConnectionManager::stream_mavlink_message(VehicleContext& vehicle, const mavlink_message_t& message) {
+    try {
+        // Per-message tracing; compiled out unless XGCS_LOG_LEVEL <= TRACE
+        LOG_TRACE("MAVLink").vehicle(vehicle.id).msgid(message.msgid) << MavlinkDecoder::instance().name(message.msgid);
+#if XGCS_LOG_LEVEL <= XGCS_LOG_LEVEL_TRACE
+        // Optionally, print key fields for common messages
+        switch (message.msgid) {
             case MAVLINK_MSG_ID_ATTITUDE: {
                 mavlink_attitude_t att;
                 mavlink_msg_attitude_decode(&message, &att);
-                std::cout << "  [ATTITUDE] roll: " << att.roll << ", pitch: " << att.pitch << ", yaw: " << att.yaw << std::endl;
+                LOG_TRACE("MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "ATTITUDE roll: " << att.roll << ", pitch: " << att.pitch << ", yaw: " << att.yaw;
                 break;
             }
             case MAVLINK_MSG_ID_BATTERY_STATUS: {
                 mavlink_battery_status_t bat;
                 mavlink_msg_battery_status_decode(&message, &bat);
-                std::cout << "  [BATTERY] voltages[0]: " << bat.voltages[0] << ", current_battery: " << bat.current_battery << std::endl;
+                LOG_TRACE("MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "BATTERY voltages[0]: " << bat.voltages[0] << ", current_battery: " << bat.current_battery;
                 break;
             }
             case MAVLINK_MSG_ID_GPS_RAW_INT: {
                 mavlink_gps_raw_int_t gps;
                 mavlink_msg_gps_raw_int_decode(&message, &gps);
-                std::cout << "  [GPS_RAW_INT] lat: " << gps.lat << ", lon: " << gps.lon << ", sat: " << (int)gps.satellites_visible << std::endl;
+                LOG_TRACE("MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "GPS_RAW_INT lat: " << gps.lat << ", lon: " << gps.lon << ", sat: " << (int)gps.satellites_visible;
                 break;
             }
             case MAVLINK_MSG_ID_SYS_STATUS: {
                 mavlink_sys_status_t sys;
                 mavlink_msg_sys_status_decode(&message, &sys);
-                std::cout << "  [SYS_STATUS] voltage_battery: " << sys.voltage_battery << ", battery_remaining: " << (int)sys.battery_remaining << std::endl;
-                break;
-            }
-            case MAVLINK_MSG_ID_RADIO_STATUS: {
-                mavlink_radio_status_t rad;
-                mavlink_msg_radio_status_decode(&message, &rad);
-                {
-                    std::lock_guard<std::mutex> lock(_mutex);
-                    _radio_status[vehicle_id] = {
-                        (int)rad.rssi,
-                        (int)rad.remrssi,
-                        (int)rad.noise,
-                        (int)rad.remnoise,
-                        (int)rad.txbuf,
-                        (int)rad.rxerrors,
-                        (int)rad.fixed
-                    };
-                }
-                // Optional: Log if very low
-                if (rad.rssi < 20) std::cout << "  [RADIO_STATUS] Low RSSI: " << (int)rad.rssi << std::endl;
-                break;
-            }
-            case MAVLINK_MSG_ID_COMMAND_ACK: {
-                try {
-                    mavlink_command_ack_t ack;
-                    mavlink_msg_command_ack_decode(&message, &ack);
-                    {
-                        std::lock_guard<std::mutex> lock(_mutex);
-                        _last_ack_command[vehicle_id] = ack.command;
-                        _last_ack_result[vehicle_id] = ack.result;
-                    }
-                    _ack_cv.notify_all();
-                } catch (const std::exception& e) {
-                    std::cerr << "EXCEPTION in COMMAND_ACK handling for vehicle " << vehicle_id << ": " << e.what() << std::endl;
-                } catch (...) {
-                    std::cerr << "UNKNOWN EXCEPTION in COMMAND_ACK handling for vehicle " << vehicle_id << std::endl;
-                }
-                break;
-            }
-            /*
-            case MAVLINK_MSG_ID_MAG_CAL_PROGRESS: {
-                 // MSG Definition missing in current MAVSDK
-                 break;
-            }
-            */
-            case MAVLINK_MSG_ID_MAG_CAL_REPORT: {
-                mavlink_mag_cal_report_t report;
-                mavlink_msg_mag_cal_report_decode(&message, &report);
-                
-                std::lock_guard<std::mutex> lock(_mutex);
-                if (_calibration_status.count(vehicle_id) && _calibration_status[vehicle_id].active) {
-                    auto& status = _calibration_status[vehicle_id];
-                    
-                    if (report.compass_id < 3) {
-                        status.compass_complete[report.compass_id] = true;
-                        if (report.cal_status == MAG_CAL_SUCCESS) {
-                            status.compass_progress[report.compass_id] = 100;
-                        }
-                    }
-                    
-                    // Check if all requested compasses are done
-                    bool all_done = true;
-                    bool any_failed = false;
-                    for (int i=0; i<3; i++) {
-                        if (report.cal_mask & (1 << i)) {
-                            if (!status.compass_complete[i]) all_done = false;
-                            // Check report status for success/fail if complete?
-                            // For simplicty logic, we just wait for reports.
-                        }
-                    }
-                    
-                    if (report.cal_status == MAG_CAL_SUCCESS) {
-                         std::cout << "Compass " << (int)report.compass_id << " calibration SUCCESS" << std::endl;
-                    } else {
-                         std::cout << "Compass " << (int)report.compass_id << " calibration FAILED" << std::endl;
-                         any_failed = true;
-                    }
-                    
-                    if (all_done) {
-                        status.active = false;
-                        status.success = !any_failed;
-                        status.progress = 100;
-                        status.status_text = any_failed ? "Calibration Failed" : "Calibration Complete. Reboot Vehicle.";
-                    }
-                }
-                break;
-            }
-            case MAVLINK_MSG_ID_STATUSTEXT: {
-                mavlink_statustext_t status_text;
-                mavlink_msg_statustext_decode(&message, &status_text);
-                
-                // Ensure null termination
-                char text_buf[51];
-                strncpy(text_buf, status_text.text, 50);
-                text_buf[50] = '\0';
-                std::string text(text_buf);
-
-                std::cout << "  [STATUSTEXT] " << text << std::endl;
-
-                std::lock_guard<std::mutex> lock(_mutex);
-                if (_calibration_status.count(vehicle_id) && _calibration_status[vehicle_id].active) {
-                    // Update status text for calibration feedback
-                    _calibration_status[vehicle_id].status_text = text;
-                    
-                    if (text.find("Calibration successful") != std::string::npos || text.find("success") != std::string::npos) {
-                        if (text.find("Calibration") != std::string::npos) {
-                             _calibration_status[vehicle_id].success = true;
-                        }
-                    } else if (text.find("Calibration failed") != std::string::npos || text.find("Failed") != std::string::npos) {
-                        if (text.find("Calibration") != std::string::npos) {
-                            _calibration_status[vehicle_id].success = false;
-                        }
-                    }
-                }
+                LOG_TRACE("MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "SYS_STATUS voltage_battery: " << sys.voltage_battery << ", battery_remaining: " << (int)sys.battery_remaining;
                 break;
             }
             default:
                 break;
         }
-        if (!_streaming_active[vehicle_id]) {
-            return;
-        }
-        
-        // Create a JSON representation of the MAVLink message
-        json msg = {
-            {"msgName", get_mavlink_message_name(message.msgid)},
-            {"msgId", message.msgid},
-            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count()},
-            {"system_id", message.sysid},
-            {"component_id", message.compid},
-            {"sequence", message.seq},
-            {"payload_length", message.len},
-            {"fields", decode_mavlink_message(message)}
-        };
-        
-        std::lock_guard<std::mutex> lock(_mutex);
-        _mavlink_messages[vehicle_id].push(msg);
+#endif
         
-        // Keep only the last 100 messages to prevent memory issues
-        if (_mavlink_messages[vehicle_id].size() > 100) {
-            _mavlink_messages[vehicle_id].pop();
+        // Raw frame only; decoding happens on the consumer side. Never blocks:
+        // a full ring overwrites its oldest frame.
+        StreamFrame frame;
+        frame.receive_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        frame.message = message;
+        vehicle.stream_frames.push(frame);
+        // Nobody to drain it: record only, don't wake the sender
+        if (vehicle.stream_notifier && vehicle.streaming.load(std::memory_order_relaxed)) {
+            vehicle.stream_notifier->notify();
         }
     } catch (const std::exception& e) {
-        std::cerr << "EXCEPTION in handle_mavlink_message for vehicle " << vehicle_id << ": " << e.what() << std::endl;
+        LOG_ERROR_EVERY_MS(1000, "MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "EXCEPTION in stream_mavlink_message: " << e.what();
     } catch (...) {
-        std::cerr << "UNKNOWN EXCEPTION in handle_mavlink_message for vehicle " << vehicle_id << std::endl;
-    }
-}
-
-std::string ConnectionManager::get_mavlink_message_name(uint16_t msgid) {
-    switch (msgid) {
-        case MAVLINK_MSG_ID_HEARTBEAT: return "HEARTBEAT";
-        case MAVLINK_MSG_ID_GPS_RAW_INT: return "GPS_RAW_INT";
-        case MAVLINK_MSG_ID_SYS_STATUS: return "SYS_STATUS";
-        case MAVLINK_MSG_ID_BATTERY_STATUS: return "BATTERY_STATUS";
-        case MAVLINK_MSG_ID_ATTITUDE: return "ATTITUDE";
-        case MAVLINK_MSG_ID_ATTITUDE_QUATERNION: return "ATTITUDE_QUATERNION";
-        case MAVLINK_MSG_ID_LOCAL_POSITION_NED: return "LOCAL_POSITION_NED";
-        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: return "GLOBAL_POSITION_INT";
-        case MAVLINK_MSG_ID_VFR_HUD: return "VFR_HUD";
-        case MAVLINK_MSG_ID_RC_CHANNELS: return "RC_CHANNELS";
-        case MAVLINK_MSG_ID_RADIO_STATUS: return "RADIO_STATUS";
-        case MAVLINK_MSG_ID_GPS_STATUS: return "GPS_STATUS";
-        case MAVLINK_MSG_ID_SCALED_PRESSURE: return "SCALED_PRESSURE";
-        case MAVLINK_MSG_ID_SCALED_PRESSURE2: return "SCALED_PRESSURE2";
-        case MAVLINK_MSG_ID_SCALED_PRESSURE3: return "SCALED_PRESSURE3";
-        case MAVLINK_MSG_ID_STATUSTEXT: return "STATUSTEXT";
-        case MAVLINK_MSG_ID_COMMAND_ACK: return "COMMAND_ACK";
-        case MAVLINK_MSG_ID_EXTENDED_SYS_STATE: return "EXTENDED_SYS_STATE";
-        case MAVLINK_MSG_ID_HOME_POSITION: return "HOME_POSITION";
-        case MAVLINK_MSG_ID_HIGH_LATENCY: return "HIGH_LATENCY";
-        case MAVLINK_MSG_ID_HIGH_LATENCY2: return "HIGH_LATENCY2";
-        case MAVLINK_MSG_ID_MESSAGE_INTERVAL: return "MESSAGE_INTERVAL";
-        case MAVLINK_MSG_ID_PING: return "PING";
-        case MAVLINK_MSG_ID_OBSTACLE_DISTANCE: return "OBSTACLE_DISTANCE";
-        case MAVLINK_MSG_ID_FENCE_STATUS: return "FENCE_STATUS";
-        case MAVLINK_MSG_ID_ADSB_VEHICLE: return "ADSB_VEHICLE";
-        case MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED: return "CAMERA_IMAGE_CAPTURED";
-        case MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS: return "ORBIT_EXECUTION_STATUS";
-        case MAVLINK_MSG_ID_EVENT: return "EVENT";
-        case MAVLINK_MSG_ID_CURRENT_EVENT_SEQUENCE: return "CURRENT_EVENT_SEQUENCE";
-        case MAVLINK_MSG_ID_RESPONSE_EVENT_ERROR: return "RESPONSE_EVENT_ERROR";
-        case MAVLINK_MSG_ID_SERIAL_CONTROL: return "SERIAL_CONTROL";
-        case MAVLINK_MSG_ID_LOG_ENTRY: return "LOG_ENTRY";
-        case MAVLINK_MSG_ID_LOG_DATA: return "LOG_DATA";
-        case MAVLINK_MSG_ID_LOGGING_DATA: return "LOGGING_DATA";
-        case MAVLINK_MSG_ID_LOGGING_DATA_ACKED: return "LOGGING_DATA_ACKED";
-        case MAVLINK_MSG_ID_WIND_COV: return "WIND_COV";
-        case MAVLINK_MSG_ID_SCALED_IMU: return "SCALED_IMU";
-        case MAVLINK_MSG_ID_RAW_IMU: return "RAW_IMU";
-        case MAVLINK_MSG_ID_DISTANCE_SENSOR: return "DISTANCE_SENSOR";
-        default: return "UNKNOWN_" + std::to_string(msgid);
+        LOG_ERROR_EVERY_MS(1000, "MAVLink").vehicle(vehicle.id).msgid(message.msgid) << "UNKNOWN EXCEPTION in stream_mavlink_message";
     }
 }
 
+// Writes the inspector envelope
+//   {"component_id":..,"fields":{..},"msgId":..,"msgName":..,"payload_length":..,
+//    "sequence":..,"serverSeq":..,"system_id":..,"timestamp":..}
+// directly, with keys in the sorted order nlohmann::json would dump them, so
+// the client sees the same bytes as the old DOM path without building one.
+// "sequence" is the MAVLink packet sequence; "serverSeq" the stream position.
+void ConnectionManager::write_stream_frame(const StreamMessage& stream_message, std::string& out) {
+    const StreamFrame& frame = stream_message.frame;
+    const mavlink_message_t& message = frame.message;
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    JsonWriter writer(out);
+
+    writer.begin_object();
+    writer.key("component_id");
+    writer.value(message.compid);
+    writer.key("fields");
+    if (message.msgid == MAVLINK_MSG_ID_ADSB_VEHICLE || !decoder.known(message.msgid)) {
+        // Special-cased shapes are rare; let decode_mavlink_message build them
+        writer.raw(decode_mavlink_message(message).dump());
+    } else {
+        decoder.write_fields(message, writer);
+    }
+    writer.key("msgId");
+    writer.value(static_cast<uint32_t>(message.msgid));
+    writer.key("msgName");
+    std::string_view name = decoder.name(message.msgid);
+    char unknown[24] = "UNKNOWN_";
+    if (name.empty()) {
+        // Ids outside the compiled dialect
+        auto result = std::to_chars(unknown + 8, unknown + sizeof(unknown), static_cast<uint32_t>(message.msgid));
+        name = std::string_view(unknown, static_cast<std::size_t>(result.ptr - unknown));
+    }
+    writer.value(name);
+    writer.key("payload_length");
+    writer.value(message.len);
+    writer.key("sequence");
+    writer.value(message.seq);
+    writer.key("serverSeq");
+    writer.value(stream_message.sequence);
+    writer.key("system_id");
+    writer.value(message.sysid);
+    writer.key("timestamp");
+    writer.value(frame.receive_time_us / 1000);
+    writer.end_object();
+}
+
+// Raw packet as the vehicle sent it, behind a 16-byte header of two
+// little-endian uint64s: receive timestamp in microseconds, then the server
+// sequence number. Browsers can hand the packet straight to a MAVLink JS
+// parser.
+void ConnectionManager::write_stream_frame_mavlink(const StreamMessage& stream_message, std::string& out) {
+    const StreamFrame& frame = stream_message.frame;
+    uint8_t packet[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(packet, &frame.message);
+
+    const uint64_t timestamp = static_cast<uint64_t>(frame.receive_time_us);
+    char header[16];
+    for (int i = 0; i < 8; ++i) {
+        header[i] = static_cast<char>((timestamp >> (8 * i)) & 0xFF);
+        header[8 + i] = static_cast<char>((stream_message.sequence >> (8 * i)) & 0xFF);
+    }
+    out.append(header, sizeof(header));
+    out.append(reinterpret_cast<const char*>(packet), length);
+}
+
+// Same envelope as the JSON format, as CBOR: self-describing, but with binary
+// numbers and no repeated quoting, so roughly half the size
+void ConnectionManager::write_stream_frame_cbor(const StreamMessage& stream_message, std::string& out) {
+    const StreamFrame& frame = stream_message.frame;
+    const mavlink_message_t& message = frame.message;
+    std::string_view name = MavlinkDecoder::instance().name(message.msgid);
+    const json envelope = {
+        {"msgName", name.empty() ? "UNKNOWN_" + std::to_string(message.msgid) : std::string(name)},
+        {"msgId", message.msgid},
+        {"timestamp", frame.receive_time_us / 1000},
+        {"system_id", message.sysid},
+        {"component_id", message.compid},
+        {"sequence", message.seq},
+        {"serverSeq", stream_message.sequence},
+        {"payload_length", message.len},
+        {"fields", decode_mavlink_message(message)}
+    };
+    json::to_cbor(envelope, out); // Appends
+}
+
 json ConnectionManager::decode_mavlink_message(const mavlink_message_t& message) {
-    json fields = json::object();
-    
-    switch (message.msgid) {
-        case MAVLINK_MSG_ID_HEARTBEAT: {
-            mavlink_heartbeat_t heartbeat;
-            mavlink_msg_heartbeat_decode(&message, &heartbeat);
-            fields = {
-                {"type", heartbeat.type},
-                {"autopilot", heartbeat.autopilot},
-                {"base_mode", heartbeat.base_mode},
-                {"custom_mode", heartbeat.custom_mode},
-                {"system_status", heartbeat.system_status},
-                {"mavlink_version", heartbeat.mavlink_version}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_GPS_RAW_INT: {
-            mavlink_gps_raw_int_t gps;
-            mavlink_msg_gps_raw_int_decode(&message, &gps);
-            fields = {
-                {"time_usec", static_cast<uint64_t>(gps.time_usec)},
-                {"fix_type", static_cast<uint8_t>(gps.fix_type)},
-                {"lat", static_cast<int32_t>(gps.lat)},
-                {"lon", static_cast<int32_t>(gps.lon)},
-                {"alt", static_cast<int32_t>(gps.alt)},
-                {"eph", static_cast<uint16_t>(gps.eph)},
-                {"epv", static_cast<uint16_t>(gps.epv)},
-                {"vel", static_cast<uint16_t>(gps.vel)},
-                {"cog", static_cast<uint16_t>(gps.cog)},
-                {"satellites_visible", static_cast<uint8_t>(gps.satellites_visible)}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_SYS_STATUS: {
-            mavlink_sys_status_t sys_status;
-            mavlink_msg_sys_status_decode(&message, &sys_status);
-            fields = {
-                {"voltage_battery", static_cast<uint16_t>(sys_status.voltage_battery)},
-                {"current_battery", static_cast<int16_t>(sys_status.current_battery)},
-                {"battery_remaining", static_cast<int8_t>(sys_status.battery_remaining)},
-                {"drop_rate_comm", static_cast<uint16_t>(sys_status.drop_rate_comm)},
-                {"errors_comm", static_cast<uint16_t>(sys_status.errors_comm)},
-                {"errors_count1", static_cast<uint16_t>(sys_status.errors_count1)},
-                {"errors_count2", static_cast<uint16_t>(sys_status.errors_count2)},
-                {"errors_count3", static_cast<uint16_t>(sys_status.errors_count3)},
-                {"errors_count4", static_cast<uint16_t>(sys_status.errors_count4)}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_ATTITUDE: {
-            mavlink_attitude_t attitude;
-            mavlink_msg_attitude_decode(&message, &attitude);
-            fields = {
-                {"time_boot_ms", attitude.time_boot_ms},
-                {"roll", attitude.roll},
-                {"pitch", attitude.pitch},
-                {"yaw", attitude.yaw},
-                {"rollspeed", attitude.rollspeed},
-                {"pitchspeed", attitude.pitchspeed},
-                {"yawspeed", attitude.yawspeed}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_LOCAL_POSITION_NED: {
-            mavlink_local_position_ned_t pos;
-            mavlink_msg_local_position_ned_decode(&message, &pos);
-            fields = {
-                {"time_boot_ms", pos.time_boot_ms},
-                {"x", pos.x},
-                {"y", pos.y},
-                {"z", pos.z},
-                {"vx", pos.vx},
-                {"vy", pos.vy},
-                {"vz", pos.vz}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: {
-            mavlink_global_position_int_t pos;
-            mavlink_msg_global_position_int_decode(&message, &pos);
-            fields = {
-                {"time_boot_ms", pos.time_boot_ms},
-                {"lat", pos.lat},
-                {"lon", pos.lon},
-                {"alt", pos.alt},
-                {"relative_alt", pos.relative_alt},
-                {"vx", pos.vx},
-                {"vy", pos.vy},
-                {"vz", pos.vz},
-                {"hdg", pos.hdg}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_VFR_HUD: {
-            mavlink_vfr_hud_t vfr_hud;
-            mavlink_msg_vfr_hud_decode(&message, &vfr_hud);
-            fields = {
-                {"airspeed", vfr_hud.airspeed},
-                {"groundspeed", vfr_hud.groundspeed},
-                {"heading", vfr_hud.heading},
-                {"throttle", vfr_hud.throttle},
-                {"alt", vfr_hud.alt},
-                {"climb", vfr_hud.climb}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_RC_CHANNELS: {
-            mavlink_rc_channels_t rc;
-            mavlink_msg_rc_channels_decode(&message, &rc);
-            fields = {
-                {"time_boot_ms", rc.time_boot_ms},
-                {"chancount", rc.chancount},
-                {"chan1_raw", rc.chan1_raw},
-                {"chan2_raw", rc.chan2_raw},
-                {"chan3_raw", rc.chan3_raw},
-                {"chan4_raw", rc.chan4_raw},
-                {"chan5_raw", rc.chan5_raw},
-                {"chan6_raw", rc.chan6_raw},
-                {"chan7_raw", rc.chan7_raw},
-                {"chan8_raw", rc.chan8_raw},
-                {"rssi", rc.rssi}
-            };
-            break;
-        }
-        case MAVLINK_MSG_ID_STATUSTEXT: {
-            mavlink_statustext_t status;
-            mavlink_msg_statustext_decode(&message, &status);
-            fields = {
-                {"severity", status.severity},
-                {"text", std::string(status.text, 50)}
-            };
-            break;
-        }
-        default:
-            // For unknown messages, just include basic info
-            fields = {
-                {"raw_payload_length", message.len}
-            };
-            break;
+    if (message.msgid == MAVLINK_MSG_ID_ADSB_VEHICLE) {
+        // The map's traffic layer consumes ADSB_VEHICLE in display units
+        // (degrees, metres, m/s) under these names; keep that shape.
+        mavlink_adsb_vehicle_t adsb;
+        mavlink_msg_adsb_vehicle_decode(&message, &adsb);
+        return {
+            {"icao_address", adsb.ICAO_address},
+            {"lat", adsb.lat / 1e7},
+            {"lon", adsb.lon / 1e7},
+            {"altitude", adsb.altitude / 1000.0}, // mm -> m
+            {"heading", adsb.heading / 100.0}, // cdeg -> deg
+            {"hor_velocity", adsb.hor_velocity / 100.0}, // cm/s -> m/s
+            {"ver_velocity", adsb.ver_velocity / 100.0}, // cm/s -> m/s
+            {"callsign", std::string(adsb.callsign, strnlen(adsb.callsign, 8))}, // char[8], NUL-padded
+            {"emitter_type", adsb.emitter_type},
+            {"tslc", adsb.tslc}, // Time since last communication
+            {"flags", adsb.flags},
+            {"squawk", adsb.squawk}
+        };
+    }
 
-        case MAVLINK_MSG_ID_ADSB_VEHICLE: {
-            mavlink_adsb_vehicle_t adsb;
-            mavlink_msg_adsb_vehicle_decode(&message, &adsb);
-            fields = {
-                {"icao_address", adsb.ICAO_address},
-                {"lat", adsb.lat / 1e7},
-                {"lon", adsb.lon / 1e7},
-                {"altitude", adsb.altitude / 1000.0}, // mm -> m
-                {"heading", adsb.heading / 100.0}, // cdeg -> deg
-                {"hor_velocity", adsb.hor_velocity / 100.0}, // cm/s -> m/s
-                {"ver_velocity", adsb.ver_velocity / 100.0}, // cm/s -> m/s
-                {"callsign", std::string(adsb.callsign, 8)}, // char[8]
-                {"emitter_type", adsb.emitter_type},
-                {"tslc", adsb.tslc}, // Time since last communication
-                {"flags", adsb.flags},
-                {"squawk", adsb.squawk}
-            };
-            break;
-        }
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    if (!decoder.known(message.msgid)) {
+        // Not in the compiled dialect; just include basic info
+        return {
+            {"raw_payload_length", message.len}
+        };
     }
-    
-    return fields;
+    return decoder.decode(message);
 }
 
 void ConnectionManager::stop_mavlink_streaming(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _streaming_active[vehicle_id] = false;
-    std::cout << "Stopped MAVLink streaming for vehicle: " << vehicle_id << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->ingest) return;
+
+    std::lock_guard<std::mutex> lock(vehicle->mutex);
+    if (vehicle->stream_subscribers == 0) return;
+    if (--vehicle->stream_subscribers > 0) {
+        LOG_DEBUG("Connection").vehicle(vehicle_id) << "MAVLink stream subscriber removed (" << vehicle->stream_subscribers << " still attached)";
+        return;
+    }
+    vehicle->streaming.store(false, std::memory_order_relaxed);
+    vehicle->stream_reader.reset();
+    LOG_INFO("Connection") << "Stopped MAVLink streaming for vehicle: " << vehicle_id;
 }
 
-std::vector<json> ConnectionManager::get_mavlink_messages(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    std::vector<json> messages;
-    
-    if (_mavlink_messages.count(vehicle_id)) {
-        auto& queue = _mavlink_messages[vehicle_id];
-        while (!queue.empty()) {
-            messages.push_back(queue.front());
-            queue.pop();
+json ConnectionManager::get_mavlink_stream_subscriptions() const {
+    json vehicles = json::object();
+    _registry.for_each([&vehicles](const std::shared_ptr<VehicleContext>& vehicle) {
+        int subscribers;
+        uint64_t ring_dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(vehicle->mutex);
+            subscribers = vehicle->stream_subscribers;
+            if (vehicle->stream_reader) ring_dropped = vehicle->stream_reader->dropped();
         }
+        vehicles[vehicle->id] = {
+            {"subscribers", subscribers},
+            // Frames overwritten before the stream reader got to them
+            {"ringDropped", ring_dropped},
+            {"passthroughSubscriptions", vehicle->ingest ? vehicle->ingest->subscription_count() : 0}
+        };
+    });
+    return vehicles;
+}
+
+ConnectionManager::StreamBatch ConnectionManager::get_mavlink_messages(const std::string& vehicle_id) {
+    StreamBatch batch;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return batch;
+    }
+
+    // Only the consumer takes the vehicle lock here; the ingest thread keeps
+    // writing into the ring regardless of how far behind we are
+    std::lock_guard<std::mutex> lock(vehicle->mutex);
+    if (!vehicle->stream_reader) {
+        return batch;
+    }
+    auto& reader = *vehicle->stream_reader;
+    const uint64_t dropped_before = reader.dropped();
+    batch._vehicle = vehicle;
+    batch._start = reader.position();
+    batch._oldest = vehicle->stream_frames.oldest();
+    batch._messages.reserve(static_cast<std::size_t>(std::min<uint64_t>(reader.pending(), vehicle->stream_frames.capacity())));
+
+    StreamBatch::Message message;
+    while (reader.next(message.frame)) {
+        // position() has moved past the frame just returned
+        message.sequence = reader.position() - 1;
+        batch._messages.push_back(message);
+    }
+
+    if (reader.dropped() != dropped_before) {
+        LOG_WARN_EVERY_MS(5000, "MAVLink").vehicle(vehicle_id)
+            << "Inspector stream fell behind, dropped " << (reader.dropped() - dropped_before)
+            << " frame(s) (total " << reader.dropped() << ", ring holds " << vehicle->stream_frames.capacity() << ")";
     }
     
-    return messages;
+    return batch;
+}
+
+ConnectionManager::StreamBatch ConnectionManager::replay_mavlink_messages(const std::string& vehicle_id, uint64_t from, uint64_t to) {
+    StreamBatch batch;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return batch;
+    }
+
+    // A private cursor; the shared live reader is not touched
+    batch._vehicle = vehicle;
+    batch._oldest = vehicle->stream_frames.oldest();
+    batch._start = std::max(from, batch._oldest);
+    FrameRing<StreamFrame>::Reader reader(vehicle->stream_frames, batch._start);
+    StreamBatch::Message message;
+    while (reader.position() < to && reader.next(message.frame)) {
+        message.sequence = reader.position() - 1;
+        if (message.sequence >= to) break;
+        batch._messages.push_back(message);
+    }
+    return batch;
+}
+
+std::shared_ptr<const std::string> ConnectionManager::StreamBatch::encode(const Message& message, StreamFormat format) const {
+    static constexpr StreamDecodeCache<StreamMessage, kStreamFormatCount>::Decoder kEncoders[kStreamFormatCount] = {
+        &ConnectionManager::write_stream_frame,         // StreamFormat::Json
+        &ConnectionManager::write_stream_frame_mavlink, // StreamFormat::MavlinkRaw
+        &ConnectionManager::write_stream_frame_cbor     // StreamFormat::Cbor
+    };
+    const auto index = static_cast<std::size_t>(format);
+    if (!_vehicle || index >= kStreamFormatCount) return nullptr;
+    return _vehicle->stream_cache.get(message.sequence, message, index, kEncoders[index]);
+}
+
+uint64_t ConnectionManager::wait_for_mavlink_messages(uint64_t epoch, std::chrono::milliseconds timeout) {
+    return _stream_notifier.wait(epoch, timeout);
+}
+
+uint64_t ConnectionManager::mavlink_message_epoch() const {
+    return _stream_notifier.epoch();
+}
+
+void ConnectionManager::shutdown_mavlink_streams() {
+    _stream_notifier.stop();
+}
+
+bool ConnectionManager::parse_stream_format(const std::string& name, StreamFormat& format) {
+    if (name == "json") {
+        format = StreamFormat::Json;
+    } else if (name == "mavlink") {
+        format = StreamFormat::MavlinkRaw;
+    } else if (name == "cbor") {
+        format = StreamFormat::Cbor;
+    } else {
+        return false;
+    }
+    return true;
 }
 
 std::string flight_mode_to_string(mavsdk::Telemetry::FlightMode mode) {
@@ -1404,14 +1435,14 @@ std::string ardupilot_custom_mode_to_string(uint8_t mav_type, uint32_t custom_mo
 
 // --- Jeremy: Add command implementations for flight control ---
 bool ConnectionManager::send_takeoff_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for takeoff command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for takeoff command";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     mavsdk::MavlinkPassthrough::CommandLong cmd;
     cmd.target_sysid = system->get_system_id();
@@ -1426,19 +1457,19 @@ bool ConnectionManager::send_takeoff_command(const std::string& vehicle_id) {
     cmd.param7 = 50.0f; // altitude
 
     auto result = passthrough->send_command_long(cmd);
-    std::cout << "Takeoff command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+    LOG_INFO("Connection") << "Takeoff command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
     return result == mavsdk::MavlinkPassthrough::Result::Success;
 }
 
 bool ConnectionManager::send_land_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for land command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for land command";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     mavsdk::MavlinkPassthrough::CommandLong cmd;
     cmd.target_sysid = system->get_system_id();
@@ -1453,19 +1484,19 @@ bool ConnectionManager::send_land_command(const std::string& vehicle_id) {
     cmd.param7 = 0.0f;
 
     auto result = passthrough->send_command_long(cmd);
-    std::cout << "Land command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+    LOG_INFO("Connection") << "Land command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
     return result == mavsdk::MavlinkPassthrough::Result::Success;
 }
 
 bool ConnectionManager::send_rtl_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for RTL command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for RTL command";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     mavsdk::MavlinkPassthrough::CommandLong cmd;
     cmd.target_sysid = system->get_system_id();
@@ -1480,19 +1511,19 @@ bool ConnectionManager::send_rtl_command(const std::string& vehicle_id) {
     cmd.param7 = 0.0f;
 
     auto result = passthrough->send_command_long(cmd);
-    std::cout << "RTL command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+    LOG_INFO("Connection") << "RTL command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
     return result == mavsdk::MavlinkPassthrough::Result::Success;
 }
 
 bool ConnectionManager::send_pause_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for pause command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for pause command";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     mavsdk::MavlinkPassthrough::CommandLong cmd;
     cmd.target_sysid = system->get_system_id();
@@ -1507,19 +1538,19 @@ bool ConnectionManager::send_pause_command(const std::string& vehicle_id) {
     cmd.param7 = 0.0f;
 
     auto result = passthrough->send_command_long(cmd);
-    std::cout << "Pause command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+    LOG_INFO("Connection") << "Pause command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
     return result == mavsdk::MavlinkPassthrough::Result::Success;
 }
 
 bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, const std::string& mode) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for set_mode command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for set_mode command";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     // Normalize mode string
     std::string upper_mode = mode;
@@ -1531,11 +1562,8 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
         if (std::find(candidates.begin(), candidates.end(), v) == candidates.end()) candidates.push_back(v);
     };
 
-    uint8_t mav_type = 0;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        mav_type = _last_mav_type[vehicle_id];
-    }
+    const HeartbeatState heartbeat = vehicle->last_heartbeat();
+    uint8_t mav_type = heartbeat.mav_type;
 
     // Heuristic override: choose stack by requested mode token to avoid misclassification
     auto in_set = [&](const std::initializer_list<const char*> names) {
@@ -1652,22 +1680,21 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
     }
 
     if (candidates.empty()) {
-        std::cerr << "Unknown mode: " << mode << std::endl;
+        LOG_ERROR("Connection") << "Unknown mode: " << mode;
         return false;
     }
 
-    std::cout << "[MODE] Requested mode='" << mode << "' (normalized='" << upper_mode << "')" << std::endl;
-    std::cout << "[MODE] Candidate custom_mode values: ";
-    for (size_t i = 0; i < candidates.size(); ++i) {
-        std::cout << candidates[i] << (i + 1 < candidates.size() ? ", " : "\n");
+    LOG_INFO("Mode").vehicle(vehicle_id) << "Requested mode='" << mode << "' (normalized='" << upper_mode << "')";
+    {
+        LogLine line(LogLevel::Info, "Mode");
+        line.vehicle(vehicle_id) << "Candidate custom_mode values: ";
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            line << candidates[i] << (i + 1 < candidates.size() ? ", " : "");
+        }
     }
 
     bool any_sent_success = false;
-    uint8_t current_base_mode = 0;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        current_base_mode = _last_base_mode[vehicle_id];
-    }
+    uint8_t current_base_mode = heartbeat.base_mode;
     // Preserve existing base mode bits like QGC does, but ensure CUSTOM_MODE is enabled
     uint8_t preserved_base_mode = (current_base_mode & ~MAV_MODE_FLAG_DECODE_POSITION_CUSTOM_MODE) | MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
     for (uint32_t custom_mode : candidates) {
@@ -1686,17 +1713,17 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
 
         auto res_cmd = passthrough->send_command_long(cmd);
         any_sent_success = any_sent_success || (res_cmd == mavsdk::MavlinkPassthrough::Result::Success);
-        std::cout << "DO_SET_MODE sent (custom_mode=" << custom_mode << ") result="
-                  << (res_cmd == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+        LOG_INFO("Connection") << "DO_SET_MODE sent (custom_mode=" << custom_mode << ") result="
+                  << (res_cmd == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
 
         // Wait for ACK; if not accepted, fallback once to SET_MODE
         bool ack_ok_local = false;
         {
-            std::unique_lock<std::mutex> lock(_mutex);
-            _ack_cv.wait_for(lock, std::chrono::milliseconds(1500), [&]{
-                return _last_ack_command[vehicle_id] == MAV_CMD_DO_SET_MODE; 
+            std::unique_lock<std::mutex> lock(vehicle->mutex);
+            vehicle->ack_cv.wait_for(lock, std::chrono::milliseconds(1500), [&]{
+                return vehicle->last_ack_command == MAV_CMD_DO_SET_MODE; 
             });
-            if (_last_ack_command[vehicle_id] == MAV_CMD_DO_SET_MODE && _last_ack_result[vehicle_id] == MAV_RESULT_ACCEPTED) {
+            if (vehicle->last_ack_command == MAV_CMD_DO_SET_MODE && vehicle->last_ack_result == MAV_RESULT_ACCEPTED) {
                 ack_ok_local = true;
             }
         }
@@ -1716,8 +1743,8 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
                 return set_mode_msg;
             });
             any_sent_success = any_sent_success || (res_set == mavsdk::MavlinkPassthrough::Result::Success);
-            std::cout << "SET_MODE fallback sent (custom_mode=" << custom_mode << ") result="
-                      << (res_set == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+            LOG_INFO("Connection") << "SET_MODE fallback sent (custom_mode=" << custom_mode << ") result="
+                      << (res_set == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
         }
         // Only attempt first mapping
         break;
@@ -1727,11 +1754,11 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
     // Re-check final ACK status after possible fallback
     bool ack_ok = false;
     {
-        std::unique_lock<std::mutex> lock(_mutex);
-        _ack_cv.wait_for(lock, std::chrono::milliseconds(500), [&]{
-            return _last_ack_command[vehicle_id] == MAV_CMD_DO_SET_MODE; 
+        std::unique_lock<std::mutex> lock(vehicle->mutex);
+        vehicle->ack_cv.wait_for(lock, std::chrono::milliseconds(500), [&]{
+            return vehicle->last_ack_command == MAV_CMD_DO_SET_MODE; 
         });
-        if (_last_ack_command[vehicle_id] == MAV_CMD_DO_SET_MODE && _last_ack_result[vehicle_id] == MAV_RESULT_ACCEPTED) {
+        if (vehicle->last_ack_command == MAV_CMD_DO_SET_MODE && vehicle->last_ack_result == MAV_RESULT_ACCEPTED) {
             ack_ok = true;
         }
     }
@@ -1739,43 +1766,37 @@ bool ConnectionManager::send_set_mode_command(const std::string& vehicle_id, con
 }
 
 bool ConnectionManager::send_arm_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    std::cout << "[DEBUG] send_arm_command called for vehicle: " << vehicle_id << std::endl;
+    LOG_DEBUG("Connection") << "send_arm_command called for vehicle: " << vehicle_id;
     
     // SWE100821: Add additional safety checks
     if (vehicle_id.empty()) {
-        std::cerr << "ERROR: Empty vehicle_id in send_arm_command" << std::endl;
+        LOG_ERROR("Connection") << "Empty vehicle_id in send_arm_command";
         return false;
     }
     
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for arm command" << std::endl;
-        return false;
-    }
-    
-    if (!_systems.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " system not found for arm command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for arm command";
         return false;
     }
     
     try {
-        auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-        auto system = _systems[vehicle_id];
+        auto passthrough = vehicle->passthrough;
+        auto system = vehicle->system;
         
         if (!passthrough) {
-            std::cerr << "ERROR: Null passthrough plugin for vehicle " << vehicle_id << std::endl;
+            LOG_ERROR("Connection") << "Null passthrough plugin for vehicle " << vehicle_id;
             return false;
         }
         
         if (!system) {
-            std::cerr << "ERROR: Null system for vehicle " << vehicle_id << std::endl;
+            LOG_ERROR("Connection") << "Null system for vehicle " << vehicle_id;
             return false;
         }
         
-        std::cout << "[DEBUG] Creating MAVLink arm command for vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "Creating MAVLink arm command for vehicle " << vehicle_id;
         
-        std::cout << "[DEBUG] Creating MAVLink arm command for vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "Creating MAVLink arm command for vehicle " << vehicle_id;
         
         mavsdk::MavlinkPassthrough::CommandLong cmd;
         cmd.target_sysid = system->get_system_id();
@@ -1789,58 +1810,52 @@ bool ConnectionManager::send_arm_command(const std::string& vehicle_id) {
         cmd.param6 = 0.0f;
         cmd.param7 = 0.0f;
 
-        std::cout << "[DEBUG] Sending MAVLink arm command to vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "Sending MAVLink arm command to vehicle " << vehicle_id;
         auto result = passthrough->send_command_long(cmd);
-        std::cout << "Arm command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+        LOG_INFO("Connection") << "Arm command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
         
-        std::cout << "[DEBUG] send_arm_command completed successfully for vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "send_arm_command completed successfully for vehicle " << vehicle_id;
         return result == mavsdk::MavlinkPassthrough::Result::Success;
         
     } catch (const std::exception& e) {
-        std::cerr << "EXCEPTION in send_arm_command for vehicle " << vehicle_id << ": " << e.what() << std::endl;
+        LOG_ERROR("Connection") << "EXCEPTION in send_arm_command for vehicle " << vehicle_id << ": " << e.what();
         return false;
     } catch (...) {
-        std::cerr << "UNKNOWN EXCEPTION in send_arm_command for vehicle " << vehicle_id << std::endl;
+        LOG_ERROR("Connection") << "UNKNOWN EXCEPTION in send_arm_command for vehicle " << vehicle_id;
         return false;
     }
 }
 
 bool ConnectionManager::send_disarm_command(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    std::cout << "[DEBUG] send_disarm_command called for vehicle: " << vehicle_id << std::endl;
+    LOG_DEBUG("Connection") << "send_disarm_command called for vehicle: " << vehicle_id;
     
     // SWE100821: Add additional safety checks
     if (vehicle_id.empty()) {
-        std::cerr << "ERROR: Empty vehicle_id in send_disarm_command" << std::endl;
+        LOG_ERROR("Connection") << "Empty vehicle_id in send_disarm_command";
         return false;
     }
     
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for disarm command" << std::endl;
-        return false;
-    }
-    
-    if (!_systems.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " system not found for disarm command" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for disarm command";
         return false;
     }
     
     try {
-        auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-        auto system = _systems[vehicle_id];
+        auto passthrough = vehicle->passthrough;
+        auto system = vehicle->system;
         
         if (!passthrough) {
-            std::cerr << "ERROR: Null passthrough plugin for vehicle " << vehicle_id << std::endl;
+            LOG_ERROR("Connection") << "Null passthrough plugin for vehicle " << vehicle_id;
             return false;
         }
         
         if (!system) {
-            std::cerr << "ERROR: Null system for vehicle " << vehicle_id << std::endl;
+            LOG_ERROR("Connection") << "Null system for vehicle " << vehicle_id;
             return false;
         }
         
-        std::cout << "[DEBUG] Creating MAVLink disarm command for vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "Creating MAVLink disarm command for vehicle " << vehicle_id;
         
         mavsdk::MavlinkPassthrough::CommandLong command;
         command.target_sysid = system->get_system_id();
@@ -1854,31 +1869,31 @@ bool ConnectionManager::send_disarm_command(const std::string& vehicle_id) {
         command.param6 = 0.0f;
         command.param7 = 0.0f;
 
-        std::cout << "[DEBUG] Sending MAVLink disarm command to vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "Sending MAVLink disarm command to vehicle " << vehicle_id;
         auto result = passthrough->send_command_long(command);
-        std::cout << "Disarm command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+        LOG_INFO("Connection") << "Disarm command sent to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
         
-        std::cout << "[DEBUG] send_disarm_command completed successfully for vehicle " << vehicle_id << std::endl;
+        LOG_DEBUG("Connection") << "send_disarm_command completed successfully for vehicle " << vehicle_id;
         return result == mavsdk::MavlinkPassthrough::Result::Success;
         
     } catch (const std::exception& e) {
-        std::cerr << "EXCEPTION in send_disarm_command for vehicle " << vehicle_id << ": " << e.what() << std::endl;
+        LOG_ERROR("Connection") << "EXCEPTION in send_disarm_command for vehicle " << vehicle_id << ": " << e.what();
         return false;
     } catch (...) {
-        std::cerr << "UNKNOWN EXCEPTION in send_disarm_command for vehicle " << vehicle_id << std::endl;
+        LOG_ERROR("Connection") << "UNKNOWN EXCEPTION in send_disarm_command for vehicle " << vehicle_id;
         return false;
     }
 }
 
 std::string ConnectionManager::get_flight_modes(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_systems.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for flight modes" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for flight modes";
         return json{{"success", false}, {"error", "Vehicle not found"}}.dump();
     }
 
     // Return mode list based on MAV type similar to QGC FirmwarePlugin
-    uint8_t mav_type = _last_mav_type[vehicle_id];
+    uint8_t mav_type = vehicle->last_heartbeat().mav_type;
     std::vector<std::string> flight_modes;
     switch (mav_type) {
         case MAV_TYPE_QUADROTOR:
@@ -1927,15 +1942,15 @@ std::string ConnectionManager::get_flight_modes(const std::string& vehicle_id) {
         {"flightModes", flight_modes}
     };
     
-    std::cout << "Flight modes for " << vehicle_id << ": " << result.dump() << std::endl;
+    LOG_INFO("Connection") << "Flight modes for " << vehicle_id << ": " << result.dump();
     return result.dump();
 }
 // --- End Jeremy patch for command implementations ---
 
 // --- Jeremy: Add parameter management implementations ---
 std::string ConnectionManager::get_all_parameters(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
         return json{{"success", false}, {"error", "Vehicle not found"}}.dump();
     }
     
@@ -1980,14 +1995,14 @@ std::string ConnectionManager::get_all_parameters(const std::string& vehicle_id)
 }
 
 bool ConnectionManager::set_parameter(const std::string& vehicle_id, const std::string& name, double value) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for parameter set" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for parameter set";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     // Send PARAM_SET message
     // Send PARAM_SET message
@@ -2012,21 +2027,21 @@ bool ConnectionManager::set_parameter(const std::string& vehicle_id, const std::
         return msg;
     });
 
-    std::cout << "Parameter set " << name << " = " << value << " to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED") << std::endl;
+    LOG_INFO("Connection") << "Parameter set " << name << " = " << value << " to " << vehicle_id << ": " << (result == mavsdk::MavlinkPassthrough::Result::Success ? "SUCCESS" : "FAILED");
     return result == mavsdk::MavlinkPassthrough::Result::Success;
 }
 // --- End Jeremy patch for parameter implementations ---
 
 // --- Jeremy: Add MAVLink message sending implementation ---
 bool ConnectionManager::send_mavlink_message(const std::string& vehicle_id, const std::string& message_type, const json& parameters) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) {
-        std::cerr << "Vehicle " << vehicle_id << " not found for MAVLink message" << std::endl;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for MAVLink message";
         return false;
     }
     
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
     
     bool success = false;
     try {
@@ -2150,13 +2165,13 @@ bool ConnectionManager::send_mavlink_message(const std::string& vehicle_id, cons
 
         success = (result == mavsdk::MavlinkPassthrough::Result::Success);
         if (success) {
-             std::cout << "MAVLink message " << message_type << " sent to " << vehicle_id << " SUCCESS" << std::endl;
+             LOG_INFO("Connection") << "MAVLink message " << message_type << " sent to " << vehicle_id << " SUCCESS";
         } else {
-             std::cerr << "MAVLink message " << message_type << " sent to " << vehicle_id << " FAILED (Supported?)" << std::endl;
+             LOG_ERROR("Connection") << "MAVLink message " << message_type << " sent to " << vehicle_id << " FAILED (Supported?)";
         }
 
     } catch (const std::exception& e) {
-        std::cerr << "Error sending MAVLink message: " << e.what() << std::endl;
+        LOG_ERROR("Connection") << "Error sending MAVLink message: " << e.what();
         success = false;
     }
     
@@ -2166,11 +2181,12 @@ bool ConnectionManager::send_mavlink_message(const std::string& vehicle_id, cons
 // --- Compass Calibration Implementation ---
 
 bool ConnectionManager::start_compass_calibration(const std::string& vehicle_id) {
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) return false;
 
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        CalibrationStatus& status = _calibration_status[vehicle_id];
+        std::lock_guard<std::mutex> lock(vehicle->mutex);
+        CalibrationStatus& status = vehicle->calibration.emplace();
         status.active = true;
         status.progress = 0;
         status.status_text = "Starting calibration...";
@@ -2188,7 +2204,7 @@ bool ConnectionManager::start_compass_calibration(const std::string& vehicle_id)
     // 5: Autoreboot (1=yes)
     
     mavsdk::MavlinkPassthrough::CommandLong command;
-    command.target_sysid = _systems[vehicle_id]->get_system_id();
+    command.target_sysid = vehicle->system->get_system_id();
     command.target_compid = 0;
     command.command = 4242; // MAV_CMD_DO_START_MAG_CAL
     command.param1 = 0; // Calibration all
@@ -2199,22 +2215,24 @@ bool ConnectionManager::start_compass_calibration(const std::string& vehicle_id)
     command.param6 = 0;
     command.param7 = 0;
 
-    _mavlink_passthrough_plugins[vehicle_id]->send_command_long(command);
+    vehicle->passthrough->send_command_long(command);
     return true;
 }
 
 bool ConnectionManager::cancel_compass_calibration(const std::string& vehicle_id) {
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) return false;
 
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _calibration_status[vehicle_id].active = false;
-        _calibration_status[vehicle_id].status_text = "Cancelled";
+        std::lock_guard<std::mutex> lock(vehicle->mutex);
+        CalibrationStatus& status = vehicle->calibration ? *vehicle->calibration : vehicle->calibration.emplace();
+        status.active = false;
+        status.status_text = "Cancelled";
     }
 
     // MAV_CMD_DO_CANCEL_MAG_CAL = 4243
     mavsdk::MavlinkPassthrough::CommandLong command;
-    command.target_sysid = _systems[vehicle_id]->get_system_id();
+    command.target_sysid = vehicle->system->get_system_id();
     command.target_compid = 0;
     command.command = 4243; // MAV_CMD_DO_CANCEL_MAG_CAL
     command.param1 = 0;
@@ -2225,17 +2243,22 @@ bool ConnectionManager::cancel_compass_calibration(const std::string& vehicle_id
     command.param6 = 0;
     command.param7 = 0;
 
-    _mavlink_passthrough_plugins[vehicle_id]->send_command_long(command);
+    vehicle->passthrough->send_command_long(command);
     return true;
 }
 
 std::string ConnectionManager::get_calibration_status(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (!_calibration_status.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        return json{{"active", false}}.dump();
+    }
+
+    std::lock_guard<std::mutex> lock(vehicle->mutex);
+    if (!vehicle->calibration) {
         return json{{"active", false}}.dump();
     }
     
-    const auto& status = _calibration_status[vehicle_id];
+    const auto& status = *vehicle->calibration;
     return json{
         {"active", status.active},
         {"progress", status.progress},
@@ -2245,11 +2268,12 @@ std::string ConnectionManager::get_calibration_status(const std::string& vehicle
 }
 
 bool ConnectionManager::start_accelerometer_calibration(const std::string& vehicle_id) {
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) return false;
 
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        CalibrationStatus& status = _calibration_status[vehicle_id];
+        std::lock_guard<std::mutex> lock(vehicle->mutex);
+        CalibrationStatus& status = vehicle->calibration.emplace();
         status.active = true;
         status.progress = 0;
         status.status_text = "Waiting for vehicle to start calibration...";
@@ -2260,7 +2284,7 @@ bool ConnectionManager::start_accelerometer_calibration(const std::string& vehic
 
     // MAV_CMD_PREFLIGHT_CALIBRATION = 241
     mavsdk::MavlinkPassthrough::CommandLong command;
-    command.target_sysid = _systems[vehicle_id]->get_system_id();
+    command.target_sysid = vehicle->system->get_system_id();
     command.target_compid = 0;
     command.command = 241; // MAV_CMD_PREFLIGHT_CALIBRATION
     command.param1 = 0;
@@ -2271,17 +2295,19 @@ bool ConnectionManager::start_accelerometer_calibration(const std::string& vehic
     command.param6 = 0;
     command.param7 = 0;
 
-    _mavlink_passthrough_plugins[vehicle_id]->send_command_long(command);
+    vehicle->passthrough->send_command_long(command);
     return true;
 }
 
 bool ConnectionManager::cancel_accelerometer_calibration(const std::string& vehicle_id) {
-    if (!_mavlink_passthrough_plugins.count(vehicle_id)) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) return false;
 
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _calibration_status[vehicle_id].active = false;
-        _calibration_status[vehicle_id].status_text = "Cancelled";
+        std::lock_guard<std::mutex> lock(vehicle->mutex);
+        CalibrationStatus& status = vehicle->calibration ? *vehicle->calibration : vehicle->calibration.emplace();
+        status.active = false;
+        status.status_text = "Cancelled";
     }
 
     // No specific cancel command for accel, usually requires reboot or just ignoring.
@@ -2290,14 +2316,13 @@ bool ConnectionManager::cancel_accelerometer_calibration(const std::string& vehi
 }
 // Motor Test
 bool ConnectionManager::send_motor_test(const std::string& vehicle_id, int motor_index, int throttle_pct, int timeout_sec) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    if (!_systems.count(vehicle_id) || !_mavlink_passthrough_plugins.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
         return false;
     }
 
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
 
     // MAV_CMD_DO_MOTOR_TEST
     // Param 1: Motor instance number (1-based)
@@ -2320,8 +2345,8 @@ bool ConnectionManager::send_motor_test(const std::string& vehicle_id, int motor
     command.param6 = 0.0f; // MOTOR_TEST_ORDER_DEFAULT
     command.param7 = 0.0f;
 
-    std::cout << "[ConnectionManager] Sending Motor Test: Motor=" << motor_index 
-              << " Throttle=" << throttle_pct << "% Timeout=" << timeout_sec << "s" << std::endl;
+    LOG_INFO("Connection") << "Sending Motor Test: Motor=" << motor_index 
+              << " Throttle=" << throttle_pct << "% Timeout=" << timeout_sec << "s";
 
     auto result = passthrough->send_command_long(command);
     return result == mavsdk::MavlinkPassthrough::Result::Success;
@@ -2335,14 +2360,13 @@ bool ConnectionManager::send_manual_control(const std::string& vehicle_id, float
     // r: Yaw -1 to 1
     
     // We don't need full lock for just sending a message usually, but for consistency
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    if (!_systems.count(vehicle_id) || !_mavlink_passthrough_plugins.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
         return false;
     }
 
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
 
     // MANUAL_CONTROL message (ID 69)
     // Scale inputs to -1000 to +1000 range for x,y,r. z is 0-1000.
@@ -2383,12 +2407,13 @@ bool ConnectionManager::send_manual_control(const std::string& vehicle_id, float
 
 // Follow Me
 bool ConnectionManager::send_follow_target(const std::string& vehicle_id, double lat, double lon, float alt, float vn, float ve, float vd) {
-    if (!_systems.count(vehicle_id) || !_mavlink_passthrough_plugins.count(vehicle_id)) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->passthrough) {
         return false;
     }
 
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
-    auto system = _systems[vehicle_id];
+    auto passthrough = vehicle->passthrough;
+    auto system = vehicle->system;
 
     mavlink_message_t msg;
     mavlink_follow_target_t follow_target;
@@ -2442,25 +2467,25 @@ bool ConnectionManager::send_follow_target(const std::string& vehicle_id, double
 }
 
 std::shared_ptr<mavsdk::System> ConnectionManager::get_system_ptr(const std::string& vehicle_id) {
-    std::lock_guard<std::mutex> lock(_mutex);
     if (vehicle_id.empty()) {
         // Return first available system if no ID provided
-        if (!_systems.empty()) {
-            return _systems.begin()->second;
+        auto table = _registry.snapshot();
+        for (const auto& vehicle : table->by_handle) {
+            if (vehicle) return vehicle->system;
         }
         return nullptr;
     }
     
-    auto it = _systems.find(vehicle_id);
-    if (it != _systems.end()) {
-        return it->second;
+    auto vehicle = _registry.find(vehicle_id);
+    if (vehicle) {
+        return vehicle->system;
     }
     return nullptr;
 }
 
 bool ConnectionManager::upload_geofence(const std::string& vehicle_id, const std::vector<std::pair<double, double>>& points) {
-    auto it = _geofence_plugins.find(vehicle_id);
-    if (it == _geofence_plugins.end()) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->geofence) return false;
 
     mavsdk::Geofence::Polygon polygon;
     polygon.fence_type = mavsdk::Geofence::FenceType::Inclusion; // Default to Inclusion
@@ -2474,36 +2499,37 @@ bool ConnectionManager::upload_geofence(const std::string& vehicle_id, const std
     mavsdk::Geofence::GeofenceData data;
     data.polygons.push_back(polygon);
 
-    std::cout << "Uploading geofence with " << points.size() << " points to " << vehicle_id << "..." << std::endl;
-    auto result = it->second->upload_geofence(data);
+    LOG_INFO("Connection") << "Uploading geofence with " << points.size() << " points to " << vehicle_id << "...";
+    auto result = vehicle->geofence->upload_geofence(data);
     if (result != mavsdk::Geofence::Result::Success) {
-        std::cerr << "Geofence upload failed: " << result << std::endl;
+        LOG_ERROR("Connection") << "Geofence upload failed: " << result;
         return false;
     }
     return true;
 }
 
 bool ConnectionManager::clear_geofence(const std::string& vehicle_id) {
-    auto it = _geofence_plugins.find(vehicle_id);
-    if (it == _geofence_plugins.end()) return false;
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle || !vehicle->geofence) return false;
 
-    auto result = it->second->clear_geofence();
+    auto result = vehicle->geofence->clear_geofence();
     if (result != mavsdk::Geofence::Result::Success) {
-        std::cerr << "Geofence clear failed: " << result << std::endl;
+        LOG_ERROR("Connection") << "Geofence clear failed: " << result;
         return false;
     }
-    std::cout << "Geofence cleared for " << vehicle_id << std::endl;
+    LOG_INFO("Connection") << "Geofence cleared for " << vehicle_id;
     return true;
 }
 
 bool ConnectionManager::upload_rally_points(const std::string& vehicle_id, const std::vector<std::tuple<double, double, float>>& points) {
-    auto passthrough = _mavlink_passthrough_plugins[vehicle_id];
+    auto vehicle = _registry.find(vehicle_id);
+    auto passthrough = vehicle ? vehicle->passthrough : nullptr;
     if (!passthrough) {
-        std::cerr << "No passthrough for " << vehicle_id << std::endl;
+        LOG_ERROR("Connection") << "No passthrough for " << vehicle_id;
         return false;
     }
 
-    uint8_t target_sysid = _systems[vehicle_id]->get_system_id();
+    uint8_t target_sysid = vehicle->system->get_system_id();
     uint8_t target_compid = 0; // Assuming autopilot component
     uint8_t my_sysid = 255; // GCS system ID
     uint8_t my_compid = 1; // GCS component ID
@@ -2548,92 +2574,72 @@ bool ConnectionManager::upload_rally_points(const std::string& vehicle_id, const
         
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
-    std::cout << "Uploaded " << (int)count << " rally points to " << vehicle_id << std::endl;
+    LOG_INFO("Connection") << "Uploaded " << (int)count << " rally points to " << vehicle_id;
     return true;
 }
 
 // --- Radio Simulation Implementation ---
 
 void ConnectionManager::set_radio_simulation(const std::string& vehicle_id, bool enabled, double freq, double tx_pwr, double tx_gain, double rx_gain) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _radio_sim_params[vehicle_id] = {enabled, freq, tx_pwr, tx_gain, rx_gain, -100.0};
-    std::cout << "Radio Simulation for " << vehicle_id << ": " << (enabled ? "ENABLED" : "DISABLED") << std::endl;
-}
-
-void ConnectionManager::update_radio_simulation(const std::string& vehicle_id) {
-    // Note: _mutex should NOT be locked when calling this private method if it locks internally?
-    // Wait, get_telemetry_data_json locks _mutex. calling this would deadlock if we lock again.
-    // We should assume the caller holds the lock OR use recursive mutex.
-    // Current _mutex is standard mutex.
-    // BUT get_telemetry_data_json holds the lock.
-    // So this function must NOT lock _mutex again.
-    
-    if (!_radio_sim_params.count(vehicle_id) || !_radio_sim_params[vehicle_id].enabled) {
+    auto vehicle = _registry.find(vehicle_id);
+    if (!vehicle) {
+        LOG_WARN("Connection") << "Vehicle " << vehicle_id << " not found for radio simulation";
         return;
     }
+    {
+        std::lock_guard<std::mutex> lock(vehicle->mutex);
+        vehicle->radio_sim = {enabled, freq, tx_pwr, tx_gain, rx_gain, -100.0};
+        vehicle->radio_sim_enabled.store(enabled, std::memory_order_relaxed);
+    }
+    LOG_INFO("Connection") << "Radio Simulation for " << vehicle_id << ": " << (enabled ? "ENABLED" : "DISABLED");
+}
 
-    auto& params = _radio_sim_params[vehicle_id];
-    
-    // Get positions to calc distance
-    // We need telemetry plugin (already have access in get_telemetry_data_json scope, but not here easily without passing it)
-    // Let's rely on cached or accessed data.
-    // Actually, getting telemetry plugin again is safe?
-    
-    if (!_telemetry_plugins.count(vehicle_id)) return;
-    auto telemetry = _telemetry_plugins[vehicle_id];
-    
-    auto position = telemetry->position(); // e.g. relative_altitude_m, latitude_deg, longitude_deg
-    auto home = telemetry->home(); // latitude_deg, longitude_deg
-    
-    // Simple distance calculation (Haversine or flat earth for short range)
-    // 1 deg lat ~ 111132m
-    double lat1 = position.latitude_deg;
-    double lon1 = position.longitude_deg;
-    double lat2 = home.latitude_deg;
-    double lon2 = home.longitude_deg;
-    
-    if (std::isnan(lat1) || std::isnan(lat2)) return; // No fix
-
-    double R = 6371e3; // metres
-    double phi1 = lat1 * M_PI/180;
-    double phi2 = lat2 * M_PI/180;
-    double dphi = (lat2-lat1) * M_PI/180;
-    double dlam = (lon2-lon1) * M_PI/180;
-
-    double a = sin(dphi/2) * sin(dphi/2) +
-               cos(phi1) * cos(phi2) *
-               sin(dlam/2) * sin(dlam/2);
-    double c = 2 * atan2(sqrt(a), sqrt(1-a));
-    double dist_m = R * c;
-
-    // FSPL = 20log(d) + 20log(f) + 32.44 + ... 
-    // FSPL(dB) = 20*log10(d_km) + 20*log10(f_MHz) + 32.44
-    
-    double dist_km = std::max(0.001, dist_m / 1000.0);
-    double fspl = 20 * log10(dist_km) + 20 * log10(params.frequency_mhz) + 32.44;
-    
-    double rssi = params.tx_power_dbm + params.tx_gain_dbi + params.rx_gain_dbi - fspl;
-    
-    // Clamp RSSI
-    if (rssi > 0) rssi = 0;
-    if (rssi < -120) rssi = -120; // Noise floor
-    
-    // Update radio status
-    // Signal: RSSI
-    // Noise: -100
+void ConnectionManager::update_radio_simulation() {
+    // Gather every enabled link into the batch. The vehicle lock is held only
+    // to copy its params; positions come from the telemetry snapshot.
+    _radio_batch.clear();
+    _radio_vehicles.clear();
+    _radio_noise_dbm.clear();
+    _registry.for_each([this](const std::shared_ptr<VehicleContext>& vehicle) {
+        RadioSimulationParams params;
+        {
+            std::lock_guard<std::mutex> lock(vehicle->mutex);
+            if (!vehicle->radio_sim.enabled) return;
+            params = vehicle->radio_sim;
+        }
+        const TelemetrySnapshot snapshot = vehicle->snapshot.load();
+        const auto& position = snapshot.position;
+        const auto& home = snapshot.home;
+        if (std::isnan(position.latitude_deg) || std::isnan(home.latitude_deg)) return; // No fix
+
+        _radio_batch.add(position.latitude_deg, position.longitude_deg, home.latitude_deg, home.longitude_deg,
+                         params.frequency_mhz, params.tx_power_dbm + params.tx_gain_dbi + params.rx_gain_dbi);
+        _radio_vehicles.push_back(vehicle);
+        _radio_noise_dbm.push_back(params.noise_floor_dbm);
+    });
+    if (_radio_vehicles.empty()) return;
+
+    _radio_batch.compute();
+
+    // Publish; readers pick the result up from the snapshot.
     // RemRSSI: Assume symmetric for sim
-    
-    _radio_status[vehicle_id] = {
-        (int)rssi,
-        (int)rssi, // remote rssi
-        (int)params.noise_floor_dbm, // noise
-        (int)params.noise_floor_dbm, // remnoise
-        100, // txbuf
-        0,   // rxerrors
-        0    // fixed
-    };
-    
-    // Debug print occasionally?
-    // std::cout << "Simulated RSSI: " << rssi << " dBm (Dist: " << dist_m << "m)" << std::endl;
+    const auto& rssi = _radio_batch.rssi_dbm();
+    for (std::size_t i = 0; i < _radio_vehicles.size(); ++i) {
+        const int link_rssi = static_cast<int>(rssi[i]);
+        const int noise = static_cast<int>(_radio_noise_dbm[i]);
+        _radio_vehicles[i]->history.record(history_now_ms(), {{HistoryChannel::Rssi, static_cast<float>(link_rssi)}});
+        _radio_vehicles[i]->snapshot.update([&](TelemetrySnapshot& s) {
+            s.radio = {
+                link_rssi,
+                link_rssi, // remote rssi
+                noise,     // noise
+                noise,     // remnoise
+                100,       // txbuf
+                0,         // rxerrors
+                0          // fixed
+            };
+        });
+    }
+    _radio_vehicles.clear(); // Don't keep removed vehicles alive until the next tick
 }
 
@@ -0,0 +1,100 @@
+#include "field_projection.hpp"
+#include <cassert>
+
+FieldSchemaBase::FieldSchemaBase(std::vector<Leaf> leaves) : _leaves(std::move(leaves)) {
+    _all = build(std::vector<bool>(_leaves.size(), true));
+}
+
+std::shared_ptr<const FieldProjection> FieldSchemaBase::compile(std::string_view selection, std::string& error) const {
+    const std::string key(selection);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cache.find(key);
+        if (it != _cache.end()) return it->second;
+    }
+
+    std::vector<bool> selected(_leaves.size(), false);
+    bool any = false;
+    while (!selection.empty()) {
+        const std::size_t comma = selection.find(',');
+        std::string_view path = selection.substr(0, comma);
+        selection = comma == std::string_view::npos ? std::string_view() : selection.substr(comma + 1);
+        while (!path.empty() && path.front() == ' ') path.remove_prefix(1);
+        while (!path.empty() && path.back() == ' ') path.remove_suffix(1);
+        if (path.empty()) continue;
+
+        // A path names a leaf, or an object and everything under it
+        bool matched = false;
+        for (std::size_t i = 0; i < _leaves.size(); ++i) {
+            const std::string_view leaf = _leaves[i].path;
+            if (leaf == path || (leaf.size() > path.size() && leaf.substr(0, path.size()) == path && leaf[path.size()] == '.')) {
+                selected[i] = true;
+                matched = true;
+            }
+        }
+        if (!matched) {
+            error = "unknown field: " + std::string(path);
+            return nullptr;
+        }
+        any = true;
+    }
+    if (!any) {
+        return _all;
+    }
+    for (std::size_t i = 0; i < _leaves.size(); ++i) {
+        if (_leaves[i].always) selected[i] = true;
+    }
+
+    std::shared_ptr<const FieldProjection> projection = build(selected);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_cache.size() < kMaxCachedProjections) {
+        // Another thread may have compiled the same selection meanwhile; keep the first
+        return _cache.emplace(key, std::move(projection)).first->second;
+    }
+    return projection;
+}
+
+std::size_t FieldSchemaBase::cached_projections() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cache.size();
+}
+
+void FieldSchemaBase::check_owner(const FieldProjection& projection) const {
+    assert(projection._schema == this && "projection compiled against another schema");
+    (void)projection;
+}
+
+std::shared_ptr<FieldProjection> FieldSchemaBase::build(const std::vector<bool>& selected) const {
+    auto projection = std::make_shared<FieldProjection>();
+    projection->_schema = this;
+    auto& ops = projection->_ops;
+
+    // Objects currently open, as path segments
+    std::vector<std::string_view> open;
+    for (std::size_t i = 0; i < _leaves.size(); ++i) {
+        if (!selected[i]) continue;
+
+        std::vector<std::string_view> segments;
+        std::string_view rest = _leaves[i].path;
+        for (std::size_t dot; (dot = rest.find('.')) != std::string_view::npos; rest.remove_prefix(dot + 1)) {
+            segments.push_back(rest.substr(0, dot));
+        }
+
+        // Close what this leaf is not under, open what it is
+        std::size_t common = 0;
+        while (common < open.size() && common < segments.size() && open[common] == segments[common]) ++common;
+        for (std::size_t depth = open.size(); depth > common; --depth) {
+            ops.push_back({FieldProjection::Op::Kind::Close, {}, 0});
+        }
+        open.resize(common);
+        for (std::size_t depth = common; depth < segments.size(); ++depth) {
+            ops.push_back({FieldProjection::Op::Kind::Open, segments[depth], 0});
+            open.push_back(segments[depth]);
+        }
+        ops.push_back({FieldProjection::Op::Kind::Leaf, rest, static_cast<uint16_t>(i)});
+    }
+    for (std::size_t depth = open.size(); depth > 0; --depth) {
+        ops.push_back({FieldProjection::Op::Kind::Close, {}, 0});
+    }
+    return projection;
+}
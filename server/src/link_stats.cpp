@@ -0,0 +1,87 @@
+#include "link_stats.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// EWMA weights per message: the interval and size settle within a few
+// dozen packets; jitter uses the RFC 3550 gain
+constexpr float kIntervalGain = 1.0f / 8.0f;
+constexpr float kSizeGain = 1.0f / 8.0f;
+constexpr float kJitterGain = 1.0f / 16.0f;
+
+// Packet length as mavlink_msg_to_send_buffer() would write it
+uint32_t wire_length(const mavlink_message_t& message) {
+    if (message.magic == MAVLINK_STX_MAVLINK1) return message.len + 8u; // 6 header + 2 crc
+    uint32_t length = message.len + 12u; // 10 header + 2 crc
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    return length;
+}
+
+} // namespace
+
+void LinkStats::track(uint32_t msgid) {
+    if (msgid <= MsgIdTable<Entry>::kMaxMsgId) _entries[msgid];
+}
+
+void LinkStats::set_requested_interval(uint32_t msgid, int64_t interval_us) {
+    if (msgid <= MsgIdTable<Entry>::kMaxMsgId) _entries[msgid].requested_interval_us = interval_us;
+}
+
+void LinkStats::record(const mavlink_message_t& message, int64_t now_us) {
+    Entry* entry = _entries.find(message.msgid);
+    if (!entry) return;
+    constexpr auto relaxed = std::memory_order_relaxed;
+
+    const uint32_t bytes = wire_length(message);
+    const uint64_t count = entry->count.load(relaxed);
+    const int64_t last_us = entry->last_us.load(relaxed);
+    if (count == 0) {
+        entry->size.store(static_cast<float>(bytes), relaxed);
+    } else {
+        const float size = entry->size.load(relaxed);
+        entry->size.store(size + (bytes - size) * kSizeGain, relaxed);
+
+        // A wall clock step backwards reads as a zero interval
+        const float dt = static_cast<float>(std::max<int64_t>(0, now_us - last_us));
+        const float interval = entry->interval_us.load(relaxed);
+        if (count == 1) {
+            entry->interval_us.store(dt, relaxed);
+        } else {
+            const float jitter = entry->jitter_us.load(relaxed);
+            entry->jitter_us.store(jitter + (std::fabs(dt - interval) - jitter) * kJitterGain, relaxed);
+            entry->interval_us.store(interval + (dt - interval) * kIntervalGain, relaxed);
+        }
+    }
+    entry->bytes.store(entry->bytes.load(relaxed) + bytes, relaxed);
+    entry->last_us.store(now_us, relaxed);
+    entry->count.store(count + 1, relaxed);
+}
+
+std::vector<LinkStats::Summary> LinkStats::summarize(int64_t now_us) const {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    std::vector<Summary> out;
+    _entries.for_each([&](uint32_t msgid, const Entry& entry) {
+        const uint64_t count = entry.count.load(relaxed);
+        if (count == 0 && entry.requested_interval_us <= 0) return;
+
+        Summary summary;
+        summary.msgid = msgid;
+        summary.count = count;
+        summary.bytes = entry.bytes.load(relaxed);
+        summary.last_seen_us = entry.last_us.load(relaxed);
+        summary.jitter_ms = entry.jitter_us.load(relaxed) * 1e-3;
+        if (entry.requested_interval_us > 0) summary.requested_hz = 1e6 / static_cast<double>(entry.requested_interval_us);
+
+        // Past the mean interval without a new message, the silence itself
+        // bounds the rate, so a stopped stream falls towards zero
+        const double interval = entry.interval_us.load(relaxed);
+        const double elapsed = std::max(interval, static_cast<double>(now_us - summary.last_seen_us));
+        if (count >= 2 && elapsed > 0) {
+            summary.rate_hz = 1e6 / elapsed;
+            summary.bytes_per_sec = summary.rate_hz * entry.size.load(relaxed);
+        }
+        out.push_back(summary);
+    });
+    return out;
+}
@@ -0,0 +1,173 @@
+#include "logger.hpp"
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info:  return "INFO ";
+        case LogLevel::Warn:  return "WARN ";
+        case LogLevel::Error: return "ERROR";
+        case LogLevel::Fatal: return "FATAL";
+    }
+    return "?????";
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : _slots(new Slot[kCapacity]) {
+    for (std::size_t i = 0; i < kCapacity; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _writer = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
+bool Logger::push(const LogRecord& record) {
+    if (!_running.load(std::memory_order_acquire)) {
+        // Writer is gone (static teardown); write through so nothing is lost
+        std::string line;
+        write(record, line);
+        std::fwrite(line.data(), 1, line.size(), record.level >= LogLevel::Error ? stderr : stdout);
+        return true;
+    }
+
+    std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &_slots[pos & (kCapacity - 1)];
+        const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->record = record;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    if (record.level >= LogLevel::Warn) {
+        _wake_cv.notify_one();
+    }
+    return true;
+}
+
+bool Logger::pop(LogRecord& out) {
+    const std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    Slot& slot = _slots[pos & (kCapacity - 1)];
+    const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+        return false; // Empty
+    }
+    // Single consumer: no CAS needed
+    out = slot.record;
+    _dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    slot.sequence.store(pos + kCapacity, std::memory_order_release);
+    return true;
+}
+
+void Logger::write(const LogRecord& record, std::string& out) const {
+    char stamp[32];
+    const std::time_t seconds = static_cast<std::time_t>(record.timestamp_us / 1000000);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+    std::size_t n = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+    std::snprintf(stamp + n, sizeof(stamp) - n, ".%03d", static_cast<int>((record.timestamp_us / 1000) % 1000));
+
+    out += stamp;
+    out += ' ';
+    out += level_name(record.level);
+    out += " [";
+    out += record.tag;
+    out += "] ";
+    out.append(record.text, record.text_len);
+    if (record.vehicle[0]) {
+        out += " vehicle=";
+        out += record.vehicle;
+    }
+    if (record.msgid >= 0) {
+        out += " msgid=";
+        out += std::to_string(record.msgid);
+    }
+    if (record.suppressed) {
+        out += " suppressed=";
+        out += std::to_string(record.suppressed);
+    }
+    out += '\n';
+}
+
+void Logger::run() {
+    std::string out;
+    std::string err;
+    LogRecord record;
+    uint64_t reported_drops = 0;
+
+    auto drain = [&]() {
+        while (pop(record)) {
+            write(record, record.level >= LogLevel::Error ? err : out);
+        }
+        const uint64_t drops = _dropped.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            err += "[Logger] Ring full, dropped " + std::to_string(drops - reported_drops) + " record(s)\n";
+            reported_drops = drops;
+        }
+        // One write + flush per batch instead of one per line
+        if (!out.empty()) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            std::fflush(stdout);
+            out.clear();
+        }
+        if (!err.empty()) {
+            std::fwrite(err.data(), 1, err.size(), stderr);
+            err.clear();
+        }
+    };
+
+    while (_running.load(std::memory_order_acquire)) {
+        drain();
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        _wake_cv.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    drain();
+}
+
+void Logger::shutdown() {
+    if (!_running.exchange(false)) return;
+    _wake_cv.notify_one();
+    if (_writer.joinable()) {
+        _writer.join();
+    }
+
+    // A producer that passed the _running check just before the exchange
+    // above can enqueue after the writer's final drain (often the FATAL
+    // line logged right before shutdown). The writer is gone, so this
+    // thread is the only consumer now; wait out slots claimed but not yet
+    // published and write everything left.
+    std::string line;
+    LogRecord record;
+    while (_dequeue_pos.load(std::memory_order_relaxed) != _enqueue_pos.load(std::memory_order_acquire)) {
+        if (!pop(record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        line.clear();
+        write(record, line);
+        std::fwrite(line.data(), 1, line.size(), record.level >= LogLevel::Error ? stderr : stdout);
+    }
+    std::fflush(stdout);
+}
@@ -3,39 +3,261 @@
 #include "video_manager.hpp"
 #include "log_file_manager.hpp"
 #include "tlog_recorder.hpp"
+#include "logger.hpp"
+#include "json_delta.hpp"
+#include "stream_client_queue.hpp"
+#include "stream_deflater.hpp"
+#include "stream_filter.hpp"
+#include "sample_window.hpp"
+#include "response_cache.hpp"
+#include "radio_link_batch.hpp"
 #include <nlohmann/json.hpp>
-#include <iostream>
 #include <crow/websocket.h>
 #include <thread>
 #include <unordered_map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <algorithm>
 #include <signal.h>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <limits>
+#include <charconv>
+#include <cstring>
+#include <string_view>
 
 using json = nlohmann::json;
 
+// Outgoing queue watermarks per stream client, in bytes
+#ifndef XGCS_STREAM_QUEUE_HIGH_WATERMARK
+#define XGCS_STREAM_QUEUE_HIGH_WATERMARK (1024 * 1024)
+#endif
+#ifndef XGCS_STREAM_QUEUE_LOW_WATERMARK
+#define XGCS_STREAM_QUEUE_LOW_WATERMARK (512 * 1024)
+#endif
+
+// One MAVLink stream WebSocket client (set up by its first message).
+// The fan-out stage filters and queues frames under `mutex`; the writer
+// thread drains `queue` and sends holding only send_mutex. Neither touches
+// g_websocket_mutex, so one slow socket does not stall registration, fan-out
+// or other clients. onclose clears `open` under send_mutex before Crow frees
+// the connection, so a writer still holding a reference never touches a
+// dead socket.
+struct MavlinkWSContext {
+    crow::websocket::connection* conn = nullptr;
+    std::string vehicleId;
+    StreamFormat format = StreamFormat::Json;
+    StreamOverflowPolicy overflow = StreamOverflowPolicy::DropOldest;
+    // Micro-batching (opt-in): frames queued within the window, or until
+    // batch_max_bytes, go out as one WebSocket frame
+    bool batch = false;
+    int64_t batch_window_us = 0;
+    std::size_t batch_max_bytes = 0;
+    std::optional<StreamClientQueue> queue; // Set before the client is published
+    std::optional<StreamDeflater> deflater; // Opt-in compression; used by the writer under send_mutex
+    bool subscribed = false; // Holds a start_mavlink_streaming() reference
+
+    std::mutex mutex;
+    StreamFilter filter; // Guarded by mutex
+    std::optional<uint64_t> resume_from; // Guarded by mutex; replayed on the sender's first pass
+
+    std::mutex send_mutex;
+    bool open = true; // Guarded by send_mutex
+
+    // Writer-side delivery figures, guarded by stats_mutex
+    std::mutex stats_mutex;
+    SampleWindow<uint32_t, 1024> frame_messages; // Messages per WebSocket frame
+    SampleWindow<uint32_t, 1024> frame_bytes;    // Bytes per WebSocket frame
+    SampleWindow<uint32_t, 4096> queue_latency_us; // Queued until handed to Crow, per message
+    uint64_t deflate_cpu_ns = 0;    // Thread CPU time spent compressing
+    uint64_t deflate_in_bytes = 0;  // Frame bytes before compression
+    uint64_t deflate_out_bytes = 0; // Frame bytes as sent, header included
+    uint64_t deflated_frames = 0;   // Frames that went out compressed
+};
+
 // Global WebSocket connection store
-std::unordered_map<std::string, std::vector<crow::websocket::connection*>> g_websocket_connections;
+std::unordered_map<std::string, std::vector<std::shared_ptr<MavlinkWSContext>>> g_websocket_connections;
 std::mutex g_websocket_mutex;
-// Map from connection* to vehicleId (set after first message)
-std::unordered_map<crow::websocket::connection*, std::string> g_conn_to_vehicle;
+
+// Map from connection* to its context
+std::unordered_map<crow::websocket::connection*, std::shared_ptr<MavlinkWSContext>> g_conn_to_vehicle;
+
+// Clients with queued frames, waiting for the stream writer thread
+std::deque<std::shared_ptr<MavlinkWSContext>> g_stream_ready;
+std::mutex g_stream_ready_mutex;
+std::condition_variable g_stream_ready_cv;
+
+bool parse_overflow_policy(const std::string& name, StreamOverflowPolicy& policy) {
+    if (name == "drop_oldest") policy = StreamOverflowPolicy::DropOldest;
+    else if (name == "coalesce") policy = StreamOverflowPolicy::CoalesceLatest;
+    else if (name == "disconnect") policy = StreamOverflowPolicy::Disconnect;
+    else return false;
+    return true;
+}
+
+const char* overflow_policy_name(StreamOverflowPolicy policy) {
+    switch (policy) {
+        case StreamOverflowPolicy::DropOldest: return "drop_oldest";
+        case StreamOverflowPolicy::CoalesceLatest: return "coalesce";
+        case StreamOverflowPolicy::Disconnect: return "disconnect";
+    }
+    return "unknown";
+}
+
+// The "compression" hello field, shared by every stream socket. Sets up
+// `deflater` when present and valid; false when present but malformed.
+constexpr const char* kCompressionUsage =
+    "expected \"compression\": {\"level\": 1-9, \"threshold\": bytes, \"contextTakeover\": bool}";
+
+bool parse_compression(const json& hello, std::optional<StreamDeflater>& deflater) {
+    if (!hello.contains("compression")) return true;
+    const json& compression = hello["compression"];
+    const json level = compression.is_object() ? compression.value("level", json(XGCS_STREAM_DEFLATE_LEVEL)) : json();
+    const json threshold = compression.is_object() ? compression.value("threshold", json(XGCS_STREAM_DEFLATE_THRESHOLD)) : json();
+    const json takeover = compression.is_object() ? compression.value("contextTakeover", json(true)) : json();
+    if (!level.is_number_unsigned() || level.get<uint64_t>() < 1 || level.get<uint64_t>() > 9 ||
+        !threshold.is_number_unsigned() || !takeover.is_boolean()) {
+        return false;
+    }
+    deflater.emplace(level.get<int>(), takeover.get<bool>(), threshold.get<std::size_t>());
+    return true;
+}
+
+// Sends a JSON document as is, or for a compressing client as a binary frame
+// with the StreamDeflater header byte. Caller holds the client's send_mutex;
+// `wire` is scratch space kept by the sending thread.
+void send_json_frame(crow::websocket::connection& conn, std::optional<StreamDeflater>& deflater,
+                     const std::string& payload, std::string& wire) {
+    try {
+        if (deflater) {
+            wire.clear();
+            deflater->encode(payload, wire);
+            conn.send_binary(wire);
+        } else {
+            conn.send_text(payload);
+        }
+    } catch (...) {
+        // Connection might be closed, ignore
+    }
+}
+
+// Documents a telemetry stream client can follow
+enum class TelemetryTopic : uint8_t {
+    Telemetry, // get_telemetry_data()
+    LinkStats  // get_link_stats()
+};
+
+// One telemetry snapshot WebSocket client (/api/telemetry/stream). The
+// publisher thread owns the schedule and diff state; like the MAVLink
+// stream, sends happen under send_mutex only and onclose clears `open`.
+struct TelemetryWSContext {
+    crow::websocket::connection* conn = nullptr;
+    std::string vehicleId;
+    TelemetryTopic topic = TelemetryTopic::Telemetry;
+    int64_t interval_us = 200000;          // Client-chosen push period
+    int64_t keyframe_interval_us = 5000000; // Full snapshot at least this often
+    std::optional<StreamDeflater> deflater; // Opt-in compression, set before the client is published
+
+    // Publisher thread only
+    int64_t next_due_us = 0;
+    int64_t next_keyframe_us = 0; // 0: next frame is a keyframe
+    json last_sent;
+
+    std::mutex send_mutex;
+    bool open = true; // Guarded by send_mutex
+};
+
+std::unordered_map<crow::websocket::connection*, std::shared_ptr<TelemetryWSContext>> g_telemetry_clients;
+std::mutex g_telemetry_mutex;
+std::condition_variable g_telemetry_cv; // New client or shutdown
+uint64_t g_telemetry_generation = 0;    // Bumped per new client, guarded by g_telemetry_mutex
+
+// Fleet stream publish rate (frames per second)
+#ifndef XGCS_FLEET_STREAM_HZ
+#define XGCS_FLEET_STREAM_HZ 2
+#endif
+
+// One fleet stream WebSocket client (/api/fleet/stream)
+struct FleetWSContext {
+    crow::websocket::connection* conn = nullptr;
+    std::mutex send_mutex;
+    bool open = true; // Guarded by send_mutex
+    std::optional<StreamDeflater> deflater; // Opt-in compression, guarded by send_mutex
+};
+
+std::unordered_map<crow::websocket::connection*, std::shared_ptr<FleetWSContext>> g_fleet_clients;
+std::mutex g_fleet_mutex;
+std::condition_variable g_fleet_cv; // Shutdown
+
+// Radio simulation timer (see ConnectionManager::update_radio_simulation())
+std::mutex g_radio_sim_mutex;
+std::condition_variable g_radio_sim_cv; // Shutdown
+
+// Polled fleet endpoints (/vehicles, /telemetry/all): each body is built at
+// most once per XGCS_FLEET_CACHE_TICK_MS and shared by every request in it
+TickedResponseCache g_vehicles_cache{std::chrono::milliseconds(XGCS_FLEET_CACHE_TICK_MS)};
+TickedResponseCache g_telemetry_all_cache{std::chrono::milliseconds(XGCS_FLEET_CACHE_TICK_MS)};
+
+// /telemetry/all with ?fields=, one cache per distinct selection (bounded;
+// selections past the bound are built per request)
+std::unordered_map<std::string, std::unique_ptr<TickedResponseCache>> g_telemetry_all_projected_caches;
+std::mutex g_telemetry_all_projected_mutex;
+constexpr std::size_t kMaxProjectedFleetCaches = 64;
+std::atomic<uint64_t> g_telemetry_all_uncached_projections{0}; // Built per request, past the bound
+
+// Compiles the request's ?fields= selection for `document`. Leaves `fields`
+// null when absent; on an unknown field fills `res` with a 400 and returns false.
+bool parse_fields_param(const crow::request& req, ConnectionManager::TelemetryDocument document,
+                        std::shared_ptr<const FieldProjection>& fields, crow::response& res) {
+    const char* selection = req.url_params.get("fields");
+    if (!selection || !*selection) return true;
+    std::string error;
+    fields = ConnectionManager::compile_fields(document, selection, error);
+    if (fields) return true;
+    res.code = 400;
+    res.set_header("Content-Type", "application/json");
+    res.body = json{{"success", false}, {"error", error}}.dump();
+    return false;
+}
+
+// JSON response from `cache`, or 304 when If-None-Match already names it
+template <typename Build>
+crow::response cached_json_response(const crow::request& req, TickedResponseCache& cache, Build&& build) {
+    crow::response res;
+    res.add_header("Access-Control-Allow-Origin", "*");
+    res.add_header("Access-Control-Expose-Headers", "ETag");
+    const auto cached = cache.get(std::forward<Build>(build));
+    res.set_header("ETag", cached.etag);
+    res.set_header("Cache-Control", "no-cache"); // Always revalidate; 304s are cheap
+    if (cache.not_modified(req.get_header_value("If-None-Match"), cached.etag)) {
+        res.code = 304;
+        return res;
+    }
+    res.code = 200;
+    res.set_header("Content-Type", "application/json");
+    res.body = *cached.body;
+    return res;
+}
 
 // SWE100821: Add global shutdown flag for graceful termination
 std::atomic<bool> g_shutdown_requested{false};
 
+// Optional extra wait after a stream wakeup so more frames share one pass
+#ifndef XGCS_STREAM_BATCH_WINDOW_MS
+#define XGCS_STREAM_BATCH_WINDOW_MS 0
+#endif
+constexpr std::chrono::milliseconds kStreamBatchWindow{XGCS_STREAM_BATCH_WINDOW_MS};
+
 // Signal handler for graceful shutdown
 void signal_handler(int signal) {
-    std::cout << "\n[INFO] Received signal " << signal << ", shutting down gracefully..." << std::endl;
+    LOG_INFO("Server") << "Received signal " << signal << ", shutting down gracefully...";
     g_shutdown_requested = true;
 }
 
-// WebSocket context for per-connection vehicleId
-struct MavlinkWSContext {
-    std::string vehicleId;
-};
-
 // Utility to extract vehicleId from path
 std::string extract_vehicle_id_from_path(const std::string& path) {
     // Expected: /api/mavlink/stream/<vehicleId>
@@ -51,8 +273,8 @@ int main() {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
-    std::cout << "[INFO] Starting XGCS C++ Backend Server..." << std::endl;
-    std::cout << "[INFO] PID: " << getpid() << std::endl;
+    LOG_INFO("Server") << "Starting XGCS C++ Backend Server...";
+    LOG_INFO("Server") << "PID: " << getpid();
     
     try {
         crow::SimpleApp app;
@@ -366,7 +588,7 @@ int main() {
                 res.body = response_json.dump();
                 return res;
             } catch (const std::exception& e) {
-                std::cerr << "Exception in /connect: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in /connect: " << e.what();
                 
                 json error_json = {
                     {"success", false},
@@ -405,7 +627,7 @@ int main() {
                 
                 return resp;
             } catch (const std::exception& e) {
-                std::cerr << "Exception in /disconnect: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in /disconnect: " << e.what();
                 
                 json error_json = {
                     {"success", false},
@@ -423,25 +645,24 @@ int main() {
 
         CROW_ROUTE(app, "/vehicles")
         .methods("GET"_method)
-        ([](const crow::request&) {
+        ([](const crow::request& req) {
             crow::response res;
             res.add_header("Access-Control-Allow-Origin", "*");
             
             try {
-                auto connectedVehicles = ConnectionManager::instance().get_connected_vehicles();
-                
-                json vehicles_json = json::array();
-                for (const auto& vehicleId : connectedVehicles) {
-                    vehicles_json.push_back({{"id", vehicleId}});
-                }
-                
-                json response_json = {
-                    {"vehicles", vehicles_json}
-                };
-                
-                res.code = 200;
-                res.set_header("Content-Type", "application/json");
-                res.body = response_json.dump();
+                return cached_json_response(req, g_vehicles_cache, [] {
+                    auto connectedVehicles = ConnectionManager::instance().get_connected_vehicles();
+                    
+                    json vehicles_json = json::array();
+                    for (const auto& vehicleId : connectedVehicles) {
+                        vehicles_json.push_back({{"id", vehicleId}});
+                    }
+                    
+                    json response_json = {
+                        {"vehicles", vehicles_json}
+                    };
+                    return response_json.dump();
+                });
             } catch (const std::exception& e) {
                 json error_json = {
                     {"error", std::string("Error: ") + e.what()}
@@ -457,17 +678,46 @@ int main() {
 
         CROW_ROUTE(app, "/telemetry/all")
         .methods("GET"_method)
-        ([](const crow::request&) {
+        ([](const crow::request& req) {
             crow::response res;
             res.add_header("Access-Control-Allow-Origin", "*");
             res.set_header("Content-Type", "application/json");
 
             try {
-                // Get bulk telemetry data
-                std::string telemetry_json_str = ConnectionManager::instance().get_all_vehicle_statuses();
-                
+                std::shared_ptr<const FieldProjection> fields;
+                if (!parse_fields_param(req, ConnectionManager::TelemetryDocument::Fleet, fields, res)) return res;
+                if (!fields) {
+                    // Get bulk telemetry data, shared by every poller in this tick
+                    return cached_json_response(req, g_telemetry_all_cache, [] {
+                        TickedResponseCache::Built built;
+                        built.body = ConnectionManager::instance().get_all_vehicle_statuses(nullptr, &built.validator);
+                        return built;
+                    });
+                }
+
+                TickedResponseCache* cache = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(g_telemetry_all_projected_mutex);
+                    const std::string selection = req.url_params.get("fields");
+                    auto it = g_telemetry_all_projected_caches.find(selection);
+                    if (it == g_telemetry_all_projected_caches.end() &&
+                        g_telemetry_all_projected_caches.size() < kMaxProjectedFleetCaches) {
+                        it = g_telemetry_all_projected_caches.emplace(selection,
+                            std::make_unique<TickedResponseCache>(std::chrono::milliseconds(XGCS_FLEET_CACHE_TICK_MS))).first;
+                    }
+                    // Caches are never removed, so the pointer outlives the lock
+                    if (it != g_telemetry_all_projected_caches.end()) cache = it->second.get();
+                }
+                auto build = [&fields] {
+                    TickedResponseCache::Built built;
+                    built.body = ConnectionManager::instance().get_all_vehicle_statuses(fields.get(), &built.validator);
+                    return built;
+                };
+                if (cache) return cached_json_response(req, *cache, build);
+                g_telemetry_all_uncached_projections.fetch_add(1, std::memory_order_relaxed);
                 res.code = 200;
-                res.body = telemetry_json_str;
+                res.body = ConnectionManager::instance().get_all_vehicle_statuses(fields.get());
+                return res;
             } catch (const std::exception& e) {
                 res.code = 500;
                 res.body = json{
@@ -479,6 +729,54 @@ int main() {
             return res;
         });
 
+        // Effectiveness of the fleet response caches
+        CROW_ROUTE(app, "/api/fleet/cache-stats").methods("GET"_method)
+        ([](const crow::request&) {
+            crow::response res;
+            res.add_header("Access-Control-Allow-Origin", "*");
+            res.add_header("Content-Type", "application/json");
+
+            auto report = [](const TickedResponseCache::Stats& stats) {
+                const uint64_t requests = stats.hits + stats.misses;
+                return json{
+                    {"hits", stats.hits},
+                    {"misses", stats.misses},
+                    {"notModified", stats.not_modified},
+                    {"hitRatio", requests ? static_cast<double>(stats.hits) / requests : 0.0}
+                };
+            };
+
+            // ?fields= selections of /telemetry/all: totals plus one entry per cached selection
+            TickedResponseCache::Stats projected_total;
+            json by_selection = json::object();
+            {
+                std::lock_guard<std::mutex> lock(g_telemetry_all_projected_mutex);
+                for (const auto& [selection, cache] : g_telemetry_all_projected_caches) {
+                    const auto stats = cache->stats();
+                    projected_total.hits += stats.hits;
+                    projected_total.misses += stats.misses;
+                    projected_total.not_modified += stats.not_modified;
+                    by_selection[selection] = report(stats);
+                }
+            }
+            json projected = report(projected_total);
+            projected["selections"] = by_selection.size();
+            projected["maxSelections"] = kMaxProjectedFleetCaches;
+            projected["uncached"] = g_telemetry_all_uncached_projections.load(std::memory_order_relaxed);
+            projected["bySelection"] = std::move(by_selection);
+
+            res.body = json{
+                {"tickMs", XGCS_FLEET_CACHE_TICK_MS},
+                {"endpoints", {
+                    {"/vehicles", report(g_vehicles_cache.stats())},
+                    {"/telemetry/all", report(g_telemetry_all_cache.stats())},
+                    {"/telemetry/all?fields", std::move(projected)}
+                }}
+            }.dump();
+            res.code = 200;
+            return res;
+        });
+
         CROW_ROUTE(app, "/telemetry")
         .methods("GET"_method)
         ([](const crow::request& req) {
@@ -513,15 +811,12 @@ int main() {
                     return res;
                 }
                 
-                // Get real telemetry data from the vehicle as JSON string
-                std::string telemetry_json_str = ConnectionManager::instance().get_telemetry_data_json(vehicleId);
-                
-                // Parse the JSON string
-                json telemetry_data = json::parse(telemetry_json_str);
-                telemetry_data["success"] = true;
-                
+                std::shared_ptr<const FieldProjection> fields;
+                if (!parse_fields_param(req, ConnectionManager::TelemetryDocument::Telemetry, fields, res)) return res;
+
+                // Get real telemetry data from the vehicle (only the selected fields)
                 res.code = 200;
-                res.body = telemetry_data.dump();
+                res.body = ConnectionManager::instance().get_telemetry_data_json(vehicleId, fields.get());
             } catch (const std::exception& e) {
                 res.code = 500;
                 res.body = json{
@@ -619,17 +914,93 @@ int main() {
         // NEW: Vehicle status endpoint
         CROW_ROUTE(app, "/api/vehicle/<string>/status")
         .methods("GET"_method)
-        ([](const std::string& vehicle_id) {
+        ([](const crow::request& req, const std::string& vehicle_id) {
             crow::response res;
             res.add_header("Access-Control-Allow-Origin", "*");
             res.add_header("Content-Type", "application/json");
-            
-            std::string result = ConnectionManager::instance().get_vehicle_status(vehicle_id);
+
+            std::shared_ptr<const FieldProjection> fields;
+            if (!parse_fields_param(req, ConnectionManager::TelemetryDocument::Status, fields, res)) return res;
+            std::string result = ConnectionManager::instance().get_vehicle_status(vehicle_id, fields.get());
             res.body = result;
             res.code = 200;
             return res;
         });
 
+        // Recorded telemetry for charts, downsampled server-side:
+        //   ?fields=alt,battery  channels (default: all)
+        //   &from=&to=           epoch ms (default: everything recorded)
+        //   &max_points=500      per channel, 3-10000
+        //   &mode=lttb|minmax    downsampling (default lttb)
+        CROW_ROUTE(app, "/api/vehicle/<string>/history")
+        .methods("GET"_method)
+        ([](const crow::request& req, const std::string& vehicle_id) {
+            crow::response res;
+            res.add_header("Access-Control-Allow-Origin", "*");
+            res.add_header("Content-Type", "application/json");
+            auto fail = [&res](const std::string& error) {
+                res.code = 400;
+                res.body = json{{"success", false}, {"error", error}}.dump();
+                return std::move(res);
+            };
+            auto parse_int = [](const char* text, int64_t& value) {
+                const char* end = text + std::strlen(text);
+                auto [ptr, ec] = std::from_chars(text, end, value);
+                return ec == std::errc() && ptr == end;
+            };
+
+            std::vector<HistoryChannel> channels;
+            if (const char* fields = req.url_params.get("fields")) {
+                std::string_view list(fields);
+                while (!list.empty()) {
+                    const std::size_t comma = list.find(',');
+                    const std::string_view name = list.substr(0, comma);
+                    list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+                    HistoryChannel channel;
+                    if (!TelemetryHistory::parse_channel(name, channel)) return fail("unknown field: " + std::string(name));
+                    channels.push_back(channel);
+                }
+            }
+            if (channels.empty()) {
+                for (std::size_t i = 0; i < kHistoryChannelCount; ++i) channels.push_back(static_cast<HistoryChannel>(i));
+            }
+
+            int64_t from_ms = 0;
+            int64_t to_ms = std::numeric_limits<int64_t>::max();
+            int64_t max_points = 500;
+            if (const char* from = req.url_params.get("from"); from && !parse_int(from, from_ms)) return fail("from: expected epoch ms");
+            if (const char* to = req.url_params.get("to"); to && !parse_int(to, to_ms)) return fail("to: expected epoch ms");
+            if (const char* points = req.url_params.get("max_points");
+                points && (!parse_int(points, max_points) || max_points < 3 || max_points > 10000)) {
+                return fail("max_points: expected 3-10000");
+            }
+            HistoryDownsample mode = HistoryDownsample::Lttb;
+            if (const char* name = req.url_params.get("mode")) {
+                if (std::strcmp(name, "minmax") == 0) mode = HistoryDownsample::MinMax;
+                else if (std::strcmp(name, "lttb") != 0) return fail("mode: expected lttb or minmax");
+            }
+
+            json result = ConnectionManager::instance().get_telemetry_history(
+                vehicle_id, channels, from_ms, to_ms, static_cast<std::size_t>(max_points), mode);
+            res.code = result.value("success", false) ? 200 : 404;
+            res.body = result.dump();
+            return res;
+        });
+
+        // Measured rate, bandwidth, jitter and last-seen time of every
+        // message id the vehicle sends, next to the rate requested for it
+        CROW_ROUTE(app, "/api/vehicle/<string>/link_stats")
+        .methods("GET"_method)
+        ([](const std::string& vehicle_id) {
+            crow::response res;
+            res.add_header("Access-Control-Allow-Origin", "*");
+            res.add_header("Content-Type", "application/json");
+            json result = ConnectionManager::instance().get_link_stats(vehicle_id);
+            res.code = result.value("success", false) ? 200 : 404;
+            res.body = result.dump();
+            return res;
+        });
+
         // --- Radio Simulation Endpoint ---
         CROW_ROUTE(app, "/api/simulation/radio").methods("POST"_method)
         ([](const crow::request& req) {
@@ -683,13 +1054,13 @@ int main() {
         CROW_ROUTE(app, "/api/command/set_mode").methods("POST"_method)
         ([](const crow::request& req) {
             // --- DEBUG LOGGING ---
-            std::cout << "[DEBUG] /api/command/set_mode called" << std::endl;
-            std::cout << "[DEBUG] Method code: " << static_cast<int>(req.method) << std::endl;
-            std::cout << "[DEBUG] Headers:" << std::endl;
+            LOG_DEBUG("Server") << "/api/command/set_mode called";
+            LOG_DEBUG("Server") << "Method code: " << static_cast<int>(req.method);
+            LOG_DEBUG("Server") << "Headers:";
             for (const auto& h : req.headers) {
-                std::cout << "    " << h.first << ": " << h.second << std::endl;
+                LOG_DEBUG("Server") << "    " << h.first << ": " << h.second;
             }
-            std::cout << "[DEBUG] Body: " << req.body << std::endl;
+            LOG_DEBUG("Server") << "Body: " << req.body;
             // --- END DEBUG LOGGING ---
             auto params = json::parse(req.body);
             std::string vehicleId = params["vehicleId"].get<std::string>();
@@ -701,7 +1072,7 @@ int main() {
         // --- Jeremy: Add arm/disarm endpoints with enhanced stability ---
         CROW_ROUTE(app, "/api/command/arm").methods("POST"_method)
         ([](const crow::request& req) {
-            std::cout << "[DEBUG] /api/command/arm called" << std::endl;
+            LOG_DEBUG("Server") << "/api/command/arm called";
             
             try {
                 auto params = json::parse(req.body);
@@ -722,11 +1093,11 @@ int main() {
                 response.add_header("Access-Control-Allow-Origin", "*");
                 response.set_header("Content-Type", "application/json");
                 
-                std::cout << "[DEBUG] Arm endpoint response: " << response.code << " - " << response.body << std::endl;
+                LOG_DEBUG("Server") << "Arm endpoint response: " << response.code << " - " << response.body;
                 return response;
                 
             } catch (const std::exception& e) {
-                std::cerr << "Exception in arm endpoint: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in arm endpoint: " << e.what();
                 auto response = crow::response(400, json{{"success", false}, {"error", e.what()}}.dump());
                 response.add_header("Access-Control-Allow-Origin", "*");
                 response.set_header("Content-Type", "application/json");
@@ -797,7 +1168,7 @@ int main() {
 
         CROW_ROUTE(app, "/api/command/disarm").methods("POST"_method)
         ([](const crow::request& req) {
-            std::cout << "[DEBUG] /api/command/disarm called" << std::endl;
+            LOG_DEBUG("Server") << "/api/command/disarm called";
             
             try {
                 auto params = json::parse(req.body);
@@ -818,11 +1189,11 @@ int main() {
                 response.add_header("Access-Control-Allow-Origin", "*");
                 response.set_header("Content-Type", "application/json");
                 
-                std::cout << "[DEBUG] Disarm endpoint response: " << response.code << " - " << response.body << std::endl;
+                LOG_DEBUG("Server") << "Disarm endpoint response: " << response.code << " - " << response.body;
                 return response;
                 
             } catch (const std::exception& e) {
-                std::cerr << "Exception in disarm endpoint: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in disarm endpoint: " << e.what();
                 auto response = crow::response(400, json{{"success", false}, {"error", e.what()}}.dump());
                 response.add_header("Access-Control-Allow-Origin", "*");
                 response.set_header("Content-Type", "application/json");
@@ -834,7 +1205,7 @@ int main() {
         // --- Jeremy: Add flight modes endpoint ---
         CROW_ROUTE(app, "/api/vehicle/<string>/flight-modes").methods("GET"_method)
         ([](const std::string& vehicle_id) {
-            std::cout << "[DEBUG] /api/vehicle/" << vehicle_id << "/flight-modes called" << std::endl;
+            LOG_DEBUG("Server") << "/api/vehicle/" << vehicle_id << "/flight-modes called";
             auto result = ConnectionManager::instance().get_flight_modes(vehicle_id);
             return crow::response(200, result);
         });
@@ -843,18 +1214,18 @@ int main() {
         // --- Jeremy: Add flight mode change endpoint ---
         CROW_ROUTE(app, "/api/vehicle/<string>/flight-mode").methods("POST"_method)
         ([](const crow::request& req, const std::string& vehicle_id) {
-            std::cout << "[DEBUG] /api/vehicle/" << vehicle_id << "/flight-mode called" << std::endl;
-            std::cout << "[DEBUG] Body: " << req.body << std::endl;
+            LOG_DEBUG("Server") << "/api/vehicle/" << vehicle_id << "/flight-mode called";
+            LOG_DEBUG("Server") << "Body: " << req.body;
             
             try {
                 auto params = json::parse(req.body);
                 std::string flight_mode = params["flight_mode"].get<std::string>();
-                std::cout << "[DEBUG] Changing flight mode to: " << flight_mode << std::endl;
+                LOG_DEBUG("Server") << "Changing flight mode to: " << flight_mode;
                 
                 bool success = ConnectionManager::instance().send_set_mode_command(vehicle_id, flight_mode);
                 return crow::response(200, json{{"success", success}}.dump());
             } catch (const std::exception& e) {
-                std::cerr << "Exception in flight-mode endpoint: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in flight-mode endpoint: " << e.what();
                 return crow::response(400, json{{"success", false}, {"error", e.what()}}.dump());
             }
         });
@@ -974,7 +1345,7 @@ int main() {
                 res.code = 200;
                 res.body = connections.dump();
             } catch (const std::exception& e) {
-                std::cerr << "Exception in /api/connections: " << e.what() << std::endl;
+                LOG_ERROR("Server") << "Exception in /api/connections: " << e.what();
                 res.code = 500;
                 res.body = json{{"error", "Internal server error"}, {"message", e.what()}}.dump();
             }
@@ -983,6 +1354,75 @@ int main() {
         });
         // --- End Jeremy patch for connections endpoint ---
 
+        // Outgoing queue state of every MAVLink stream client
+        CROW_ROUTE(app, "/api/mavlink/stream-stats").methods("GET"_method)
+        ([](const crow::request&) {
+            crow::response res;
+            res.add_header("Access-Control-Allow-Origin", "*");
+            res.add_header("Content-Type", "application/json");
+
+            std::vector<std::shared_ptr<MavlinkWSContext>> clients;
+            {
+                std::lock_guard<std::mutex> lock(g_websocket_mutex);
+                for (const auto& [conn, context] : g_conn_to_vehicle) clients.push_back(context);
+            }
+
+            auto summary = [](const auto& window) {
+                const auto values = window.percentiles({50, 90, 99});
+                return json{{"p50", values[0]}, {"p90", values[1]}, {"p99", values[2]}, {"max", values[3]}};
+            };
+
+            json result = json::array();
+            for (const auto& client : clients) {
+                const auto stats = client->queue->stats();
+                json delivery;
+                json compression;
+                {
+                    std::lock_guard<std::mutex> stats_lock(client->stats_mutex);
+                    delivery = {
+                        {"frames", client->frame_messages.total()},
+                        {"messagesPerFrame", summary(client->frame_messages)},
+                        {"bytesPerFrame", summary(client->frame_bytes)},
+                        {"queueLatencyUs", summary(client->queue_latency_us)}
+                    };
+                    if (client->deflater) {
+                        compression = {
+                            {"level", client->deflater->level()},
+                            {"contextTakeover", client->deflater->context_takeover()},
+                            {"threshold", client->deflater->threshold()},
+                            {"deflatedFrames", client->deflated_frames},
+                            {"bytesIn", client->deflate_in_bytes},
+                            {"bytesOut", client->deflate_out_bytes},
+                            {"bytesSaved", static_cast<int64_t>(client->deflate_in_bytes) - static_cast<int64_t>(client->deflate_out_bytes)},
+                            {"cpuUs", client->deflate_cpu_ns / 1000}
+                        };
+                    }
+                }
+                result.push_back({
+                    {"vehicleId", client->vehicleId},
+                    {"overflow", overflow_policy_name(client->overflow)},
+                    {"queueDepth", stats.depth},
+                    {"queueBytes", stats.bytes},
+                    {"peakQueueBytes", stats.peak_bytes},
+                    {"sent", stats.sent},
+                    {"dropped", stats.dropped},
+                    {"coalesced", stats.coalesced},
+                    {"overflowed", stats.overflowed},
+                    {"batch", client->batch ? json{{"ms", client->batch_window_us / 1000}, {"bytes", client->batch_max_bytes}} : json()},
+                    {"delivery", std::move(delivery)},
+                    {"compression", std::move(compression)}
+                });
+            }
+            res.code = 200;
+            res.body = json{
+                {"highWatermark", XGCS_STREAM_QUEUE_HIGH_WATERMARK},
+                {"lowWatermark", XGCS_STREAM_QUEUE_LOW_WATERMARK},
+                {"vehicles", ConnectionManager::instance().get_mavlink_stream_subscriptions()},
+                {"clients", result}
+            }.dump();
+            return res;
+        });
+
         // MAVLink Streaming WebSocket endpoint
         CROW_ROUTE(app, "/api/mavlink/stream/<string>")
         .websocket(&app)
@@ -991,90 +1431,648 @@ int main() {
         })
         .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t code) {
             std::string vehicleId;
+            std::shared_ptr<MavlinkWSContext> context;
             {
                 std::lock_guard<std::mutex> lock(g_websocket_mutex);
                 auto it = g_conn_to_vehicle.find(&conn);
                 if (it != g_conn_to_vehicle.end()) {
-                    vehicleId = it->second;
+                    context = it->second;
+                    vehicleId = context->vehicleId;
                     auto& connections = g_websocket_connections[vehicleId];
-                    connections.erase(std::remove(connections.begin(), connections.end(), &conn), connections.end());
+                    connections.erase(std::remove(connections.begin(), connections.end(), context), connections.end());
                     g_conn_to_vehicle.erase(it);
                 }
             }
-            if (!vehicleId.empty()) {
-                std::cout << "WebSocket closed for vehicle: " << vehicleId << std::endl;
-                ConnectionManager::instance().stop_mavlink_streaming(vehicleId);
+            if (context) {
+                // Waits out an in-flight send; none start after this
+                std::lock_guard<std::mutex> send_lock(context->send_mutex);
+                context->open = false;
+            }
+            if (context) {
+                LOG_INFO("Server") << "WebSocket closed for vehicle: " << vehicleId;
+                // Drops only this client's reference; others keep streaming
+                if (context->subscribed) ConnectionManager::instance().stop_mavlink_streaming(vehicleId);
             }
         })
         .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
             std::string vehicleId;
+            std::shared_ptr<MavlinkWSContext> context;
             {
                 std::lock_guard<std::mutex> lock(g_websocket_mutex);
                 auto it = g_conn_to_vehicle.find(&conn);
                 if (it == g_conn_to_vehicle.end()) {
-                    // First message: treat as vehicleId
-                    vehicleId = data;
-                    g_conn_to_vehicle[&conn] = vehicleId;
-                    g_websocket_connections[vehicleId].push_back(&conn);
-                    std::cout << "WebSocket opened for vehicle: " << vehicleId << std::endl;
-                    ConnectionManager::instance().start_mavlink_streaming(vehicleId);
+                    // First message selects the vehicle. Either the bare vehicleId
+                    // (JSON text frames), or a JSON hello choosing the encoding
+                    // and what happens when the client cannot keep up:
+                    //   {"vehicleId": "...", "format": "json" | "mavlink" | "cbor",
+                    //    "overflow": "drop_oldest" | "coalesce" | "disconnect",
+                    //    "batch": {"ms": 10, "bytes": 65536},
+                    //    "compression": {"level": 6, "threshold": 256, "contextTakeover": true},
+                    //    "resumeFrom": <serverSeq after the last one received>}
+                    context = std::make_shared<MavlinkWSContext>();
+                    context->conn = &conn;
+                    context->vehicleId = data;
+                    if (!data.empty() && data.front() == '{') {
+                        json hello = json::parse(data, nullptr, false);
+                        if (hello.is_discarded() || !hello.contains("vehicleId") || !hello["vehicleId"].is_string()) {
+                            conn.close("expected {\"vehicleId\": ..., \"format\": ...}");
+                            return;
+                        }
+                        context->vehicleId = hello["vehicleId"].get<std::string>();
+                        const json format = hello.value("format", json("json"));
+                        if (!format.is_string() || !ConnectionManager::parse_stream_format(format.get<std::string>(), context->format)) {
+                            conn.close("unsupported format: " + (format.is_string() ? format.get<std::string>() : format.dump()));
+                            return;
+                        }
+                        const json overflow = hello.value("overflow", json("drop_oldest"));
+                        if (!overflow.is_string() || !parse_overflow_policy(overflow.get<std::string>(), context->overflow)) {
+                            conn.close("unsupported overflow policy: " + (overflow.is_string() ? overflow.get<std::string>() : overflow.dump()));
+                            return;
+                        }
+                        if (hello.contains("batch")) {
+                            const json& batch = hello["batch"];
+                            const json ms = batch.is_object() ? batch.value("ms", json(10)) : json();
+                            const json bytes = batch.is_object() ? batch.value("bytes", json(65536)) : json();
+                            if (!ms.is_number_unsigned() || ms.get<uint64_t>() > 1000 ||
+                                !bytes.is_number_unsigned() || bytes.get<uint64_t>() == 0) {
+                                conn.close("expected \"batch\": {\"ms\": 0-1000, \"bytes\": >0}");
+                                return;
+                            }
+                            context->batch = true;
+                            context->batch_window_us = ms.get<int64_t>() * 1000;
+                            context->batch_max_bytes = std::min<std::size_t>(bytes.get<uint64_t>(), XGCS_STREAM_QUEUE_HIGH_WATERMARK);
+                        }
+                        if (!parse_compression(hello, context->deflater)) {
+                            conn.close(kCompressionUsage);
+                            return;
+                        }
+                        if (hello.contains("resumeFrom")) {
+                            if (!hello["resumeFrom"].is_number_unsigned()) {
+                                conn.close("expected \"resumeFrom\": serverSeq");
+                                return;
+                            }
+                            context->resume_from = hello["resumeFrom"].get<uint64_t>();
+                        }
+                    }
+                    context->queue.emplace(XGCS_STREAM_QUEUE_HIGH_WATERMARK, XGCS_STREAM_QUEUE_LOW_WATERMARK,
+                                           context->overflow, context->batch_max_bytes);
+                    vehicleId = context->vehicleId;
+                    context->subscribed = ConnectionManager::instance().start_mavlink_streaming(vehicleId);
+                    g_websocket_connections[vehicleId].push_back(context);
+                    g_conn_to_vehicle[&conn] = std::move(context);
+                    LOG_INFO("Server") << "WebSocket opened for vehicle: " << vehicleId;
                     return;
                 } else {
-                    vehicleId = it->second;
+                    context = it->second;
+                    vehicleId = context->vehicleId;
+                }
+            }
+
+            // Later messages are stream controls, see StreamFilter::apply()
+            std::string error;
+            json command = json::parse(data, nullptr, false);
+            bool applied;
+            {
+                std::lock_guard<std::mutex> lock(context->mutex);
+                applied = context->filter.apply(command, error);
+            }
+            if (!applied) {
+                LOG_DEBUG("Server").vehicle(vehicleId) << "Rejected stream control: " << error;
+                conn.send_text(json{{"error", error}}.dump());
+            }
+        });
+
+        // Telemetry snapshot channel, replacing GET /telemetry polling. The first
+        // message picks the vehicle and rate, either the bare vehicleId (5 Hz)
+        // or {"vehicleId": "...", "hz": 10, "keyframeSec": 5}. The server then
+        // pushes {"type": "keyframe", "time": ms, "data": {...}} on connect and
+        // every keyframeSec, and in between {"type": "delta", "time": ms,
+        // "changes": {...}} carrying only the fields that changed, as a JSON
+        // merge patch. Nothing is sent for a tick where nothing changed.
+        // "topic": "link_stats" in the first message follows the vehicle's
+        // per-message link statistics (get_link_stats()) instead, and
+        // "compression" works as on the MAVLink stream.
+        CROW_ROUTE(app, "/api/telemetry/stream")
+        .websocket(&app)
+        .onopen([&](crow::websocket::connection& conn) {
+            // Wait for the first message to get the vehicleId
+        })
+        .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t code) {
+            std::shared_ptr<TelemetryWSContext> context;
+            {
+                std::lock_guard<std::mutex> lock(g_telemetry_mutex);
+                auto it = g_telemetry_clients.find(&conn);
+                if (it == g_telemetry_clients.end()) return;
+                context = std::move(it->second);
+                g_telemetry_clients.erase(it);
+            }
+            std::lock_guard<std::mutex> send_lock(context->send_mutex);
+            context->open = false;
+        })
+        .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+            auto context = std::make_shared<TelemetryWSContext>();
+            context->conn = &conn;
+            context->vehicleId = data;
+            if (!data.empty() && data.front() == '{') {
+                json hello = json::parse(data, nullptr, false);
+                if (hello.is_discarded() || !hello.contains("vehicleId") || !hello["vehicleId"].is_string()) {
+                    conn.close("expected {\"vehicleId\": ..., \"hz\": ...}");
+                    return;
+                }
+                context->vehicleId = hello["vehicleId"].get<std::string>();
+                const json hz = hello.value("hz", json(5));
+                const json keyframe_sec = hello.value("keyframeSec", json(5));
+                if (!hz.is_number() || hz.get<double>() < 0.1 || hz.get<double>() > 50 ||
+                    !keyframe_sec.is_number() || keyframe_sec.get<double>() < 0.1) {
+                    conn.close("expected \"hz\" in 0.1-50 and \"keyframeSec\" >= 0.1");
+                    return;
                 }
+                const json topic = hello.value("topic", json("telemetry"));
+                if (topic == "link_stats") {
+                    context->topic = TelemetryTopic::LinkStats;
+                } else if (topic != "telemetry") {
+                    conn.close("expected \"topic\" telemetry or link_stats");
+                    return;
+                }
+                if (!parse_compression(hello, context->deflater)) {
+                    conn.close(kCompressionUsage);
+                    return;
+                }
+                context->interval_us = static_cast<int64_t>(1e6 / hz.get<double>());
+                context->keyframe_interval_us = static_cast<int64_t>(keyframe_sec.get<double>() * 1e6);
             }
-            // No-op for subsequent messages
+            {
+                std::lock_guard<std::mutex> lock(g_telemetry_mutex);
+                // Only the first message configures the client
+                if (!g_telemetry_clients.emplace(&conn, context).second) return;
+                ++g_telemetry_generation;
+            }
+            g_telemetry_cv.notify_one();
+            LOG_INFO("Server").vehicle(context->vehicleId) << "Telemetry stream opened";
         });
 
-        // Start a background thread to send MAVLink messages to WebSocket clients
-        std::thread([&app]() {
+        // Fleet-wide status stream, replacing /telemetry/all polling. Clients
+        // only listen (bar an optional compression request); every
+        // XGCS_FLEET_STREAM_HZ tick they all receive the same column-oriented
+        // frame (see get_fleet_columns_json()).
+        CROW_ROUTE(app, "/api/fleet/stream")
+        .websocket(&app)
+        .onopen([&](crow::websocket::connection& conn) {
+            auto context = std::make_shared<FleetWSContext>();
+            context->conn = &conn;
+            std::lock_guard<std::mutex> lock(g_fleet_mutex);
+            g_fleet_clients[&conn] = std::move(context);
+        })
+        .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t code) {
+            std::shared_ptr<FleetWSContext> context;
+            {
+                std::lock_guard<std::mutex> lock(g_fleet_mutex);
+                auto it = g_fleet_clients.find(&conn);
+                if (it == g_fleet_clients.end()) return;
+                context = std::move(it->second);
+                g_fleet_clients.erase(it);
+            }
+            std::lock_guard<std::mutex> send_lock(context->send_mutex);
+            context->open = false;
+        })
+        .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+            // Optional, once: {"compression": {...}}. Frames sent before it
+            // arrive as plain text, later ones as binary with a header byte.
+            std::shared_ptr<FleetWSContext> context;
+            {
+                std::lock_guard<std::mutex> lock(g_fleet_mutex);
+                auto it = g_fleet_clients.find(&conn);
+                if (it == g_fleet_clients.end()) return;
+                context = it->second;
+            }
+            const json hello = json::parse(data, nullptr, false);
+            bool valid = hello.is_object();
+            if (valid) {
+                std::lock_guard<std::mutex> send_lock(context->send_mutex);
+                if (context->deflater) return;
+                valid = parse_compression(hello, context->deflater);
+            }
+            if (!valid) conn.close(kCompressionUsage);
+        });
+
+        // Background thread that pushes MAVLink messages to WebSocket clients.
+        // It sleeps until the ingest path streams a frame, so delivery latency
+        // is a wakeup rather than a polling period. Under load it drains
+        // everything queued since the last pass, which batches naturally; an
+        // optional window (XGCS_STREAM_BATCH_WINDOW_MS) trades latency for
+        // fewer, larger passes.
+        std::thread stream_sender([]() {
+            auto& cm = ConnectionManager::instance();
+            uint64_t epoch = cm.mavlink_message_epoch();
+            int64_t next_due_us = std::numeric_limits<int64_t>::max();
+            auto steady_now_us = [] {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            };
             while (!g_shutdown_requested) {
                 try {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 10 Hz
-                    
-                    auto& cm = ConnectionManager::instance();
-                    auto vehicles = cm.get_connected_vehicles();
+                    // Timeout bounds how long a shutdown can go unnoticed, and
+                    // is cut short when a rate-capped frame falls due
+                    auto timeout = std::chrono::milliseconds(500);
+                    if (next_due_us != std::numeric_limits<int64_t>::max()) {
+                        const int64_t wait_us = next_due_us - steady_now_us();
+                        timeout = std::min(timeout, std::chrono::milliseconds(std::max<int64_t>(0, (wait_us + 999) / 1000)));
+                    }
+                    epoch = cm.wait_for_mavlink_messages(epoch, timeout);
+                    if (g_shutdown_requested) break;
+                    if (kStreamBatchWindow.count() > 0) {
+                        std::this_thread::sleep_for(kStreamBatchWindow);
+                    }
+
+                    // Only vehicles someone is watching; frames for the rest
+                    // stay raw in the ring and are never decoded
+                    std::vector<std::string> vehicles;
+                    {
+                        std::lock_guard<std::mutex> lock(g_websocket_mutex);
+                        for (const auto& [id, connections] : g_websocket_connections) {
+                            if (!connections.empty()) vehicles.push_back(id);
+                        }
+                    }
                     
+                    const int64_t now_us = steady_now_us();
+                    next_due_us = std::numeric_limits<int64_t>::max();
                     for (const auto& vehicleId : vehicles) {
-                        auto messages = cm.get_mavlink_messages(vehicleId);
-                        
-                        if (!messages.empty()) {
+                        auto batch = cm.get_mavlink_messages(vehicleId);
+
+                        // Snapshot the audience, then send without the registry lock
+                        std::vector<std::shared_ptr<MavlinkWSContext>> clients;
+                        {
                             std::lock_guard<std::mutex> lock(g_websocket_mutex);
                             auto it = g_websocket_connections.find(vehicleId);
-                            if (it != g_websocket_connections.end()) {
-                                for (const auto& msg : messages) {
-                                    for (auto* conn : it->second) {
-                                        try {
-                                            conn->send_text(msg.dump());
-                                        } catch (...) {
-                                            // Connection might be closed, ignore
-                                        }
+                            if (it != g_websocket_connections.end()) clients = it->second;
+                        }
+
+                        // Each client's filter runs before anything is encoded, so
+                        // messages nobody selected are never serialized. What does
+                        // go out is serialized once per format into an immutable
+                        // buffer that every client of that format shares, and is
+                        // queued for the writer rather than sent from here.
+                        for (const auto& client : clients) {
+                            bool wake_writer = false;
+                            bool overflowed = false;
+                            {
+                                std::lock_guard<std::mutex> lock(client->mutex);
+                                auto push = [&](const ConnectionManager::StreamBatch& source, const StreamMessage& msg) {
+                                    if (overflowed) return;
+                                    auto payload = source.encode(msg, client->format);
+                                    if (!payload) return;
+                                    switch (client->queue->push({std::move(payload), msg.frame.message.msgid,
+                                                                 client->format != StreamFormat::Json, now_us})) {
+                                        case StreamClientQueue::PushResult::QueuedFirst:
+                                        case StreamClientQueue::PushResult::QueuedFlush: wake_writer = true; break;
+                                        case StreamClientQueue::PushResult::Overflow: overflowed = true; break;
+                                        case StreamClientQueue::PushResult::Queued: break;
+                                    }
+                                };
+                                auto enqueue = [&](const StreamMessage& msg) { push(batch, msg); };
+
+                                // A resuming client first gets what it missed, up to
+                                // where this live batch starts. Anything the ring has
+                                // already overwritten is reported as a gap, and a
+                                // position the stream never reached as a reset.
+                                if (client->resume_from && batch.valid()) {
+                                    const uint64_t from = *client->resume_from;
+                                    const uint64_t to = batch.start_sequence();
+                                    client->resume_from.reset();
+                                    auto replay = cm.replay_mavlink_messages(vehicleId, std::min(from, to), to);
+                                    json marker;
+                                    if (from > to) {
+                                        marker = {{"type", "reset"}, {"next", to}};
+                                    } else if (replay.start_sequence() > from) {
+                                        marker = {{"type", "gap"}, {"from", from}, {"to", std::min(replay.start_sequence(), to)}};
+                                    }
+                                    if (!marker.is_null()) {
+                                        // Control frame, sent ahead of anything queued
+                                        std::lock_guard<std::mutex> send_lock(client->send_mutex);
+                                        if (client->open) client->conn->send_text(marker.dump());
                                     }
+                                    for (const auto& msg : replay.messages()) {
+                                        if (client->filter.offer(msg, now_us) == StreamFilter::Verdict::Send) push(replay, msg);
+                                    }
+                                }
+                                if (batch.empty() && !client->filter.has_held() && !wake_writer) continue;
+                                for (const auto& msg : batch.messages()) {
+                                    if (client->filter.offer(msg, now_us) == StreamFilter::Verdict::Send) enqueue(msg);
+                                }
+                                // Latest values held back by a rate cap
+                                client->filter.take_due(now_us, enqueue);
+                                next_due_us = std::min(next_due_us, client->filter.next_due_us());
+                            }
+
+                            if (overflowed) {
+                                std::lock_guard<std::mutex> send_lock(client->send_mutex);
+                                if (client->open) {
+                                    LOG_WARN("Server").vehicle(vehicleId) << "Stream client fell behind its queue limit, disconnecting";
+                                    client->open = false;
+                                    client->conn->close("stream queue overflow");
+                                }
+                            } else if (wake_writer) {
+                                {
+                                    std::lock_guard<std::mutex> ready_lock(g_stream_ready_mutex);
+                                    g_stream_ready.push_back(client);
                                 }
+                                g_stream_ready_cv.notify_one();
                             }
                         }
                     }
                 } catch (const std::exception& e) {
-                    std::cerr << "[ERROR] Exception in WebSocket thread: " << e.what() << std::endl;
+                    LOG_ERROR("Server") << "Exception in WebSocket thread: " << e.what();
                     // Continue running despite errors
                 }
             }
-        }).detach();
+        });
+
+        // Hands queued frames to Crow, one client at a time. Each client's
+        // backlog is taken in one swap and sent outside its queue lock, so
+        // the fan-out above never waits on a socket. Batching clients are
+        // parked until their window closes or their backlog reaches the
+        // batch size, then everything queued goes out as one frame: a JSON
+        // array of envelopes, or for binary formats each payload prefixed
+        // with its uint32 little-endian length.
+        std::thread stream_writer([]() {
+            std::vector<StreamClientQueue::Item> items;
+            std::string frame;
+            std::string wire; // Compressed copy of a frame
+            std::multimap<int64_t, std::shared_ptr<MavlinkWSContext>> parked; // Flush time -> client
+            auto steady_now_us = [] {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            };
+            while (true) {
+                std::shared_ptr<MavlinkWSContext> client;
+                if (!parked.empty() && parked.begin()->first <= steady_now_us()) {
+                    client = std::move(parked.begin()->second);
+                    parked.erase(parked.begin());
+                } else {
+                    std::unique_lock<std::mutex> lock(g_stream_ready_mutex);
+                    auto has_work = [] { return !g_stream_ready.empty() || g_shutdown_requested; };
+                    if (parked.empty()) {
+                        g_stream_ready_cv.wait(lock, has_work);
+                    } else {
+                        const auto flush_at = std::chrono::steady_clock::time_point(std::chrono::microseconds(parked.begin()->first));
+                        g_stream_ready_cv.wait_until(lock, flush_at, has_work);
+                    }
+                    if (g_shutdown_requested) break;
+                    if (g_stream_ready.empty()) continue;
+                    client = std::move(g_stream_ready.front());
+                    g_stream_ready.pop_front();
+                }
+
+                const int64_t now_us = steady_now_us();
+                if (client->batch) {
+                    const auto backlog = client->queue->stats();
+                    if (backlog.depth == 0) continue;
+                    const int64_t flush_us = backlog.oldest_queued_us + client->batch_window_us;
+                    if (flush_us > now_us && backlog.bytes < client->batch_max_bytes) {
+                        parked.emplace(flush_us, client);
+                        continue;
+                    }
+                }
+                client->queue->take_all(items);
+                if (items.empty()) continue;
+
+                std::lock_guard<std::mutex> send_lock(client->send_mutex);
+                if (!client->open) continue;
+                auto send_frame = [&](const std::string& payload, bool binary, std::size_t messages) {
+                    StreamDeflater::Result deflated;
+                    if (client->deflater) {
+                        // Compressed clients always get binary frames with a header byte
+                        wire.clear();
+                        deflated = client->deflater->encode(payload, wire);
+                    }
+                    try {
+                        if (client->deflater) {
+                            client->conn->send_binary(wire);
+                        } else if (binary) {
+                            client->conn->send_binary(payload);
+                        } else {
+                            client->conn->send_text(payload);
+                        }
+                    } catch (...) {
+                        // Connection might be closed, ignore
+                    }
+                    std::lock_guard<std::mutex> stats_lock(client->stats_mutex);
+                    client->frame_messages.add(static_cast<uint32_t>(messages));
+                    client->frame_bytes.add(static_cast<uint32_t>(payload.size()));
+                    if (client->deflater) {
+                        client->deflate_cpu_ns += deflated.cpu_ns;
+                        client->deflate_in_bytes += payload.size();
+                        client->deflate_out_bytes += wire.size();
+                        if (deflated.compressed) ++client->deflated_frames;
+                    }
+                };
+
+                if (!client->batch) {
+                    for (const auto& item : items) send_frame(*item.payload, item.binary, 1);
+                } else {
+                    const bool binary = items.front().binary;
+                    std::size_t messages = 0;
+                    frame.clear();
+                    for (const auto& item : items) {
+                        // A backlog bigger than the batch size splits into several frames
+                        if (messages > 0 && frame.size() + item.payload->size() > client->batch_max_bytes) {
+                            if (!binary) frame += ']';
+                            send_frame(frame, binary, messages);
+                            frame.clear();
+                            messages = 0;
+                        }
+                        if (binary) {
+                            const auto size = static_cast<uint32_t>(item.payload->size());
+                            for (int shift = 0; shift < 32; shift += 8) frame += static_cast<char>((size >> shift) & 0xFF);
+                        } else {
+                            frame += messages == 0 ? '[' : ',';
+                        }
+                        frame += *item.payload;
+                        ++messages;
+                    }
+                    if (!binary) frame += ']';
+                    send_frame(frame, binary, messages);
+                }
+
+                std::lock_guard<std::mutex> stats_lock(client->stats_mutex);
+                for (const auto& item : items) {
+                    client->queue_latency_us.add(static_cast<uint32_t>(std::max<int64_t>(0, now_us - item.queued_us)));
+                }
+            }
+        });
+
+        // Pushes telemetry snapshots to /api/telemetry/stream clients as each
+        // falls due. A vehicle's snapshot is taken once per tick however many
+        // clients are due for it, then diffed against what each client last saw.
+        std::thread telemetry_publisher([]() {
+            auto& cm = ConnectionManager::instance();
+            auto steady_now_us = [] {
+                return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            };
+            std::vector<std::shared_ptr<TelemetryWSContext>> clients;
+            std::unordered_map<std::string, json> snapshots;  // This tick's, by vehicle
+            std::unordered_map<std::string, json> link_stats; // Likewise, for the link_stats topic
+            std::string wire; // Compressed frame scratch
+            while (true) {
+                int64_t now_us = steady_now_us();
+                {
+                    std::unique_lock<std::mutex> lock(g_telemetry_mutex);
+                    int64_t wake_us = now_us + 1000000;
+                    for (const auto& [conn, client] : g_telemetry_clients) wake_us = std::min(wake_us, client->next_due_us);
+                    if (wake_us > now_us) {
+                        const uint64_t generation = g_telemetry_generation;
+                        g_telemetry_cv.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::microseconds(wake_us)),
+                                                  [&] { return g_shutdown_requested || g_telemetry_generation != generation; });
+                    }
+                    if (g_shutdown_requested) break;
+                    now_us = steady_now_us();
+                    clients.clear();
+                    for (const auto& [conn, client] : g_telemetry_clients) {
+                        if (client->next_due_us <= now_us) clients.push_back(client);
+                    }
+                }
+
+                snapshots.clear();
+                link_stats.clear();
+                for (const auto& client : clients) {
+                    client->next_due_us = std::max(client->next_due_us + client->interval_us, now_us);
+                    const bool follows_link_stats = client->topic == TelemetryTopic::LinkStats;
+                    auto& documents = follows_link_stats ? link_stats : snapshots;
+                    auto snapshot = documents.find(client->vehicleId);
+                    if (snapshot == documents.end()) {
+                        snapshot = documents.emplace(client->vehicleId, follows_link_stats
+                            ? cm.get_link_stats(client->vehicleId)
+                            : cm.get_telemetry_data(client->vehicleId)).first;
+                    }
+
+                    const auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                    json frame;
+                    if (now_us >= client->next_keyframe_us) {
+                        frame = {{"type", "keyframe"}, {"time", time_ms}, {"data", snapshot->second}};
+                        client->next_keyframe_us = now_us + client->keyframe_interval_us;
+                    } else {
+                        json changes = json_merge_diff(client->last_sent, snapshot->second);
+                        if (changes.empty()) continue;
+                        frame = {{"type", "delta"}, {"time", time_ms}, {"changes", std::move(changes)}};
+                    }
+                    client->last_sent = snapshot->second;
+
+                    std::lock_guard<std::mutex> send_lock(client->send_mutex);
+                    if (!client->open) continue;
+                    send_json_frame(*client->conn, client->deflater, frame.dump(), wire);
+                }
+            }
+        });
 
-        std::cout << "[INFO] Starting server on port 8081..." << std::endl;
-        std::cout << "[INFO] Server initialized successfully" << std::endl;
+        // Builds the fleet frame once per tick, only while someone is listening,
+        // and sends the same serialized buffer to every fleet client.
+        std::thread fleet_publisher([]() {
+            auto& cm = ConnectionManager::instance();
+            const auto period = std::chrono::microseconds(1000000 / std::max(1, XGCS_FLEET_STREAM_HZ));
+            auto next_tick = std::chrono::steady_clock::now();
+            std::vector<std::shared_ptr<FleetWSContext>> clients;
+            std::string wire; // Compressed frame scratch
+            while (true) {
+                next_tick += period;
+                {
+                    std::unique_lock<std::mutex> lock(g_fleet_mutex);
+                    g_fleet_cv.wait_until(lock, next_tick, [] { return g_shutdown_requested.load(); });
+                    if (g_shutdown_requested) break;
+                    clients.clear();
+                    for (const auto& [conn, client] : g_fleet_clients) clients.push_back(client);
+                }
+                // Don't try to catch up after a stall
+                next_tick = std::max(next_tick, std::chrono::steady_clock::now());
+                if (clients.empty()) continue;
+
+                std::string frame;
+                try {
+                    frame = cm.get_fleet_columns_json();
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Server") << "Exception building fleet frame: " << e.what();
+                    continue;
+                }
+                for (const auto& client : clients) {
+                    std::lock_guard<std::mutex> send_lock(client->send_mutex);
+                    if (!client->open) continue;
+                    send_json_frame(*client->conn, client->deflater, frame, wire);
+                }
+            }
+        });
+
+        // Synthetic radio links for every vehicle with radio simulation
+        // enabled, recomputed as one batch per tick so reads never pay for it
+        std::thread radio_simulator([]() {
+            auto& cm = ConnectionManager::instance();
+            const auto period = std::chrono::microseconds(1000000 / std::max(1, XGCS_RADIO_SIM_HZ));
+            auto next_tick = std::chrono::steady_clock::now();
+            while (true) {
+                next_tick += period;
+                {
+                    std::unique_lock<std::mutex> lock(g_radio_sim_mutex);
+                    g_radio_sim_cv.wait_until(lock, next_tick, [] { return g_shutdown_requested.load(); });
+                    if (g_shutdown_requested) break;
+                }
+                // Don't try to catch up after a stall
+                next_tick = std::max(next_tick, std::chrono::steady_clock::now());
+                try {
+                    cm.update_radio_simulation();
+                } catch (const std::exception& e) {
+                    LOG_ERROR_EVERY_MS(5000, "Radio") << "Exception in radio simulation: " << e.what();
+                }
+            }
+        });
+
+        // Stops and joins the stream threads however this scope is left
+        struct StreamSenderJoiner {
+            std::thread& sender;
+            std::thread& writer;
+            std::thread& telemetry;
+            std::thread& fleet;
+            std::thread& radio;
+            void stop() {
+                g_shutdown_requested = true;
+                ConnectionManager::instance().shutdown_mavlink_streams();
+                // Pairs with the predicate checks in the writer's and publishers' waits
+                { std::lock_guard<std::mutex> lock(g_stream_ready_mutex); }
+                g_stream_ready_cv.notify_all();
+                { std::lock_guard<std::mutex> lock(g_telemetry_mutex); }
+                g_telemetry_cv.notify_all();
+                { std::lock_guard<std::mutex> lock(g_fleet_mutex); }
+                g_fleet_cv.notify_all();
+                { std::lock_guard<std::mutex> lock(g_radio_sim_mutex); }
+                g_radio_sim_cv.notify_all();
+                if (sender.joinable()) sender.join();
+                if (writer.joinable()) writer.join();
+                if (telemetry.joinable()) telemetry.join();
+                if (fleet.joinable()) fleet.join();
+                if (radio.joinable()) radio.join();
+            }
+            ~StreamSenderJoiner() { stop(); }
+        } stream_sender_joiner{stream_sender, stream_writer, telemetry_publisher, fleet_publisher, radio_simulator};
+
+        LOG_INFO("Server") << "Starting server on port 8081...";
+        LOG_INFO("Server") << "Server initialized successfully";
         
         // SWE100821: Add graceful shutdown handling
         app.bindaddr("0.0.0.0").port(8081).run();
+
+        // Crow handles SIGINT/SIGTERM itself while running
+        stream_sender_joiner.stop();
         
-        std::cout << "[INFO] Server shutdown complete" << std::endl;
+        LOG_INFO("Server") << "Server shutdown complete";
+        Logger::instance().shutdown(); // Flush queued records before exit
         return 0;
         
     } catch (const std::exception& e) {
-        std::cerr << "[FATAL] Unhandled exception in main: " << e.what() << std::endl;
+        LOG_FATAL("Server") << "Unhandled exception in main: " << e.what();
+        Logger::instance().shutdown();
         return 1;
     } catch (...) {
-        std::cerr << "[FATAL] Unknown exception in main" << std::endl;
+        LOG_FATAL("Server") << "Unknown exception in main";
+        Logger::instance().shutdown();
         return 1;
     }
 }
\ No newline at end of file
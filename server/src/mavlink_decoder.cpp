@@ -0,0 +1,193 @@
+#include "mavlink_decoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace {
+
+// Generated metadata for every message in the dialect
+const mavlink_message_info_t kMessageInfo[] = MAVLINK_MESSAGE_INFO;
+
+// Copies `size` bytes at `offset` out of the payload. Anything past the
+// received length reads as zero, matching mavlink_msg_*_decode().
+void read_payload(const mavlink_message_t& message, std::size_t offset, void* out, std::size_t size) {
+    const char* payload = _MAV_PAYLOAD(&message);
+    const std::size_t len = message.len;
+    std::memset(out, 0, size);
+    if (offset >= len) return;
+    std::memcpy(out, payload + offset, offset + size <= len ? size : len - offset);
+}
+
+template <typename T>
+T read_scalar(const mavlink_message_t& message, std::size_t offset) {
+    T value;
+    read_payload(message, offset, &value, sizeof(T));
+    return value;
+}
+
+json read_element(const mavlink_message_t& message, mavlink_message_type_t type, std::size_t offset) {
+    switch (type) {
+        case MAVLINK_TYPE_CHAR:     return read_scalar<char>(message, offset);
+        case MAVLINK_TYPE_UINT8_T:  return read_scalar<uint8_t>(message, offset);
+        case MAVLINK_TYPE_INT8_T:   return read_scalar<int8_t>(message, offset);
+        case MAVLINK_TYPE_UINT16_T: return read_scalar<uint16_t>(message, offset);
+        case MAVLINK_TYPE_INT16_T:  return read_scalar<int16_t>(message, offset);
+        case MAVLINK_TYPE_UINT32_T: return read_scalar<uint32_t>(message, offset);
+        case MAVLINK_TYPE_INT32_T:  return read_scalar<int32_t>(message, offset);
+        case MAVLINK_TYPE_UINT64_T: return read_scalar<uint64_t>(message, offset);
+        case MAVLINK_TYPE_INT64_T:  return read_scalar<int64_t>(message, offset);
+        case MAVLINK_TYPE_FLOAT:    return read_scalar<float>(message, offset);
+        case MAVLINK_TYPE_DOUBLE:   return read_scalar<double>(message, offset);
+    }
+    return nullptr;
+}
+
+template <typename T>
+void write_scalar(const mavlink_message_t& message, std::size_t offset, JsonWriter& out) {
+    out.value(read_scalar<T>(message, offset));
+}
+
+void write_element(const mavlink_message_t& message, mavlink_message_type_t type, std::size_t offset, JsonWriter& out) {
+    switch (type) {
+        case MAVLINK_TYPE_CHAR:     write_scalar<int8_t>(message, offset, out); return;
+        case MAVLINK_TYPE_UINT8_T:  write_scalar<uint8_t>(message, offset, out); return;
+        case MAVLINK_TYPE_INT8_T:   write_scalar<int8_t>(message, offset, out); return;
+        case MAVLINK_TYPE_UINT16_T: write_scalar<uint16_t>(message, offset, out); return;
+        case MAVLINK_TYPE_INT16_T:  write_scalar<int16_t>(message, offset, out); return;
+        case MAVLINK_TYPE_UINT32_T: write_scalar<uint32_t>(message, offset, out); return;
+        case MAVLINK_TYPE_INT32_T:  write_scalar<int32_t>(message, offset, out); return;
+        case MAVLINK_TYPE_UINT64_T: write_scalar<uint64_t>(message, offset, out); return;
+        case MAVLINK_TYPE_INT64_T:  write_scalar<int64_t>(message, offset, out); return;
+        case MAVLINK_TYPE_FLOAT:    write_scalar<float>(message, offset, out); return;
+        case MAVLINK_TYPE_DOUBLE:   write_scalar<double>(message, offset, out); return;
+    }
+    out.null();
+}
+
+} // namespace
+
+const MavlinkDecoder& MavlinkDecoder::instance() {
+    static MavlinkDecoder decoder;
+    return decoder;
+}
+
+MavlinkDecoder::MavlinkDecoder() {
+    for (const auto& info : kMessageInfo) {
+        Entry& entry = _by_id[info.msgid];
+        if (entry.info) continue; // Duplicate id across included dialects; first wins
+        entry.info = &info;
+        entry.name = info.name;
+        _by_name.emplace(entry.name, info.msgid);
+        for (unsigned i = 0; i < info.num_fields; ++i) {
+            entry.sorted_fields[i] = static_cast<uint8_t>(i);
+        }
+        std::sort(entry.sorted_fields.begin(), entry.sorted_fields.begin() + info.num_fields,
+                  [&info](uint8_t a, uint8_t b) {
+                      return std::string_view(info.fields[a].name) < std::string_view(info.fields[b].name);
+                  });
+        ++_count;
+    }
+}
+
+const mavlink_message_info_t* MavlinkDecoder::info(uint32_t msgid) const {
+    const Entry* entry = _by_id.find(msgid);
+    return entry ? entry->info : nullptr;
+}
+
+std::string_view MavlinkDecoder::name(uint32_t msgid) const {
+    const Entry* entry = _by_id.find(msgid);
+    return entry ? entry->name : std::string_view();
+}
+
+bool MavlinkDecoder::find_msgid(std::string_view name, uint32_t& msgid) const {
+    auto it = _by_name.find(name);
+    if (it == _by_name.end()) return false;
+    msgid = it->second;
+    return true;
+}
+
+std::size_t MavlinkDecoder::type_size(mavlink_message_type_t type) {
+    switch (type) {
+        case MAVLINK_TYPE_CHAR:
+        case MAVLINK_TYPE_UINT8_T:
+        case MAVLINK_TYPE_INT8_T:   return 1;
+        case MAVLINK_TYPE_UINT16_T:
+        case MAVLINK_TYPE_INT16_T:  return 2;
+        case MAVLINK_TYPE_UINT32_T:
+        case MAVLINK_TYPE_INT32_T:
+        case MAVLINK_TYPE_FLOAT:    return 4;
+        case MAVLINK_TYPE_UINT64_T:
+        case MAVLINK_TYPE_INT64_T:
+        case MAVLINK_TYPE_DOUBLE:   return 8;
+    }
+    return 0;
+}
+
+json MavlinkDecoder::decode_field(const mavlink_message_t& message, const mavlink_field_info_t& field) {
+    if (field.array_length == 0) {
+        if (field.type == MAVLINK_TYPE_CHAR) {
+            const char c = read_scalar<char>(message, field.wire_offset);
+            return c ? std::string(1, c) : std::string();
+        }
+        return read_element(message, field.type, field.wire_offset);
+    }
+
+    if (field.type == MAVLINK_TYPE_CHAR) {
+        // Fixed-size, not necessarily NUL-terminated
+        char text[MAVLINK_MAX_PAYLOAD_LEN + 1];
+        const std::size_t size = field.array_length < MAVLINK_MAX_PAYLOAD_LEN ? field.array_length : MAVLINK_MAX_PAYLOAD_LEN;
+        read_payload(message, field.wire_offset, text, size);
+        return std::string(text, strnlen(text, size));
+    }
+
+    json values = json::array();
+    values.get_ref<json::array_t&>().reserve(field.array_length);
+    const std::size_t stride = type_size(field.type);
+    for (unsigned i = 0; i < field.array_length; ++i) {
+        values.push_back(read_element(message, field.type, field.wire_offset + i * stride));
+    }
+    return values;
+}
+
+json MavlinkDecoder::decode(const mavlink_message_t& message) const {
+    json fields = json::object();
+    const mavlink_message_info_t* message_info = info(message.msgid);
+    if (!message_info) return fields;
+
+    for (unsigned i = 0; i < message_info->num_fields; ++i) {
+        const mavlink_field_info_t& field = message_info->fields[i];
+        fields[field.name] = decode_field(message, field);
+    }
+    return fields;
+}
+
+void MavlinkDecoder::write_fields(const mavlink_message_t& message, JsonWriter& out) const {
+    out.begin_object();
+    const Entry* entry = _by_id.find(message.msgid);
+    if (entry && entry->info) {
+        const mavlink_message_info_t& message_info = *entry->info;
+        for (unsigned i = 0; i < message_info.num_fields; ++i) {
+            const mavlink_field_info_t& field = message_info.fields[entry->sorted_fields[i]];
+            out.key(field.name);
+            if (field.type == MAVLINK_TYPE_CHAR) {
+                // Strings, as in decode_field(); a lone char is a 1-char string
+                char text[MAVLINK_MAX_PAYLOAD_LEN];
+                const std::size_t size = field.array_length == 0 ? 1
+                    : (field.array_length < MAVLINK_MAX_PAYLOAD_LEN ? field.array_length : MAVLINK_MAX_PAYLOAD_LEN);
+                read_payload(message, field.wire_offset, text, size);
+                out.value(std::string_view(text, strnlen(text, size)));
+            } else if (field.array_length == 0) {
+                write_element(message, field.type, field.wire_offset, out);
+            } else {
+                out.begin_array();
+                const std::size_t stride = type_size(field.type);
+                for (unsigned j = 0; j < field.array_length; ++j) {
+                    write_element(message, field.type, field.wire_offset + j * stride, out);
+                }
+                out.end_array();
+            }
+        }
+    }
+    out.end_object();
+}
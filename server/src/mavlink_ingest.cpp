@@ -0,0 +1,120 @@
+#include "mavlink_ingest.hpp"
+#include "logger.hpp"
+#include <cstring>
+
+MavlinkIngest::MavlinkIngest(std::string vehicle_id) : _vehicle_id(std::move(vehicle_id)) {}
+
+MavlinkIngest::~MavlinkIngest() {
+    detach();
+}
+
+int MavlinkIngest::register_stage(const char* name, Handler handler, void* context) {
+    if (attached()) {
+        LOG_ERROR("Ingest") << "Cannot add stage '" << name << "' to attached pipeline for " << _vehicle_id;
+        return -1;
+    }
+    if (_stage_count >= kMaxStages || !handler) {
+        LOG_ERROR("Ingest") << "Rejected stage '" << name << "' for " << _vehicle_id;
+        return -1;
+    }
+    int index = static_cast<int>(_stage_count++);
+    _stages[index] = Stage{name, handler, context};
+    return index;
+}
+
+int MavlinkIngest::add_stage(const char* name, Handler handler, void* context, std::initializer_list<uint32_t> msgids) {
+    return add_stage(name, handler, context, msgids.begin(), msgids.size());
+}
+
+int MavlinkIngest::add_stage(const char* name, Handler handler, void* context, const uint32_t* msgids, std::size_t count) {
+    int index = register_stage(name, handler, context);
+    if (index < 0) return index;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (msgids[i] > MsgIdTable<uint32_t>::kMaxMsgId) continue;
+        _dispatch[msgids[i]] |= (1u << index);
+    }
+    return index;
+}
+
+int MavlinkIngest::add_stage_all(const char* name, Handler handler, void* context) {
+    int index = register_stage(name, handler, context);
+    if (index < 0) return index;
+    _all_mask |= (1u << index);
+    return index;
+}
+
+void MavlinkIngest::set_stage_enabled(int index, bool enabled) {
+    if (index < 0 || static_cast<std::size_t>(index) >= _stage_count) return;
+    const uint32_t bit = 1u << index;
+    if (enabled) {
+        _enabled_mask.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        _enabled_mask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+bool MavlinkIngest::stage_enabled(int index) const {
+    if (index < 0 || static_cast<std::size_t>(index) >= _stage_count) return false;
+    return (_enabled_mask.load(std::memory_order_relaxed) >> index) & 1u;
+}
+
+int MavlinkIngest::find_stage(const char* name) const {
+    for (std::size_t i = 0; i < _stage_count; ++i) {
+        if (std::strcmp(_stages[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool MavlinkIngest::attached() const {
+    std::lock_guard<std::mutex> lock(_handles_mutex);
+    return !_handles.empty();
+}
+
+std::size_t MavlinkIngest::subscription_count() const {
+    std::lock_guard<std::mutex> lock(_handles_mutex);
+    return _handles.size();
+}
+
+void MavlinkIngest::attach(const std::shared_ptr<mavsdk::MavlinkPassthrough>& passthrough, std::weak_ptr<void> owner) {
+    std::lock_guard<std::mutex> lock(_handles_mutex);
+    if (!passthrough || !_handles.empty()) return;
+    _passthrough = passthrough;
+
+    auto subscribe = [this, &passthrough, &owner](uint16_t msgid) {
+        auto handle = passthrough->subscribe_message(msgid, [this, owner](const mavlink_message_t& message) {
+            // Keeps `this` and every stage context alive until dispatch returns
+            auto alive = owner.lock();
+            if (!alive) return;
+            ingest(message);
+        });
+        _handles.emplace_back(msgid, handle);
+    };
+
+    // Wildcard stages need the whole captured range; keyed stages add their
+    // own ids on top. Each id is subscribed exactly once.
+    if (_all_mask) {
+        for (uint32_t id = kAllMsgIdFirst; id <= kAllMsgIdLast; ++id) {
+            subscribe(static_cast<uint16_t>(id));
+        }
+    }
+    _dispatch.for_each([&](uint32_t msgid, uint32_t mask) {
+        if (!mask || msgid > 0xFFFF) return;
+        if (_all_mask && msgid >= kAllMsgIdFirst && msgid <= kAllMsgIdLast) return;
+        subscribe(static_cast<uint16_t>(msgid));
+    });
+
+    LOG_INFO("Ingest").vehicle(_vehicle_id) << "Attached " << _stage_count << " stage(s) over "
+                                           << _handles.size() << " message id(s)";
+}
+
+void MavlinkIngest::detach() {
+    std::lock_guard<std::mutex> lock(_handles_mutex);
+    if (_handles.empty()) return;
+    if (auto passthrough = _passthrough.lock()) {
+        for (auto& [msgid, handle] : _handles) {
+            passthrough->unsubscribe_message(msgid, handle);
+        }
+    }
+    _handles.clear();
+    _passthrough.reset();
+}
@@ -0,0 +1,67 @@
+#include "radio_link_batch.hpp"
+#include <cmath>
+
+namespace {
+
+constexpr double kDegToRad = M_PI / 180.0;
+constexpr double kEarthRadiusM = 6371e3;
+
+} // namespace
+
+void RadioLinkBatch::clear() {
+    _lat_rad.clear();
+    _lon_rad.clear();
+    _home_lat_rad.clear();
+    _home_lon_rad.clear();
+    _budget_db.clear();
+}
+
+void RadioLinkBatch::reserve(std::size_t links) {
+    _lat_rad.reserve(links);
+    _lon_rad.reserve(links);
+    _home_lat_rad.reserve(links);
+    _home_lon_rad.reserve(links);
+    _budget_db.reserve(links);
+}
+
+void RadioLinkBatch::add(double lat_deg, double lon_deg, double home_lat_deg, double home_lon_deg,
+                         double frequency_mhz, double gain_db) {
+    _lat_rad.push_back(lat_deg * kDegToRad);
+    _lon_rad.push_back(lon_deg * kDegToRad);
+    _home_lat_rad.push_back(home_lat_deg * kDegToRad);
+    _home_lon_rad.push_back(home_lon_deg * kDegToRad);
+    // FSPL(dB) = 20*log10(d_km) + 20*log10(f_MHz) + 32.44; only the distance term varies per tick
+    _budget_db.push_back(gain_db - 20.0 * std::log10(frequency_mhz) - 32.44);
+}
+
+void RadioLinkBatch::compute() {
+    const std::size_t n = size();
+    _distance_m.resize(n);
+    _rssi_dbm.resize(n);
+
+    const double* lat = _lat_rad.data();
+    const double* lon = _lon_rad.data();
+    const double* home_lat = _home_lat_rad.data();
+    const double* home_lon = _home_lon_rad.data();
+    const double* budget = _budget_db.data();
+    double* distance = _distance_m.data();
+    double* rssi = _rssi_dbm.data();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const double half_dphi = 0.5 * (home_lat[i] - lat[i]);
+        const double half_dlam = 0.5 * (home_lon[i] - lon[i]);
+        const double sin_dphi = std::sin(half_dphi);
+        const double sin_dlam = std::sin(half_dlam);
+        double a = sin_dphi * sin_dphi + std::cos(lat[i]) * std::cos(home_lat[i]) * sin_dlam * sin_dlam;
+        a = a < 1.0 ? a : 1.0;
+        const double dist_m = 2.0 * kEarthRadiusM * std::asin(std::sqrt(a));
+        distance[i] = dist_m;
+
+        double dist_km = dist_m * 0.001;
+        dist_km = dist_km > 0.001 ? dist_km : 0.001;
+        double value = budget[i] - 20.0 * std::log10(dist_km);
+        value = value < 0.0 ? value : 0.0;
+        value = value > -120.0 ? value : -120.0; // Noise floor
+        rssi[i] = value;
+    }
+}
@@ -0,0 +1,63 @@
+#include "stream_deflater.hpp"
+#include <ctime>
+
+namespace {
+
+uint64_t thread_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+StreamDeflater::StreamDeflater(int level, bool context_takeover, std::size_t threshold)
+    : _level(level), _context_takeover(context_takeover), _threshold(threshold) {
+    // Negative window bits: raw deflate, no zlib header or checksum
+    _ready = deflateInit2(&_stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+StreamDeflater::~StreamDeflater() {
+    if (_ready) deflateEnd(&_stream);
+}
+
+StreamDeflater::Result StreamDeflater::encode(std::string_view payload, std::string& out) {
+    Result result;
+    if (!_ready || payload.size() < _threshold) {
+        out += kStored;
+        out.append(payload.data(), payload.size());
+        return result;
+    }
+
+    const uint64_t start_ns = thread_cpu_ns();
+    const std::size_t header = out.size();
+    out += kDeflated;
+    const int flush = _context_takeover ? Z_SYNC_FLUSH : Z_FINISH;
+    _stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.data()));
+    _stream.avail_in = static_cast<uInt>(payload.size());
+    int status;
+    do {
+        const std::size_t used = out.size();
+        const std::size_t room = deflateBound(&_stream, _stream.avail_in) + 16;
+        out.resize(used + room);
+        _stream.next_out = reinterpret_cast<Bytef*>(&out[used]);
+        _stream.avail_out = static_cast<uInt>(room);
+        status = deflate(&_stream, flush);
+        out.resize(used + room - _stream.avail_out);
+    } while (status == Z_OK && (_stream.avail_in > 0 || _stream.avail_out == 0));
+
+    if (!_context_takeover) {
+        deflateReset(&_stream);
+        // Independent frames can fall back to stored when deflate does not pay
+        if (out.size() - header - 1 >= payload.size()) {
+            out.resize(header);
+            out += kStored;
+            out.append(payload.data(), payload.size());
+            result.cpu_ns = thread_cpu_ns() - start_ns;
+            return result;
+        }
+    }
+    result.compressed = true;
+    result.cpu_ns = thread_cpu_ns() - start_ns;
+    return result;
+}
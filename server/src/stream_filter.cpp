@@ -0,0 +1,189 @@
+#include "stream_filter.hpp"
+#include "mavlink_decoder.hpp"
+#include <cmath>
+
+namespace {
+
+// Resolves a "messages" list of names and/or numeric ids
+bool parse_message_ids(const json& messages, std::vector<uint32_t>& ids, std::string& error) {
+    if (!messages.is_array()) {
+        error = "\"messages\" must be an array of MAVLink names or ids";
+        return false;
+    }
+    const auto& decoder = MavlinkDecoder::instance();
+    for (const auto& item : messages) {
+        if (item.is_number_unsigned() && item.get<uint64_t>() <= MsgIdTable<int>::kMaxMsgId) {
+            ids.push_back(item.get<uint32_t>());
+        } else if (item.is_string()) {
+            uint32_t msgid = 0;
+            if (!decoder.find_msgid(item.get_ref<const std::string&>(), msgid)) {
+                error = "unknown message: " + item.get<std::string>();
+                return false;
+            }
+            ids.push_back(msgid);
+        } else {
+            error = "invalid message id: " + item.dump();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+StreamFilter::Slot& StreamFilter::slot(uint32_t msgid) {
+    Slot& entry = _slots[msgid];
+    if (!entry.configured) {
+        entry.configured = true;
+        _configured.push_back(msgid);
+    }
+    return entry;
+}
+
+void StreamFilter::release(std::size_t held_index) {
+    // Swap-remove, re-pointing the slot of the frame that moved
+    _slots.find(_held[held_index].frame.message.msgid)->held = -1;
+    if (held_index + 1 != _held.size()) {
+        _held[held_index] = _held.back();
+        _slots.find(_held[held_index].frame.message.msgid)->held = static_cast<int32_t>(held_index);
+    }
+    _held.pop_back();
+}
+
+void StreamFilter::drop_held(uint32_t msgid) {
+    const Slot* entry = _slots.find(msgid);
+    if (entry && entry->held >= 0) release(static_cast<std::size_t>(entry->held));
+}
+
+void StreamFilter::subscribe_all() {
+    _narrowed = false;
+    for (uint32_t msgid : _configured) {
+        Slot* entry = _slots.find(msgid);
+        entry->included = false;
+        entry->excluded = false;
+    }
+}
+
+void StreamFilter::subscribe(const std::vector<uint32_t>& msgids) {
+    if (!_narrowed) {
+        // First subscribe switches from "everything" to "only these"
+        _narrowed = true;
+        for (uint32_t id : _configured) {
+            _slots.find(id)->included = false;
+        }
+        for (std::size_t i = _held.size(); i-- > 0;) {
+            const uint32_t held = _held[i].frame.message.msgid;
+            if (std::find(msgids.begin(), msgids.end(), held) == msgids.end()) release(i);
+        }
+    }
+    for (uint32_t msgid : msgids) {
+        Slot& entry = slot(msgid);
+        entry.included = true;
+        entry.excluded = false;
+    }
+}
+
+void StreamFilter::unsubscribe(uint32_t msgid) {
+    Slot& entry = slot(msgid);
+    entry.included = false;
+    entry.excluded = true;
+    drop_held(msgid);
+}
+
+void StreamFilter::set_rate(uint32_t msgid, double hz) {
+    Slot& entry = slot(msgid);
+    entry.interval_us = hz > 0.0 ? static_cast<int64_t>(std::llround(1e6 / hz)) : 0;
+    if (entry.interval_us == 0) drop_held(msgid);
+}
+
+void StreamFilter::pause() {
+    _paused = true;
+    while (!_held.empty()) release(_held.size() - 1);
+}
+
+bool StreamFilter::apply(const json& command, std::string& error) {
+    if (!command.is_object() || !command.contains("op") || !command["op"].is_string()) {
+        error = "expected {\"op\": ...}";
+        return false;
+    }
+    const std::string& op = command["op"].get_ref<const std::string&>();
+
+    if (op == "pause") {
+        pause();
+        return true;
+    }
+    if (op == "resume") {
+        resume();
+        return true;
+    }
+    if (op != "subscribe" && op != "unsubscribe" && op != "rate") {
+        error = "unknown op: " + op;
+        return false;
+    }
+
+    if (!command.contains("messages")) {
+        error = "\"" + op + "\" needs \"messages\"";
+        return false;
+    }
+    const json& messages = command["messages"];
+    if (op == "subscribe" && messages.is_string() && messages.get_ref<const std::string&>() == "*") {
+        subscribe_all();
+        return true;
+    }
+
+    std::vector<uint32_t> ids;
+    if (!parse_message_ids(messages, ids, error)) return false;
+
+    if (op == "rate") {
+        if (!command.contains("hz") || !command["hz"].is_number()) {
+            error = "\"rate\" needs a numeric \"hz\" (0 removes the cap)";
+            return false;
+        }
+        const double hz = command["hz"].get<double>();
+        if (!std::isfinite(hz)) {
+            error = "\"hz\" must be finite";
+            return false;
+        }
+        for (uint32_t msgid : ids) set_rate(msgid, hz);
+    } else if (op == "subscribe") {
+        subscribe(ids);
+    } else {
+        for (uint32_t msgid : ids) unsubscribe(msgid);
+    }
+    return true;
+}
+
+StreamFilter::Verdict StreamFilter::offer(const StreamMessage& message, int64_t now_us) {
+    if (_paused) return Verdict::Drop;
+
+    const uint32_t msgid = message.frame.message.msgid;
+    Slot* entry = _slots.find(msgid);
+    const bool selected = _narrowed ? (entry && entry->included) : !(entry && entry->excluded);
+    if (!selected) return Verdict::Drop;
+    if (!entry || entry->interval_us == 0) return Verdict::Send;
+
+    if (now_us - entry->last_sent_us >= entry->interval_us) {
+        // Anything held for this id is older than this frame
+        drop_held(msgid);
+        entry->last_sent_us = now_us;
+        return Verdict::Send;
+    }
+
+    // Too soon: keep only the latest value
+    if (entry->held >= 0) {
+        _held[static_cast<std::size_t>(entry->held)] = message;
+    } else {
+        entry->held = static_cast<int32_t>(_held.size());
+        _held.push_back(message);
+    }
+    return Verdict::Hold;
+}
+
+int64_t StreamFilter::next_due_us() const {
+    int64_t due = std::numeric_limits<int64_t>::max();
+    for (const auto& message : _held) {
+        const Slot* entry = _slots.find(message.frame.message.msgid);
+        due = std::min(due, entry->last_sent_us + entry->interval_us);
+    }
+    return due;
+}
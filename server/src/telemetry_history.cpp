@@ -0,0 +1,182 @@
+#include "telemetry_history.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr const char* kChannelNames[kHistoryChannelCount] = {
+    "lat", "lng", "alt", "heading", "groundspeed", "airspeed", "climb", "battery", "voltage", "rssi"
+};
+
+} // namespace
+
+TelemetryHistory::TelemetryHistory(std::size_t budget_bytes, int64_t interval_ms)
+    : _capacity(std::max<std::size_t>(2, budget_bytes / kRowBytes)), _interval_ms(interval_ms) {
+    _time_ms.resize(_capacity);
+    for (auto& column : _precise) column.resize(_capacity);
+    for (std::size_t c = kHistoryPreciseChannelCount; c < kHistoryChannelCount; ++c) _columns[c].resize(_capacity);
+    _current.fill(std::numeric_limits<double>::quiet_NaN());
+}
+
+void TelemetryHistory::record(int64_t now_ms, std::initializer_list<Value> values) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const Value& value : values) {
+        _current[static_cast<std::size_t>(value.channel)] = value.value;
+    }
+    // range() relies on rows being in time order
+    now_ms = std::max(now_ms, _last_append_ms);
+    if (now_ms - _last_append_ms >= _interval_ms) append(now_ms);
+}
+
+void TelemetryHistory::append(int64_t now_ms) {
+    _time_ms[_next] = now_ms;
+    for (std::size_t c = 0; c < kHistoryPreciseChannelCount; ++c) {
+        _precise[c][_next] = _current[c];
+    }
+    for (std::size_t c = kHistoryPreciseChannelCount; c < kHistoryChannelCount; ++c) {
+        _columns[c][_next] = static_cast<float>(_current[c]);
+    }
+    _next = (_next + 1) % _capacity;
+    if (_size < _capacity) ++_size;
+    _last_append_ms = now_ms;
+}
+
+std::size_t TelemetryHistory::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+std::vector<TelemetryHistory::Series> TelemetryHistory::range(const std::vector<HistoryChannel>& channels,
+                                                              int64_t from_ms, int64_t to_ms) const {
+    std::vector<Series> out(channels.size());
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::size_t oldest = (_next + _capacity - _size) % _capacity;
+    auto at = [&](std::size_t i) { return (oldest + i) % _capacity; };
+
+    // Rows are in time order, so the range is found by binary search
+    std::size_t lo = 0, hi = _size;
+    while (lo < hi) {
+        const std::size_t mid = (lo + hi) / 2;
+        if (_time_ms[at(mid)] < from_ms) lo = mid + 1; else hi = mid;
+    }
+    const std::size_t first = lo;
+    hi = _size;
+    while (lo < hi) {
+        const std::size_t mid = (lo + hi) / 2;
+        if (_time_ms[at(mid)] <= to_ms) lo = mid + 1; else hi = mid;
+    }
+    const std::size_t last = lo;
+
+    for (std::size_t k = 0; k < channels.size(); ++k) {
+        const std::size_t c = static_cast<std::size_t>(channels[k]);
+        Series& series = out[k];
+        series.time_ms.reserve(last - first);
+        series.values.reserve(last - first);
+        auto copy = [&](const auto& column) {
+            for (std::size_t i = first; i < last; ++i) {
+                const double value = column[at(i)];
+                if (std::isnan(value)) continue;
+                series.time_ms.push_back(_time_ms[at(i)]);
+                series.values.push_back(value);
+            }
+        };
+        if (c < kHistoryPreciseChannelCount) copy(_precise[c]); else copy(_columns[c]);
+    }
+    return out;
+}
+
+const char* TelemetryHistory::channel_name(HistoryChannel channel) {
+    const auto index = static_cast<std::size_t>(channel);
+    return index < kHistoryChannelCount ? kChannelNames[index] : "unknown";
+}
+
+bool TelemetryHistory::parse_channel(std::string_view name, HistoryChannel& channel) {
+    for (std::size_t i = 0; i < kHistoryChannelCount; ++i) {
+        if (name == kChannelNames[i]) {
+            channel = static_cast<HistoryChannel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+TelemetryHistory::Series downsample_lttb(const TelemetryHistory::Series& in, std::size_t max_points) {
+    const std::size_t n = in.values.size();
+    if (max_points < 3 || n <= max_points) return in;
+
+    TelemetryHistory::Series out;
+    out.time_ms.reserve(max_points);
+    out.values.reserve(max_points);
+    auto keep = [&](std::size_t i) {
+        out.time_ms.push_back(in.time_ms[i]);
+        out.values.push_back(in.values[i]);
+    };
+
+    // First and last points are always kept; the rest are split into
+    // max_points - 2 buckets, and each bucket keeps the point forming the
+    // largest triangle with the previous kept point and the next bucket's mean.
+    const double every = static_cast<double>(n - 2) / static_cast<double>(max_points - 2);
+    std::size_t a = 0;
+    keep(a);
+    for (std::size_t bucket = 0; bucket < max_points - 2; ++bucket) {
+        const std::size_t start = static_cast<std::size_t>(bucket * every) + 1;
+        const std::size_t end = std::min(static_cast<std::size_t>((bucket + 1) * every) + 1, n - 1);
+
+        const std::size_t next_start = end;
+        const std::size_t next_end = std::min(static_cast<std::size_t>((bucket + 2) * every) + 1, n);
+        double avg_t = 0, avg_v = 0;
+        for (std::size_t i = next_start; i < next_end; ++i) {
+            avg_t += static_cast<double>(in.time_ms[i]);
+            avg_v += in.values[i];
+        }
+        const double count = static_cast<double>(std::max<std::size_t>(1, next_end - next_start));
+        avg_t /= count;
+        avg_v /= count;
+
+        const double a_t = static_cast<double>(in.time_ms[a]);
+        const double a_v = in.values[a];
+        double best_area = -1;
+        std::size_t best = start;
+        for (std::size_t i = start; i < end; ++i) {
+            const double area = std::fabs((a_t - avg_t) * (in.values[i] - a_v) -
+                                          (a_t - static_cast<double>(in.time_ms[i])) * (avg_v - a_v));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+        keep(best);
+        a = best;
+    }
+    keep(n - 1);
+    return out;
+}
+
+TelemetryHistory::Series downsample_minmax(const TelemetryHistory::Series& in, std::size_t max_points) {
+    const std::size_t n = in.values.size();
+    if (max_points < 2 || n <= max_points) return in;
+
+    TelemetryHistory::Series out;
+    out.time_ms.reserve(max_points);
+    out.values.reserve(max_points);
+    const std::size_t buckets = max_points / 2;
+    for (std::size_t bucket = 0; bucket < buckets; ++bucket) {
+        const std::size_t start = bucket * n / buckets;
+        const std::size_t end = (bucket + 1) * n / buckets;
+        if (start == end) continue;
+        std::size_t lo = start, hi = start;
+        for (std::size_t i = start + 1; i < end; ++i) {
+            if (in.values[i] < in.values[lo]) lo = i;
+            if (in.values[i] > in.values[hi]) hi = i;
+        }
+        const std::size_t first = std::min(lo, hi), second = std::max(lo, hi);
+        out.time_ms.push_back(in.time_ms[first]);
+        out.values.push_back(in.values[first]);
+        if (second != first) {
+            out.time_ms.push_back(in.time_ms[second]);
+            out.values.push_back(in.values[second]);
+        }
+    }
+    return out;
+}
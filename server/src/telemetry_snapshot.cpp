@@ -0,0 +1,60 @@
+#include "telemetry_snapshot.hpp"
+#include <chrono>
+
+TelemetryFeed::TelemetryFeed(std::shared_ptr<mavsdk::Telemetry> telemetry, TelemetrySnapshotCell& snapshot,
+                             std::weak_ptr<void> owner)
+    : _telemetry(std::move(telemetry)), _snapshot(snapshot) {
+    if (!_telemetry) return;
+    using Telemetry = mavsdk::Telemetry;
+
+    // Wraps `apply(snapshot, value)` into a subscription callback that only
+    // touches the snapshot while the owner is alive
+    auto guarded = [this, &owner](auto apply) {
+        return [this, owner, apply](auto value) {
+            auto alive = owner.lock();
+            if (!alive) return;
+            publish([&](TelemetrySnapshot& s) { apply(s, value); });
+        };
+    };
+
+    _position = _telemetry->subscribe_position(guarded([](TelemetrySnapshot& s, Telemetry::Position value) { s.position = value; }));
+    _home = _telemetry->subscribe_home(guarded([](TelemetrySnapshot& s, Telemetry::Position value) { s.home = value; }));
+    _attitude = _telemetry->subscribe_attitude_euler(guarded([](TelemetrySnapshot& s, Telemetry::EulerAngle value) { s.attitude = value; }));
+    _velocity = _telemetry->subscribe_velocity_ned(guarded([](TelemetrySnapshot& s, Telemetry::VelocityNed value) { s.velocity = value; }));
+    _battery = _telemetry->subscribe_battery(guarded([](TelemetrySnapshot& s, Telemetry::Battery value) { s.battery = value; }));
+    _gps_info = _telemetry->subscribe_gps_info(guarded([](TelemetrySnapshot& s, Telemetry::GpsInfo value) { s.gps_info = value; }));
+    _health = _telemetry->subscribe_health(guarded([](TelemetrySnapshot& s, Telemetry::Health value) { s.health = value; }));
+    _flight_mode = _telemetry->subscribe_flight_mode(guarded([](TelemetrySnapshot& s, Telemetry::FlightMode value) { s.flight_mode = value; }));
+    _armed = _telemetry->subscribe_armed(guarded([](TelemetrySnapshot& s, bool value) { s.armed = value; }));
+    _in_air = _telemetry->subscribe_in_air(guarded([](TelemetrySnapshot& s, bool value) { s.in_air = value; }));
+    _attached = true;
+}
+
+TelemetryFeed::~TelemetryFeed() {
+    detach();
+}
+
+void TelemetryFeed::detach() {
+    if (!_attached) return;
+    _attached = false;
+    _telemetry->unsubscribe_position(_position);
+    _telemetry->unsubscribe_home(_home);
+    _telemetry->unsubscribe_attitude_euler(_attitude);
+    _telemetry->unsubscribe_velocity_ned(_velocity);
+    _telemetry->unsubscribe_battery(_battery);
+    _telemetry->unsubscribe_gps_info(_gps_info);
+    _telemetry->unsubscribe_health(_health);
+    _telemetry->unsubscribe_flight_mode(_flight_mode);
+    _telemetry->unsubscribe_armed(_armed);
+    _telemetry->unsubscribe_in_air(_in_air);
+}
+
+template <typename Fn>
+void TelemetryFeed::publish(Fn&& fn) {
+    const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    _snapshot.update([&](TelemetrySnapshot& s) {
+        fn(s);
+        s.updated_us = now_us;
+    });
+}
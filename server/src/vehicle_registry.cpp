@@ -0,0 +1,60 @@
+#include "vehicle_registry.hpp"
+
+VehicleRegistry::VehicleRegistry() : _table(std::make_shared<const Table>()) {}
+
+std::shared_ptr<VehicleContext> VehicleRegistry::find(const std::string& vehicle_id) const {
+    auto table = snapshot();
+    auto it = table->by_id.find(vehicle_id);
+    if (it == table->by_id.end()) return nullptr;
+    return table->by_handle[it->second];
+}
+
+std::shared_ptr<VehicleContext> VehicleRegistry::get(Handle handle) const {
+    auto table = snapshot();
+    if (handle >= table->by_handle.size()) return nullptr;
+    return table->by_handle[handle];
+}
+
+std::shared_ptr<VehicleContext> VehicleRegistry::insert(const std::shared_ptr<VehicleContext>& context) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    auto next = std::make_shared<Table>(*snapshot());
+
+    std::shared_ptr<VehicleContext> replaced;
+    Handle handle;
+    auto it = next->by_id.find(context->id);
+    if (it != next->by_id.end()) {
+        // Same id reconnecting keeps its slot
+        handle = it->second;
+        replaced = next->by_handle[handle];
+    } else {
+        handle = static_cast<Handle>(next->by_handle.size());
+        for (Handle i = 0; i < next->by_handle.size(); ++i) {
+            if (!next->by_handle[i]) { handle = i; break; }
+        }
+        if (handle == next->by_handle.size()) next->by_handle.emplace_back();
+        next->by_id[context->id] = handle;
+    }
+
+    context->handle = handle;
+    next->by_handle[handle] = context;
+    publish(std::move(next));
+    return replaced;
+}
+
+std::shared_ptr<VehicleContext> VehicleRegistry::erase(const std::string& vehicle_id) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    auto current = snapshot();
+    auto it = current->by_id.find(vehicle_id);
+    if (it == current->by_id.end()) return nullptr;
+
+    auto next = std::make_shared<Table>(*current);
+    const Handle handle = it->second;
+    auto removed = std::move(next->by_handle[handle]);
+    next->by_handle[handle] = nullptr;
+    next->by_id.erase(vehicle_id);
+    while (!next->by_handle.empty() && !next->by_handle.back()) {
+        next->by_handle.pop_back();
+    }
+    publish(std::move(next));
+    return removed;
+}
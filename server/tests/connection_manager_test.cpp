@@ -0,0 +1,109 @@
+#include "connection_manager.hpp"
+#include "heartbeat_sender.hpp"
+#include "test.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr uint16_t kPort = 24552;
+constexpr const char* kVehicle = "stream-test";
+
+// One vehicle on UDP loopback, added through add_vehicle() like any other,
+// shared by every case here (MAVSDK keeps its connections for the life of
+// the process)
+bool stream_vehicle_connected() {
+    static std::unique_ptr<xgcs_test::HeartbeatSender> sender;
+    static bool connected = false;
+    if (!sender) {
+        sender = std::make_unique<xgcs_test::HeartbeatSender>(kPort);
+        connected = ConnectionManager::instance().add_vehicle(kVehicle, "udp://:" + std::to_string(kPort));
+    }
+    return connected;
+}
+
+json stream_subscriptions() {
+    const json all = ConnectionManager::instance().get_mavlink_stream_subscriptions();
+    return all.contains(kVehicle) ? all[kVehicle] : json();
+}
+
+} // namespace
+
+// WebSocket clients open and close streams through the subscriber refcount,
+// never through attach/detach. 1,000 open/close cycles by one client must
+// leave the passthrough subscriptions untouched, and must not stop the
+// stream for a second client that stays connected throughout.
+TEST(stream_start_stop_cycles_keep_subscriptions_and_other_clients) {
+    auto& cm = ConnectionManager::instance();
+    CHECK(stream_vehicle_connected());
+    if (!stream_vehicle_connected()) return;
+
+    const json baseline = stream_subscriptions();
+    CHECK(baseline["subscribers"] == 0);
+    CHECK(baseline["passthroughSubscriptions"].get<std::size_t>() > 0);
+
+    CHECK(cm.start_mavlink_streaming(kVehicle)); // Stays for the whole run
+    bool constant = true;
+    for (int cycle = 0; cycle < 1000; ++cycle) {
+        if (!cm.start_mavlink_streaming(kVehicle)) constant = false;
+        json state = stream_subscriptions();
+        if (state["subscribers"] != 2 || state["passthroughSubscriptions"] != baseline["passthroughSubscriptions"]) constant = false;
+        cm.stop_mavlink_streaming(kVehicle);
+        state = stream_subscriptions();
+        if (state["subscribers"] != 1 || state["passthroughSubscriptions"] != baseline["passthroughSubscriptions"]) constant = false;
+    }
+    CHECK(constant);
+
+    // The client that stayed still receives live frames
+    cm.get_mavlink_messages(kVehicle);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const auto batch = cm.get_mavlink_messages(kVehicle);
+    CHECK(batch.valid());
+    CHECK(!batch.empty());
+
+    cm.stop_mavlink_streaming(kVehicle);
+    CHECK(stream_subscriptions()["subscribers"] == 0);
+    CHECK(!cm.get_mavlink_messages(kVehicle).valid());
+    cm.stop_mavlink_streaming(kVehicle); // Unmatched stop is a no-op
+    CHECK(stream_subscriptions()["subscribers"] == 0);
+    CHECK(stream_subscriptions()["passthroughSubscriptions"] == baseline["passthroughSubscriptions"]);
+}
+
+// The only client drops off (laptop sleep, Wi-Fi handoff) and comes back.
+// Frames that arrived meanwhile must still be in the ring, numbered on from
+// where it left, so resuming replays them with no gap.
+TEST(stream_resume_replays_frames_from_while_nobody_was_subscribed) {
+    auto& cm = ConnectionManager::instance();
+    CHECK(stream_vehicle_connected());
+    if (!stream_vehicle_connected()) return;
+
+    CHECK(cm.start_mavlink_streaming(kVehicle));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto before = cm.get_mavlink_messages(kVehicle);
+    CHECK(!before.empty());
+    if (before.empty()) return;
+    const uint64_t resume_from = before.messages().back().sequence + 1;
+    cm.stop_mavlink_streaming(kVehicle);
+
+    // Heartbeats keep arriving every 5 ms while disconnected
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    CHECK(cm.start_mavlink_streaming(kVehicle));
+    const auto live = cm.get_mavlink_messages(kVehicle);
+    CHECK(live.valid());
+    CHECK(live.start_sequence() >= resume_from + 20);
+
+    // What the sender replays ahead of the live batch for "resumeFrom"
+    const auto replay = cm.replay_mavlink_messages(kVehicle, resume_from, live.start_sequence());
+    CHECK(replay.start_sequence() == resume_from); // Nothing evicted: no gap marker
+    CHECK(replay.messages().size() == live.start_sequence() - resume_from);
+    bool contiguous = true;
+    uint64_t expected = resume_from;
+    for (const auto& message : replay.messages()) {
+        if (message.sequence != expected++) contiguous = false;
+    }
+    CHECK(contiguous);
+    cm.stop_mavlink_streaming(kVehicle);
+}
@@ -0,0 +1,130 @@
+#include "frame_ring.hpp"
+#include "test.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+struct Record {
+    uint64_t seq;
+    uint64_t check; // ~seq, so a torn copy shows
+};
+
+Record record(uint64_t seq) {
+    return Record{seq, ~seq};
+}
+
+} // namespace
+
+TEST(frame_ring_capacity_rounds_up_to_power_of_two) {
+    CHECK(FrameRing<Record>(0).capacity() == 2);
+    CHECK(FrameRing<Record>(5).capacity() == 8);
+    CHECK(FrameRing<Record>(1024).capacity() == 1024);
+}
+
+TEST(frame_ring_reader_sees_only_new_records) {
+    FrameRing<Record> ring(8);
+    ring.push(record(0));
+    FrameRing<Record>::Reader reader(ring);
+    Record out{};
+    CHECK(!reader.next(out));
+
+    ring.push(record(1));
+    CHECK(reader.pending() == 1);
+    CHECK(reader.next(out) && out.seq == 1);
+    CHECK(!reader.next(out));
+    CHECK(reader.dropped() == 0);
+}
+
+TEST(frame_ring_wraps_in_order_while_kept_up) {
+    FrameRing<Record> ring(4);
+    FrameRing<Record>::Reader reader(ring);
+    Record out{};
+    bool in_order = true;
+    for (uint64_t seq = 0; seq < 4 * 10; ++seq) {
+        ring.push(record(seq));
+        if (!reader.next(out) || out.seq != seq) in_order = false;
+    }
+    CHECK(in_order);
+    CHECK(reader.dropped() == 0);
+    CHECK(ring.written() == 40);
+}
+
+TEST(frame_ring_overwrite_skips_slow_reader_and_counts_drops) {
+    FrameRing<Record> ring(4);
+    FrameRing<Record>::Reader slow(ring);
+    FrameRing<Record>::Reader fast(ring);
+    Record out{};
+    for (uint64_t seq = 0; seq < 10; ++seq) {
+        ring.push(record(seq));
+        CHECK(fast.next(out));
+    }
+    CHECK(ring.oldest() == 6);
+
+    // Records 0-5 were overwritten; the slow reader resumes at the oldest left
+    CHECK(slow.next(out) && out.seq == 6);
+    CHECK(slow.dropped() == 6);
+    uint64_t expected = 7;
+    while (slow.next(out)) CHECK(out.seq == expected++);
+    CHECK(expected == 10);
+    CHECK(slow.dropped() == 6);
+
+    // Drop counts are per reader
+    CHECK(fast.dropped() == 0);
+}
+
+TEST(frame_ring_replay_from_position) {
+    FrameRing<Record> ring(8);
+    for (uint64_t seq = 0; seq < 20; ++seq) ring.push(record(seq));
+
+    Record out{};
+    FrameRing<Record>::Reader held(ring, 15);
+    CHECK(held.next(out) && out.seq == 15);
+    CHECK(held.dropped() == 0);
+
+    // Already overwritten: starts from the oldest still held
+    FrameRing<Record>::Reader stale(ring, 3);
+    CHECK(stale.next(out) && out.seq == 12);
+    CHECK(stale.dropped() == 9);
+
+    // Past the head: clamped to it
+    FrameRing<Record>::Reader ahead(ring, 100);
+    CHECK(ahead.position() == 20);
+    CHECK(!ahead.next(out));
+}
+
+TEST(frame_ring_concurrent_reader_never_sees_torn_records) {
+    FrameRing<Record> ring(64);
+    constexpr uint64_t kRecords = 200000;
+    std::atomic<bool> done{false};
+    uint64_t read = 0;
+    uint64_t dropped = 0;
+    bool consistent = true;
+
+    std::thread consumer([&] {
+        FrameRing<Record>::Reader reader(ring, 0);
+        Record out{};
+        uint64_t last = 0;
+        bool first = true;
+        for (;;) {
+            const bool finished = done.load(std::memory_order_acquire);
+            while (reader.next(out)) {
+                if (out.check != ~out.seq || (!first && out.seq <= last)) consistent = false;
+                last = out.seq;
+                first = false;
+                ++read;
+            }
+            if (finished) break;
+            std::this_thread::yield();
+        }
+        dropped = reader.dropped();
+    });
+    for (uint64_t seq = 0; seq < kRecords; ++seq) ring.push(record(seq));
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    CHECK(consistent);
+    // Every record is either read or accounted for as dropped
+    CHECK(read + dropped == kRecords);
+}
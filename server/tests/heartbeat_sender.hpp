@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mavsdk/mavlink/common/mavlink.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace xgcs_test {
+
+// A fake autopilot on UDP loopback: raw HEARTBEATs every 5 ms to `port`
+class HeartbeatSender {
+public:
+    explicit HeartbeatSender(uint16_t port) : _socket(::socket(AF_INET, SOCK_DGRAM, 0)) {
+        std::memset(&_target, 0, sizeof(_target));
+        _target.sin_family = AF_INET;
+        _target.sin_port = htons(port);
+        _target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        _thread = std::thread([this] { run(); });
+    }
+
+    ~HeartbeatSender() {
+        _stop = true;
+        _thread.join();
+        if (_socket >= 0) ::close(_socket);
+    }
+
+    HeartbeatSender(const HeartbeatSender&) = delete;
+    HeartbeatSender& operator=(const HeartbeatSender&) = delete;
+
+private:
+    void run() {
+        while (!_stop) {
+            mavlink_message_t message;
+            mavlink_msg_heartbeat_pack_chan(1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_QUADROTOR, 3 /* MAV_AUTOPILOT_ARDUPILOTMEGA */,
+                                            0, 0, 4 /* MAV_STATE_ACTIVE */);
+            uint8_t packet[MAVLINK_MAX_PACKET_LEN];
+            const uint16_t length = mavlink_msg_to_send_buffer(packet, &message);
+            ::sendto(_socket, packet, length, 0, reinterpret_cast<const sockaddr*>(&_target), sizeof(_target));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    int _socket;
+    sockaddr_in _target;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+};
+
+} // namespace xgcs_test
@@ -0,0 +1,144 @@
+#include "json_writer.hpp"
+#include "mavlink_decoder.hpp"
+#include "test.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+// JsonWriter's contract is byte equality with nlohmann::json::dump() for
+// the same values; each case writes through both and compares the text.
+
+namespace {
+
+template <typename T>
+std::string written(T value) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.value(value);
+    return out;
+}
+
+template <typename T>
+bool matches_dump(T value) {
+    return written(value) == json(value).dump();
+}
+
+} // namespace
+
+TEST(json_writer_integers_match_dump) {
+    CHECK(matches_dump(std::numeric_limits<int64_t>::min()));
+    CHECK(matches_dump(std::numeric_limits<int64_t>::max()));
+    CHECK(matches_dump(std::numeric_limits<uint64_t>::max()));
+    CHECK(matches_dump(std::numeric_limits<int8_t>::min()));
+    CHECK(matches_dump(static_cast<uint8_t>(255))); // A number, never a character
+    CHECK(matches_dump(static_cast<int16_t>(-1)));
+    CHECK(matches_dump(0u));
+    CHECK(matches_dump(true));
+    CHECK(matches_dump(false));
+}
+
+TEST(json_writer_doubles_match_dump) {
+    const double fixed[] = {0.0, -0.0, 1.0, -1.5, 0.1, 1e-5, 2.5e-05, 1e20, 1e21, 1e-7, 123456789.0,
+                            std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+                            std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::epsilon()};
+    for (double value : fixed) CHECK(matches_dump(value));
+
+    // Arbitrary bit patterns, and floats widened the way MAVLink fields are
+    std::mt19937_64 random(8);
+    int mismatches = 0;
+    for (int i = 0; i < 200000; ++i) {
+        const uint64_t bits = random();
+        double as_double;
+        std::memcpy(&as_double, &bits, sizeof(as_double));
+        float as_float;
+        const uint32_t float_bits = static_cast<uint32_t>(bits);
+        std::memcpy(&as_float, &float_bits, sizeof(as_float));
+        if (!matches_dump(as_double)) ++mismatches;
+        if (!matches_dump(static_cast<double>(as_float))) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST(json_writer_non_finite_is_null) {
+    CHECK(written(std::numeric_limits<double>::quiet_NaN()) == "null");
+    CHECK(written(std::numeric_limits<float>::infinity()) == "null");
+    CHECK(matches_dump(-std::numeric_limits<double>::infinity()));
+}
+
+TEST(json_writer_strings_match_dump) {
+    const char* strings[] = {"", "plain", "quote \" backslash \\ slash /", "\b\f\n\r\t", "\x01\x1f\x7f",
+                             "caf\xC3\xA9", "\xE2\x82\xAC euro", "\xF0\x9F\x9B\xB8 ufo"};
+    for (const char* text : strings) CHECK(matches_dump(std::string(text)));
+}
+
+TEST(json_writer_invalid_utf8_becomes_replacement_character) {
+    CHECK(written(std::string_view("a\xFF" "b")) == "\"a\xEF\xBF\xBD" "b\"");
+    CHECK(written(std::string_view("\xC3")) == "\"\xEF\xBF\xBD\"");       // Truncated sequence
+    CHECK(written(std::string_view("\xED\xA0\x80")) == "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\""); // Surrogate
+}
+
+TEST(json_writer_nesting_matches_dump) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.begin_object();
+    writer.key("a");
+    writer.begin_array();
+    writer.value(1);
+    writer.begin_object();
+    writer.end_object();
+    writer.begin_array();
+    writer.end_array();
+    writer.null();
+    writer.end_array();
+    writer.key("b");
+    writer.begin_object();
+    writer.key("c");
+    writer.value(0.5);
+    writer.end_object();
+    writer.key("d");
+    writer.raw("[true]");
+    writer.end_object();
+
+    const json expected = {{"a", {1, json::object(), json::array(), nullptr}}, {"b", {{"c", 0.5}}}, {"d", {true}}};
+    CHECK(out == expected.dump());
+}
+
+TEST(decoder_write_fields_matches_decode_dump) {
+    const MavlinkDecoder& decoder = MavlinkDecoder::instance();
+    std::mt19937_64 random(42);
+    int messages = 0;
+    int mismatches = 0;
+    std::string out;
+    for (uint32_t msgid = 0; msgid <= 0xFFFF; ++msgid) {
+        const mavlink_message_info_t* info = decoder.info(msgid);
+        if (!info) continue;
+        ++messages;
+        for (int round = 0; round < 20; ++round) {
+            mavlink_message_t message;
+            std::memset(&message, 0, sizeof(message));
+            message.msgid = msgid;
+            auto* payload = reinterpret_cast<uint8_t*>(message.payload64);
+            for (std::size_t i = 0; i < MAVLINK_MAX_PAYLOAD_LEN; ++i) payload[i] = static_cast<uint8_t>(random());
+            // dump() rejects invalid UTF-8, so char[] fields get printable text (with an early NUL now and then)
+            for (unsigned f = 0; f < info->num_fields; ++f) {
+                const mavlink_field_info_t& field = info->fields[f];
+                if (field.type != MAVLINK_TYPE_CHAR) continue;
+                const unsigned length = field.array_length ? field.array_length : 1;
+                for (unsigned i = 0; i < length; ++i) {
+                    payload[field.wire_offset + i] = static_cast<uint8_t>(random() % 8 == 0 ? 0 : 0x20 + random() % 0x5F);
+                }
+            }
+            // Full length, or MAVLink 2 trailing-zero truncation
+            message.len = static_cast<uint8_t>(round % 2 ? random() % (MAVLINK_MAX_PAYLOAD_LEN + 1) : MAVLINK_MAX_PAYLOAD_LEN);
+
+            out.clear();
+            JsonWriter writer(out);
+            decoder.write_fields(message, writer);
+            if (out != decoder.decode(message).dump()) ++mismatches;
+        }
+    }
+    CHECK(messages > 0);
+    CHECK(mismatches == 0);
+}
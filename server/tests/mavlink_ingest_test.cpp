@@ -0,0 +1,150 @@
+#include "mavlink_ingest.hpp"
+#include "heartbeat_sender.hpp"
+#include "test.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Records which stages saw which message ids
+struct Calls {
+    std::vector<std::pair<int, uint32_t>> seen;
+};
+
+template <int Stage>
+void record(void* context, const MavlinkIngest&, const mavlink_message_t& message) {
+    static_cast<Calls*>(context)->seen.emplace_back(Stage, message.msgid);
+}
+
+mavlink_message_t message_with_id(uint32_t msgid) {
+    mavlink_message_t message;
+    std::memset(&message, 0, sizeof(message));
+    message.msgid = msgid;
+    return message;
+}
+
+} // namespace
+
+TEST(ingest_dispatches_keyed_and_wildcard_stages) {
+    Calls calls;
+    MavlinkIngest ingest("1");
+    CHECK(ingest.add_stage_all("all", record<0>, &calls) == 0);
+    CHECK(ingest.add_stage("attitude", record<1>, &calls, {MAVLINK_MSG_ID_ATTITUDE}) == 1);
+    CHECK(ingest.add_stage("position", record<2>, &calls, {MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_GLOBAL_POSITION_INT}) == 2);
+
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_ATTITUDE));
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_HEARTBEAT));
+
+    // Stages run in registration order for each message
+    const std::vector<std::pair<int, uint32_t>> expected = {
+        {0, MAVLINK_MSG_ID_ATTITUDE}, {1, MAVLINK_MSG_ID_ATTITUDE}, {2, MAVLINK_MSG_ID_ATTITUDE},
+        {0, MAVLINK_MSG_ID_GLOBAL_POSITION_INT}, {2, MAVLINK_MSG_ID_GLOBAL_POSITION_INT},
+        {0, MAVLINK_MSG_ID_HEARTBEAT},
+    };
+    CHECK(calls.seen == expected);
+}
+
+TEST(ingest_reaches_mavlink2_ids_above_16_bits) {
+    Calls calls;
+    MavlinkIngest ingest("1");
+    ingest.add_stage("high", record<0>, &calls, {0x10000, MsgIdTable<uint32_t>::kMaxMsgId});
+    ingest.ingest(message_with_id(0x10000));
+    ingest.ingest(message_with_id(0x10001));
+    ingest.ingest(message_with_id(MsgIdTable<uint32_t>::kMaxMsgId));
+    CHECK(calls.seen.size() == 2);
+}
+
+TEST(ingest_disabled_stage_is_skipped) {
+    Calls calls;
+    MavlinkIngest ingest("1");
+    ingest.add_stage_all("all", record<0>, &calls);
+    const int stream = ingest.add_stage("stream", record<1>, &calls, {MAVLINK_MSG_ID_ATTITUDE});
+    CHECK(ingest.find_stage("stream") == stream);
+    CHECK(ingest.find_stage("missing") == -1);
+
+    ingest.set_stage_enabled(stream, false);
+    CHECK(!ingest.stage_enabled(stream));
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(calls.seen.size() == 1);
+
+    ingest.set_stage_enabled(stream, true);
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_ATTITUDE));
+    CHECK(calls.seen.size() == 3);
+}
+
+TEST(ingest_rejects_stages_past_the_limit) {
+    Calls calls;
+    MavlinkIngest ingest("1");
+    CHECK(ingest.add_stage("no_handler", nullptr, &calls, {MAVLINK_MSG_ID_HEARTBEAT}) == -1);
+    for (std::size_t i = 0; i < MavlinkIngest::kMaxStages; ++i) {
+        CHECK(ingest.add_stage("keyed", record<0>, &calls, {MAVLINK_MSG_ID_HEARTBEAT}) == static_cast<int>(i));
+    }
+    CHECK(ingest.add_stage_all("one_too_many", record<0>, &calls) == -1);
+
+    ingest.ingest(message_with_id(MAVLINK_MSG_ID_HEARTBEAT));
+    CHECK(calls.seen.size() == MavlinkIngest::kMaxStages);
+}
+
+// Every WebSocket open/close used to leave its MAVSDK subscriptions behind.
+// Attach and detach a full pipeline (wildcard range plus a keyed id) 1,000
+// times on a real MAVSDK instance; the subscription count must not grow, and
+// afterwards each HEARTBEAT must still reach the stage exactly once.
+TEST(ingest_attach_detach_cycles_keep_callbacks_constant) {
+    constexpr uint16_t kPort = 24551;
+    // Declared before the Mavsdk instance, and the owner after the pipeline:
+    // MAVSDK may still run a queued callback until it is destroyed
+    std::atomic<uint64_t> stage_heartbeats{0};
+    std::atomic<uint64_t> direct_heartbeats{0};
+    mavsdk::Mavsdk mavsdk(mavsdk::Mavsdk::Configuration{mavsdk::ComponentType::GroundStation});
+    CHECK(mavsdk.add_any_connection("udp://:" + std::to_string(kPort)) == mavsdk::ConnectionResult::Success);
+    xgcs_test::HeartbeatSender sender(kPort);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (mavsdk.systems().empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(!mavsdk.systems().empty());
+    if (mavsdk.systems().empty()) return;
+    auto passthrough = std::make_shared<mavsdk::MavlinkPassthrough>(mavsdk.systems().front());
+
+    MavlinkIngest ingest("1");
+    auto owner = std::make_shared<int>(0);
+    ingest.add_stage_all("tlog", [](void*, const MavlinkIngest&, const mavlink_message_t&) {}, nullptr);
+    ingest.add_stage("state", [](void* context, const MavlinkIngest&, const mavlink_message_t&) {
+        static_cast<std::atomic<uint64_t>*>(context)->fetch_add(1, std::memory_order_relaxed);
+    }, &stage_heartbeats, {MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_EVENT});
+
+    // Wildcard range once each, plus the keyed id beyond it
+    const std::size_t expected = MavlinkIngest::kAllMsgIdLast - MavlinkIngest::kAllMsgIdFirst + 2;
+    bool constant = true;
+    for (int cycle = 0; cycle < 1000; ++cycle) {
+        ingest.attach(passthrough, owner);
+        ingest.attach(passthrough, owner); // No-op while attached
+        if (ingest.subscription_count() != expected) constant = false;
+        ingest.detach();
+        if (ingest.subscription_count() != 0 || ingest.attached()) constant = false;
+    }
+    CHECK(constant);
+
+    // A leaked callback would deliver extra copies; compare against one
+    // direct subscription over the same window
+    auto direct = passthrough->subscribe_message(MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) {
+        direct_heartbeats.fetch_add(1, std::memory_order_relaxed);
+    });
+    ingest.attach(passthrough, owner);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const uint64_t stage_before = stage_heartbeats.load();
+    const uint64_t direct_before = direct_heartbeats.load();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const int64_t stage_seen = static_cast<int64_t>(stage_heartbeats.load() - stage_before);
+    const int64_t direct_seen = static_cast<int64_t>(direct_heartbeats.load() - direct_before);
+    ingest.detach();
+    passthrough->unsubscribe_message(MAVLINK_MSG_ID_HEARTBEAT, direct);
+
+    CHECK(direct_seen > 0);
+    CHECK(stage_seen >= direct_seen - 2 && stage_seen <= direct_seen + 2);
+}
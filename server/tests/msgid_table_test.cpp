@@ -0,0 +1,51 @@
+#include "msgid_table.hpp"
+#include "test.hpp"
+#include <cstdint>
+#include <vector>
+
+TEST(msgid_table_find_without_pages_is_null) {
+    MsgIdTable<int> table;
+    CHECK(table.find(0) == nullptr);
+    CHECK(table.find(33) == nullptr);
+    CHECK(table.find(MsgIdTable<int>::kMaxMsgId) == nullptr);
+}
+
+TEST(msgid_table_slots_across_the_24_bit_range) {
+    MsgIdTable<int> table;
+    const uint32_t ids[] = {0, 33, 255, 256, 11000, 42000, 0x12345, MsgIdTable<int>::kMaxMsgId};
+    for (uint32_t id : ids) table[id] = static_cast<int>(id % 1000) + 1;
+    for (uint32_t id : ids) {
+        const int* slot = table.find(id);
+        CHECK(slot != nullptr);
+        CHECK(slot && *slot == static_cast<int>(id % 1000) + 1);
+    }
+}
+
+TEST(msgid_table_page_neighbours_are_default) {
+    MsgIdTable<int> table;
+    table[33] = 7;
+    // Same 256-id page: slot exists, still default
+    CHECK(table.find(34) != nullptr);
+    CHECK(*table.find(34) == 0);
+    // Different page: nothing allocated
+    CHECK(table.find(33 + 256) == nullptr);
+    CHECK(table.find(33 + 65536) == nullptr);
+}
+
+TEST(msgid_table_for_each_visits_allocated_pages_in_order) {
+    MsgIdTable<int> table;
+    table[42000] = 2;
+    table[30] = 1;
+    std::vector<uint32_t> written;
+    std::size_t visited = 0;
+    uint32_t last = 0;
+    bool ordered = true;
+    table.for_each([&](uint32_t msgid, const int& value) {
+        if (visited++ > 0 && msgid <= last) ordered = false;
+        last = msgid;
+        if (value) written.push_back(msgid);
+    });
+    CHECK(visited == 2 * 256); // Two leaf pages
+    CHECK(ordered);
+    CHECK(written == std::vector<uint32_t>({30, 42000}));
+}
@@ -0,0 +1,39 @@
+#include "response_cache.hpp"
+#include "test.hpp"
+#include <chrono>
+#include <string>
+
+TEST(response_cache_etag_follows_body) {
+    TickedResponseCache cache(std::chrono::milliseconds(0)); // Every get() rebuilds
+    const auto first = cache.get([] { return std::string("{\"a\":1}"); });
+    const auto same = cache.get([] { return std::string("{\"a\":1}"); });
+    const auto changed = cache.get([] { return std::string("{\"a\":2}"); });
+    CHECK(first.etag == same.etag);
+    CHECK(first.etag != changed.etag);
+    CHECK(first.etag.front() == '"');
+    CHECK(cache.not_modified(same.etag, same.etag));
+    CHECK(!cache.not_modified(first.etag, changed.etag));
+}
+
+// A timestamp that moves every build must not defeat revalidation when the
+// validator (the content without it) is unchanged
+TEST(response_cache_etag_follows_validator) {
+    TickedResponseCache cache(std::chrono::milliseconds(0));
+    int64_t time = 1000;
+    auto build = [&](int value) {
+        TickedResponseCache::Built built;
+        built.body = "{\"t\":" + std::to_string(++time) + ",\"v\":" + std::to_string(value) + "}";
+        built.validator = "{\"v\":" + std::to_string(value) + "}";
+        return built;
+    };
+    const auto first = cache.get([&] { return build(1); });
+    const auto later = cache.get([&] { return build(1); });
+    CHECK(*first.body != *later.body);
+    CHECK(first.etag == later.etag);
+    CHECK(first.etag.substr(0, 3) == "W/\"");
+    CHECK(cache.not_modified(first.etag, later.etag));
+
+    const auto changed = cache.get([&] { return build(2); });
+    CHECK(changed.etag != first.etag);
+    CHECK(cache.stats().misses == 3);
+}
@@ -0,0 +1,85 @@
+#include "seqlock.hpp"
+#include "test.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Every word holds the same value in any complete publication
+struct Wide {
+    uint64_t words[32];
+};
+
+} // namespace
+
+TEST(seqlock_publishes_updates) {
+    Seqlock<Wide> cell;
+    CHECK(cell.version() == 0);
+    CHECK(cell.load().words[0] == 0);
+
+    cell.update([](Wide& value) { value.words[3] = 7; });
+    CHECK(cell.version() == 1);
+    CHECK(cell.load().words[3] == 7);
+
+    // Updates edit the latest value rather than replace it
+    cell.update([](Wide& value) { value.words[4] = 8; });
+    const Wide loaded = cell.load();
+    CHECK(loaded.words[3] == 7 && loaded.words[4] == 8);
+}
+
+TEST(seqlock_readers_never_see_a_torn_value) {
+    Seqlock<Wide> cell;
+    constexpr uint64_t kUpdates = 100000;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> backwards{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                const Wide value = cell.load();
+                for (uint64_t word : value.words) {
+                    if (word != value.words[0]) {
+                        torn.fetch_add(1);
+                        break;
+                    }
+                }
+                if (value.words[0] < last) backwards.fetch_add(1);
+                last = value.words[0];
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= kUpdates; ++i) {
+        cell.update([i](Wide& value) {
+            for (uint64_t& word : value.words) word = i;
+        });
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) reader.join();
+
+    CHECK(torn.load() == 0);
+    CHECK(backwards.load() == 0);
+    CHECK(cell.load().words[31] == kUpdates);
+}
+
+TEST(seqlock_concurrent_writers_keep_each_others_fields) {
+    Seqlock<Wide> cell;
+    constexpr uint64_t kUpdates = 20000;
+    std::thread first([&] {
+        for (uint64_t i = 0; i < kUpdates; ++i) cell.update([](Wide& value) { ++value.words[0]; });
+    });
+    std::thread second([&] {
+        for (uint64_t i = 0; i < kUpdates; ++i) cell.update([](Wide& value) { ++value.words[1]; });
+    });
+    first.join();
+    second.join();
+
+    const Wide value = cell.load();
+    CHECK(value.words[0] == kUpdates);
+    CHECK(value.words[1] == kUpdates);
+    CHECK(cell.version() == 2 * kUpdates);
+}
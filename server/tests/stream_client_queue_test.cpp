@@ -0,0 +1,139 @@
+#include "stream_client_queue.hpp"
+#include "test.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using PushResult = StreamClientQueue::PushResult;
+
+// A frame of `bytes` payload bytes; `tag` tells frames apart
+StreamClientQueue::Item frame(uint32_t msgid, std::size_t bytes, char tag = 'x') {
+    StreamClientQueue::Item item;
+    item.payload = std::make_shared<const std::string>(bytes, tag);
+    item.msgid = msgid;
+    return item;
+}
+
+std::string tags(const std::vector<StreamClientQueue::Item>& items) {
+    std::string out;
+    for (const auto& item : items) out += item.payload->front();
+    return out;
+}
+
+} // namespace
+
+TEST(stream_queue_reports_first_frame_and_flush_size) {
+    StreamClientQueue queue(1000, 500, StreamOverflowPolicy::DropOldest, 30);
+    CHECK(queue.push(frame(1, 10)) == PushResult::QueuedFirst);
+    CHECK(queue.push(frame(1, 10)) == PushResult::Queued);
+    CHECK(queue.push(frame(1, 10)) == PushResult::QueuedFlush); // Reached 30 bytes
+    CHECK(queue.push(frame(1, 10)) == PushResult::Queued);      // Only on crossing
+
+    std::vector<StreamClientQueue::Item> taken;
+    queue.take_all(taken);
+    CHECK(taken.size() == 4);
+    const auto stats = queue.stats();
+    CHECK(stats.depth == 0);
+    CHECK(stats.bytes == 0);
+    CHECK(stats.sent == 4);
+    CHECK(stats.peak_bytes == 40);
+    CHECK(queue.push(frame(1, 10)) == PushResult::QueuedFirst);
+}
+
+TEST(stream_queue_frames_share_one_payload) {
+    StreamClientQueue a(1000, 500, StreamOverflowPolicy::DropOldest);
+    StreamClientQueue b(1000, 500, StreamOverflowPolicy::DropOldest);
+    auto item = frame(1, 10);
+    const std::string* payload = item.payload.get();
+    a.push(item);
+    b.push(item);
+
+    std::vector<StreamClientQueue::Item> taken;
+    a.take_all(taken);
+    CHECK(taken.size() == 1 && taken[0].payload.get() == payload);
+    b.take_all(taken);
+    CHECK(taken.size() == 1 && taken[0].payload.get() == payload);
+}
+
+TEST(stream_queue_drop_oldest_trims_to_low_watermark) {
+    StreamClientQueue queue(100, 50, StreamOverflowPolicy::DropOldest);
+    const std::string order = "abcdefghijk";
+    for (char tag : order) queue.push(frame(1, 10, tag));
+
+    // 110 bytes passed the high watermark: oldest frames go until <= 50
+    auto stats = queue.stats();
+    CHECK(stats.bytes == 50);
+    CHECK(stats.depth == 5);
+    CHECK(stats.dropped == 6);
+    CHECK(stats.coalesced == 0);
+    CHECK(stats.peak_bytes == 100);
+
+    // Back under the high watermark: no trimming until it is passed again
+    for (int i = 0; i < 5; ++i) queue.push(frame(1, 10, 'z'));
+    CHECK(queue.stats().depth == 10);
+    CHECK(queue.stats().dropped == 6);
+
+    std::vector<StreamClientQueue::Item> taken;
+    queue.take_all(taken);
+    CHECK(tags(taken) == "ghijkzzzzz");
+}
+
+TEST(stream_queue_keeps_a_lone_frame_over_the_limit) {
+    StreamClientQueue queue(100, 50, StreamOverflowPolicy::DropOldest);
+    queue.push(frame(1, 10, 'a'));
+    queue.push(frame(1, 500, 'b'));
+    std::vector<StreamClientQueue::Item> taken;
+    queue.take_all(taken);
+    CHECK(tags(taken) == "b");
+}
+
+TEST(stream_queue_coalesce_keeps_newest_per_msgid) {
+    StreamClientQueue queue(100, 50, StreamOverflowPolicy::CoalesceLatest);
+    // Interleaved ids 1 and 2, then one of id 3: 11 x 10 bytes
+    const std::string order = "abcdefghij";
+    for (std::size_t i = 0; i < order.size(); ++i) queue.push(frame(1 + i % 2, 10, order[i]));
+    CHECK(queue.stats().dropped == 0);
+    queue.push(frame(3, 10, 'k'));
+
+    const auto stats = queue.stats();
+    CHECK(stats.depth == 3);
+    CHECK(stats.bytes == 30);
+    CHECK(stats.coalesced == 8);
+    CHECK(stats.dropped == 8);
+
+    // Newest of each id, still in queue order
+    std::vector<StreamClientQueue::Item> taken;
+    queue.take_all(taken);
+    CHECK(tags(taken) == "ijk");
+}
+
+TEST(stream_queue_coalesce_then_drops_oldest_if_still_over) {
+    StreamClientQueue queue(100, 50, StreamOverflowPolicy::CoalesceLatest);
+    // Every frame a different id: coalescing frees nothing
+    for (uint32_t i = 0; i < 11; ++i) queue.push(frame(i, 10, static_cast<char>('a' + i)));
+    const auto stats = queue.stats();
+    CHECK(stats.bytes == 50);
+    CHECK(stats.coalesced == 0);
+    CHECK(stats.dropped == 6);
+}
+
+TEST(stream_queue_disconnect_policy_overflows_for_good) {
+    StreamClientQueue queue(100, 50, StreamOverflowPolicy::Disconnect);
+    for (int i = 0; i < 10; ++i) CHECK(queue.push(frame(1, 10)) != PushResult::Overflow);
+    CHECK(queue.push(frame(1, 10)) == PushResult::Overflow);
+
+    auto stats = queue.stats();
+    CHECK(stats.overflowed);
+    CHECK(stats.depth == 0);
+    CHECK(stats.bytes == 0);
+    CHECK(stats.dropped == 11);
+    CHECK(queue.push(frame(1, 1)) == PushResult::Overflow);
+}
+
+TEST(stream_queue_low_watermark_clamped_to_high) {
+    StreamClientQueue queue(50, 500, StreamOverflowPolicy::DropOldest);
+    for (int i = 0; i < 6; ++i) queue.push(frame(1, 10));
+    CHECK(queue.stats().bytes == 50);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+// Minimal test registry for xgcs_tests. Each tests/*.cpp defines cases with
+// TEST(name) { CHECK(...); }; test_main.cpp runs them all. A failed CHECK
+// is reported and the case carries on, so one run lists every failure.
+namespace xgcs_test {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Case>& cases();
+void fail(const char* file, int line, const char* expression);
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { cases().push_back({name, run}); }
+};
+
+} // namespace xgcs_test
+
+#define TEST(name)                                                      \
+    static void name();                                                 \
+    static const xgcs_test::Registrar name##_registrar(#name, name);    \
+    static void name()
+
+#define CHECK(expression)                                                           \
+    do {                                                                            \
+        if (!(expression)) xgcs_test::fail(__FILE__, __LINE__, #expression);        \
+    } while (0)
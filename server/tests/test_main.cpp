@@ -0,0 +1,37 @@
+#include "test.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace xgcs_test {
+
+static int g_failures = 0;
+
+std::vector<Case>& cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+void fail(const char* file, int line, const char* expression) {
+    ++g_failures;
+    std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+}
+
+} // namespace xgcs_test
+
+// xgcs_tests [filter]: runs every case whose name contains `filter`
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    int run = 0;
+    int failed = 0;
+    for (const auto& test : xgcs_test::cases()) {
+        if (!std::strstr(test.name, filter)) continue;
+        const int failures_before = xgcs_test::g_failures;
+        test.run();
+        const bool passed = xgcs_test::g_failures == failures_before;
+        ++run;
+        if (!passed) ++failed;
+        std::printf("%s %s\n", passed ? "ok  " : "FAIL", test.name);
+    }
+    std::printf("%d/%d passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+}